@@ -0,0 +1,370 @@
+/*********************************************************************************
+ *
+ *  MIT License
+ *
+ *  Copyright (c) 2017 Nenad Zikic
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ *********************************************************************************/
+
+
+// Bulk, SIMD and parallel APIs over arrays of lengths, each next to plain
+// loop or standard algorithm doing the same work on raw doubles.
+
+#include "bench_common.hpp"
+
+#include <length/accumulator.hpp>
+#include <length/algorithm.hpp>
+#include <length/bulk.hpp>
+#include <length/dynamic_length.hpp>
+#include <length/exact.hpp>
+#include <length/expression.hpp>
+#include <length/length_array.hpp>
+#include <length/parallel.hpp>
+#include <length/simd.hpp>
+#include <length/vec3.hpp>
+
+#include <algorithm>
+#include <numeric>
+
+
+namespace
+{
+    using namespace length;
+    using namespace length::bench;
+
+    /** Large enough arrays for parallel overloads to split them into many chunks **/
+    constexpr std::size_t parallel_size = std::size_t{1} << 22;
+
+    // conversions
+
+    template <typename FromUnit, typename ToUnit, typename Rep>
+    void bulk_convert_n(benchmark::State& state)
+    {
+        const auto in = random_lengths<FromUnit, Rep>();
+        std::vector<Length<ToUnit, Rep>> out(in.size());
+        for (auto _ : state)
+        {
+            convert_n<FromUnit, ToUnit>(in.data(), in.size(), out.data());
+            benchmark::DoNotOptimize(out.data());
+            benchmark::ClobberMemory();
+        }
+        set_items(state);
+    }
+
+    void bulk_convert_dynamic(benchmark::State& state)
+    {
+        const auto in = random_values();
+        std::vector<double> out(in.size());
+        for (auto _ : state)
+        {
+            convert_n(in.data(), in.size(), unit_id::inch, unit_id::metre, out.data());
+            benchmark::DoNotOptimize(out.data());
+            benchmark::ClobberMemory();
+        }
+        set_items(state);
+    }
+
+    void bulk_to_exact_n(benchmark::State& state)
+    {
+        const auto in = random_lengths<inch>();
+        std::vector<ExactLength> out(in.size());
+        for (auto _ : state)
+        {
+            to_exact_n(in.data(), in.size(), out.data());
+            benchmark::DoNotOptimize(out.data());
+            benchmark::ClobberMemory();
+        }
+        set_items(state);
+    }
+
+    // reductions
+
+    void simd_sum(benchmark::State& state)
+    {
+        const auto in = random_lengths<metre>();
+        for (auto _ : state)
+        {
+            benchmark::DoNotOptimize(simd::sum(in.data(), in.size()));
+        }
+        set_items(state);
+    }
+
+    void sum_raw_double(benchmark::State& state)
+    {
+        const auto in = random_values();
+        for (auto _ : state)
+        {
+            benchmark::DoNotOptimize(std::accumulate(in.begin(), in.end(), 0.0));
+        }
+        set_items(state);
+    }
+
+    void accumulate_compensated(benchmark::State& state)
+    {
+        const auto in = random_lengths<inch>();
+        for (auto _ : state)
+        {
+            benchmark::DoNotOptimize(accumulate<metre>(in.data(), in.size()).total());
+        }
+        set_items(state);
+    }
+
+    void sum_raw_long_double(benchmark::State& state)
+    {
+        const auto in = random_values();
+        for (auto _ : state)
+        {
+            benchmark::DoNotOptimize(std::accumulate(in.begin(), in.end(), 0.0L));
+        }
+        set_items(state);
+    }
+
+    // sorted search, key in another unit than the elements
+
+    void search_lower_bound_mixed_unit(benchmark::State& state)
+    {
+        auto sorted = random_lengths<millimetre>();
+        sort(sorted.data(), sorted.size());
+        const auto keys = random_lengths<inch>(bench_size, 11);
+        std::size_t k = 0;
+        for (auto _ : state)
+        {
+            benchmark::DoNotOptimize(lower_bound(sorted.data(), sorted.size(), keys[k++ % keys.size()]));
+        }
+        state.SetItemsProcessed(state.iterations());
+    }
+
+    void search_lower_bound_per_element_convert(benchmark::State& state)
+    {
+        auto sorted = random_lengths<millimetre>();
+        sort(sorted.data(), sorted.size());
+        const auto keys = random_lengths<inch>(bench_size, 11);
+        std::size_t k = 0;
+        for (auto _ : state)
+        {
+            benchmark::DoNotOptimize(std::lower_bound(sorted.begin(), sorted.end(), keys[k++ % keys.size()],
+                                                      [](const Length<millimetre>& e, const Length<inch>& key) { return e < key; }));
+        }
+        state.SetItemsProcessed(state.iterations());
+    }
+
+    void simd_scale(benchmark::State& state)
+    {
+        const auto in = random_lengths<metre>();
+        std::vector<Length<metre>> out(in.size());
+        for (auto _ : state)
+        {
+            simd::scale(in.data(), in.size(), 1.5, out.data());
+            benchmark::DoNotOptimize(out.data());
+            benchmark::ClobberMemory();
+        }
+        set_items(state);
+    }
+
+    void simd_minmax(benchmark::State& state)
+    {
+        const auto in = random_lengths<metre>();
+        for (auto _ : state)
+        {
+            benchmark::DoNotOptimize(simd::minmax(in.data(), in.size()));
+        }
+        set_items(state);
+    }
+
+    void minmax_raw_double(benchmark::State& state)
+    {
+        const auto in = random_values();
+        for (auto _ : state)
+        {
+            benchmark::DoNotOptimize(std::minmax_element(in.begin(), in.end()));
+        }
+        set_items(state);
+    }
+
+    void simd_count_greater(benchmark::State& state)
+    {
+        const auto in = random_lengths<millimetre>();
+        for (auto _ : state)
+        {
+            benchmark::DoNotOptimize(simd::count_greater(in.data(), in.size(), 50_cm));
+        }
+        set_items(state);
+    }
+
+    void count_greater_raw_double(benchmark::State& state)
+    {
+        const auto in = random_values();
+        for (auto _ : state)
+        {
+            benchmark::DoNotOptimize(std::count_if(in.begin(), in.end(), [](double v) { return v > 500.0; }));
+        }
+        set_items(state);
+    }
+
+    // containers and expressions
+
+    void array_add_mixed_unit(benchmark::State& state)
+    {
+        const auto values = random_lengths<inch>();
+        LengthArray<metre> acc(bench_size, 1_m);
+        const LengthArray<inch> rhs(LengthArrayView<inch>{values.data(), values.size()});
+        for (auto _ : state)
+        {
+            acc += rhs;
+            benchmark::DoNotOptimize(acc.data());
+            benchmark::ClobberMemory();
+        }
+        set_items(state);
+    }
+
+    void expression_assign(benchmark::State& state)
+    {
+        const auto a = random_lengths<metre>();
+        const auto b = random_lengths<inch>(bench_size, 7);
+        LengthArray<metre> out(bench_size);
+        for (auto _ : state)
+        {
+            expr::assign(out, (expr::lazy(a.data(), a.size()) + expr::lazy(b.data(), b.size())) * 0.5);
+            benchmark::DoNotOptimize(out.data());
+            benchmark::ClobberMemory();
+        }
+        set_items(state);
+    }
+
+    void expression_raw_double(benchmark::State& state)
+    {
+        const auto a = random_values();
+        const auto b = random_values(bench_size, 0.5, 1000.0, 7);
+        std::vector<double> out(bench_size);
+        for (auto _ : state)
+        {
+            for (std::size_t i = 0; i < bench_size; ++i)
+            {
+                out[i] = (a[i] + b[i] * 0.0254) * 0.5;
+            }
+            benchmark::DoNotOptimize(out.data());
+            benchmark::ClobberMemory();
+        }
+        set_items(state);
+    }
+
+    // geometry
+
+    void distance_n_points(benchmark::State& state)
+    {
+        const auto values = random_values(6 * bench_size);
+        std::vector<Point3<metre>> a(bench_size);
+        std::vector<Point3<metre>> b(bench_size);
+        std::copy_n(values.data(), 3 * bench_size, as_values(&a[0].x));
+        std::copy_n(values.data() + 3 * bench_size, 3 * bench_size, as_values(&b[0].x));
+        std::vector<Length<metre>> out(bench_size);
+        for (auto _ : state)
+        {
+            distance_n(a.data(), b.data(), bench_size, out.data());
+            benchmark::DoNotOptimize(out.data());
+            benchmark::ClobberMemory();
+        }
+        set_items(state);
+    }
+
+    void distance_raw_double(benchmark::State& state)
+    {
+        const auto a = random_values(3 * bench_size);
+        const auto b = random_values(3 * bench_size, 0.5, 1000.0, 7);
+        std::vector<double> out(bench_size);
+        for (auto _ : state)
+        {
+            for (std::size_t i = 0; i < bench_size; ++i)
+            {
+                const double dx = a[3 * i] - b[3 * i];
+                const double dy = a[3 * i + 1] - b[3 * i + 1];
+                const double dz = a[3 * i + 2] - b[3 * i + 2];
+                out[i] = std::sqrt(dx * dx + dy * dy + dz * dz);
+            }
+            benchmark::DoNotOptimize(out.data());
+            benchmark::ClobberMemory();
+        }
+        set_items(state);
+    }
+
+    // parallel
+
+    void parallel_convert_n(benchmark::State& state)
+    {
+        const auto in = random_lengths<inch>(parallel_size);
+        std::vector<Length<metre>> out(in.size());
+        thread_pool pool;
+        for (auto _ : state)
+        {
+            convert_n<inch, metre>(pool, in.data(), in.size(), out.data());
+            benchmark::DoNotOptimize(out.data());
+            benchmark::ClobberMemory();
+        }
+        set_items(state, parallel_size);
+    }
+
+    void parallel_sum(benchmark::State& state)
+    {
+        const auto in = random_lengths<metre>(parallel_size);
+        thread_pool pool;
+        for (auto _ : state)
+        {
+            benchmark::DoNotOptimize(simd::sum(pool, in.data(), in.size()));
+        }
+        set_items(state, parallel_size);
+    }
+
+    void parallel_sum_raw_double(benchmark::State& state)
+    {
+        const auto in = random_values(parallel_size);
+        for (auto _ : state)
+        {
+            benchmark::DoNotOptimize(std::accumulate(in.begin(), in.end(), 0.0));
+        }
+        set_items(state, parallel_size);
+    }
+}
+
+BENCHMARK(bulk_convert_n<inch, metre, double>);
+BENCHMARK(bulk_convert_n<inch, metre, float>);
+BENCHMARK(bulk_convert_n<foot, inch, std::int32_t>);
+BENCHMARK(bulk_convert_n<metre, metre, double>);
+BENCHMARK(bulk_convert_dynamic);
+BENCHMARK(bulk_to_exact_n);
+BENCHMARK(simd_sum);
+BENCHMARK(sum_raw_double);
+BENCHMARK(accumulate_compensated);
+BENCHMARK(sum_raw_long_double);
+BENCHMARK(search_lower_bound_mixed_unit);
+BENCHMARK(search_lower_bound_per_element_convert);
+BENCHMARK(simd_scale);
+BENCHMARK(simd_minmax);
+BENCHMARK(minmax_raw_double);
+BENCHMARK(simd_count_greater);
+BENCHMARK(count_greater_raw_double);
+BENCHMARK(array_add_mixed_unit);
+BENCHMARK(expression_assign);
+BENCHMARK(expression_raw_double);
+BENCHMARK(distance_n_points);
+BENCHMARK(distance_raw_double);
+BENCHMARK(parallel_convert_n)->UseRealTime();
+BENCHMARK(parallel_sum)->UseRealTime();
+BENCHMARK(parallel_sum_raw_double)->UseRealTime();
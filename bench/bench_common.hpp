@@ -0,0 +1,104 @@
+/*********************************************************************************
+ *
+ *  MIT License
+ *
+ *  Copyright (c) 2017 Nenad Zikic
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ *********************************************************************************/
+
+
+#pragma once
+
+#include <benchmark/benchmark.h>
+
+#include <length/length.hpp>
+
+#include <cstddef>
+#include <random>
+#include <thread>
+#include <vector>
+
+
+// Shared inputs of benchmarks, every benchmark processes `bench_size` values
+// per iteration so results of lengths and raw doubles compare directly.
+
+namespace length::bench
+{
+
+    inline constexpr std::size_t bench_size = 4096;
+
+    /** Uniformly distributed `n` values from [lo, hi), same on every run **/
+    template <typename Rep = double>
+    std::vector<Rep> random_values(std::size_t n = bench_size, double lo = 0.5, double hi = 1000.0, unsigned seed = 42)
+    {
+        std::mt19937_64 engine{seed};
+        std::uniform_real_distribution<double> dist{lo, hi};
+        std::vector<Rep> values(n);
+        for (Rep& v : values)
+        {
+            v = static_cast<Rep>(dist(engine));
+        }
+        return values;
+    }
+
+    template <typename Unit, typename Rep = double>
+    std::vector<Length<Unit, Rep>> random_lengths(std::size_t n = bench_size, unsigned seed = 42)
+    {
+        const std::vector<Rep> values = random_values<Rep>(n, 0.5, 1000.0, seed);
+        std::vector<Length<Unit, Rep>> lengths(n);
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            lengths[i] = Length<Unit, Rep>{values[i]};
+        }
+        return lengths;
+    }
+
+    /** Values processed per iteration, reported as items/s **/
+    inline void set_items(benchmark::State& state, std::size_t per_iteration = bench_size)
+    {
+        state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * per_iteration));
+    }
+
+    /** Minimal thread pool for parallel overloads, runs chunks on all hardware threads **/
+    struct thread_pool
+    {
+            template <typename Task>
+            void parallel_for(std::size_t count, Task task)
+            {
+                const std::size_t workers = std::max(1u, std::thread::hardware_concurrency());
+                std::vector<std::thread> threads;
+                threads.reserve(workers);
+                for (std::size_t w = 0; w < workers; ++w)
+                {
+                    threads.emplace_back([=] {
+                        for (std::size_t i = w; i < count; i += workers)
+                        {
+                            task(i);
+                        }
+                    });
+                }
+                for (std::thread& t : threads)
+                {
+                    t.join();
+                }
+            }
+    };
+}
@@ -0,0 +1,187 @@
+/*********************************************************************************
+ *
+ *  MIT License
+ *
+ *  Copyright (c) 2017 Nenad Zikic
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ *********************************************************************************/
+
+
+// Scalar API of `length.hpp`: conversions between every pair of built-in
+// units, arithmetic operators and literals, each next to raw double baseline.
+
+#include "bench_common.hpp"
+
+#include <length/dynamic_length.hpp>
+
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+
+namespace
+{
+    using namespace length;
+    using namespace length::bench;
+
+    // conversions
+
+    template <typename FromUnit, typename ToUnit>
+    void convert_units(benchmark::State& state)
+    {
+        const auto in = random_lengths<FromUnit>();
+        std::vector<Length<ToUnit>> out(in.size());
+        for (auto _ : state)
+        {
+            for (std::size_t i = 0; i < in.size(); ++i)
+            {
+                out[i] = convert<FromUnit, ToUnit>(in[i]);
+            }
+            benchmark::DoNotOptimize(out.data());
+            benchmark::ClobberMemory();
+        }
+        set_items(state);
+    }
+
+    void convert_raw_double(benchmark::State& state)
+    {
+        const auto in = random_values();
+        std::vector<double> out(in.size());
+        const double factor = 0.0254;
+        for (auto _ : state)
+        {
+            for (std::size_t i = 0; i < in.size(); ++i)
+            {
+                out[i] = in[i] * factor;
+            }
+            benchmark::DoNotOptimize(out.data());
+            benchmark::ClobberMemory();
+        }
+        set_items(state);
+    }
+
+    template <typename FromUnit, std::size_t... To>
+    void register_convert_from(std::index_sequence<To...>)
+    {
+        (benchmark::RegisterBenchmark(("convert/" + std::string{FromUnit::symbol} + "/" +
+                                       std::string{std::tuple_element_t<To, dynamic_units>::symbol}).c_str(),
+                                      convert_units<FromUnit, std::tuple_element_t<To, dynamic_units>>), ...);
+    }
+
+    template <std::size_t... From>
+    void register_convert(std::index_sequence<From...> units)
+    {
+        (register_convert_from<std::tuple_element_t<From, dynamic_units>>(units), ...);
+    }
+
+    const bool convert_registered = [] {
+        register_convert(std::make_index_sequence<unit_count>{});
+        benchmark::RegisterBenchmark("convert/raw_double", convert_raw_double);
+        return true;
+    }();
+
+    // operators, `lhs[i] op rhs[i]` over whole arrays
+
+    template <typename L, typename R, typename Op>
+    void binary_op(benchmark::State& state, const std::vector<L>& lhs, const std::vector<R>& rhs, Op op)
+    {
+        // comparisons are stored as bytes, `std::vector<bool>` packing would dominate the loop
+        using result = decltype(op(lhs[0], rhs[0]));
+        std::vector<std::conditional_t<std::is_same_v<result, bool>, unsigned char, result>> out(lhs.size());
+        for (auto _ : state)
+        {
+            for (std::size_t i = 0; i < lhs.size(); ++i)
+            {
+                out[i] = op(lhs[i], rhs[i]);
+            }
+            benchmark::DoNotOptimize(out.data());
+            benchmark::ClobberMemory();
+        }
+        set_items(state);
+    }
+
+    void add_same_unit(benchmark::State& state)   { binary_op(state, random_lengths<metre>(), random_lengths<metre>(bench_size, 7), [](auto a, auto b) { return a + b; }); }
+    void add_mixed_unit(benchmark::State& state)  { binary_op(state, random_lengths<metre>(), random_lengths<inch>(bench_size, 7), [](auto a, auto b) { return a + b; }); }
+    void add_raw_double(benchmark::State& state)  { binary_op(state, random_values(), random_values(bench_size, 0.5, 1000.0, 7), [](double a, double b) { return a + b; }); }
+    void sub_same_unit(benchmark::State& state)   { binary_op(state, random_lengths<metre>(), random_lengths<metre>(bench_size, 7), [](auto a, auto b) { return a - b; }); }
+    void sub_mixed_unit(benchmark::State& state)  { binary_op(state, random_lengths<metre>(), random_lengths<inch>(bench_size, 7), [](auto a, auto b) { return a - b; }); }
+    void sub_raw_double(benchmark::State& state)  { binary_op(state, random_values(), random_values(bench_size, 0.5, 1000.0, 7), [](double a, double b) { return a - b; }); }
+    void mul_scalar(benchmark::State& state)      { binary_op(state, random_lengths<metre>(), random_values(bench_size, 0.5, 1000.0, 7), [](auto a, double k) { return a * k; }); }
+    void mul_raw_double(benchmark::State& state)  { binary_op(state, random_values(), random_values(bench_size, 0.5, 1000.0, 7), [](double a, double b) { return a * b; }); }
+    void div_scalar(benchmark::State& state)      { binary_op(state, random_lengths<metre>(), random_values(bench_size, 0.5, 1000.0, 7), [](auto a, double k) { return a / k; }); }
+    void div_length_ratio(benchmark::State& state){ binary_op(state, random_lengths<metre>(), random_lengths<foot>(bench_size, 7), [](auto a, auto b) { return a / b; }); }
+    void div_raw_double(benchmark::State& state)  { binary_op(state, random_values(), random_values(bench_size, 0.5, 1000.0, 7), [](double a, double b) { return a / b; }); }
+    void eq_mixed_unit(benchmark::State& state)   { binary_op(state, random_lengths<metre>(), random_lengths<centimetre>(bench_size, 7), [](auto a, auto b) { return a == b; }); }
+    void eq_raw_double(benchmark::State& state)   { binary_op(state, random_values(), random_values(bench_size, 0.5, 1000.0, 7), [](double a, double b) { return a == b * 0.01; }); }
+    void literal_add(benchmark::State& state)     { binary_op(state, random_lengths<metre>(), random_lengths<metre>(bench_size, 7), [](auto a, auto) { return a + 25_cm; }); }
+    void literal_raw_double(benchmark::State& state) { binary_op(state, random_values(), random_values(), [](double a, double) { return a + 0.25; }); }
+
+    void compound_add(benchmark::State& state)
+    {
+        auto acc = random_lengths<metre>();
+        const auto rhs = random_lengths<millimetre>(bench_size, 7);
+        for (auto _ : state)
+        {
+            for (std::size_t i = 0; i < acc.size(); ++i)
+            {
+                acc[i] += rhs[i];
+            }
+            benchmark::DoNotOptimize(acc.data());
+            benchmark::ClobberMemory();
+        }
+        set_items(state);
+    }
+
+    void compound_add_raw_double(benchmark::State& state)
+    {
+        auto acc = random_values();
+        const auto rhs = random_values(bench_size, 0.5, 1000.0, 7);
+        for (auto _ : state)
+        {
+            for (std::size_t i = 0; i < acc.size(); ++i)
+            {
+                acc[i] += rhs[i] * 0.001;
+            }
+            benchmark::DoNotOptimize(acc.data());
+            benchmark::ClobberMemory();
+        }
+        set_items(state);
+    }
+}
+
+BENCHMARK(add_same_unit);
+BENCHMARK(add_mixed_unit);
+BENCHMARK(add_raw_double);
+BENCHMARK(sub_same_unit);
+BENCHMARK(sub_mixed_unit);
+BENCHMARK(sub_raw_double);
+BENCHMARK(mul_scalar);
+BENCHMARK(mul_raw_double);
+BENCHMARK(div_scalar);
+BENCHMARK(div_length_ratio);
+BENCHMARK(div_raw_double);
+BENCHMARK(eq_mixed_unit);
+BENCHMARK(eq_raw_double);
+BENCHMARK(compound_add);
+BENCHMARK(compound_add_raw_double);
+BENCHMARK(literal_add);
+BENCHMARK(literal_raw_double);
@@ -0,0 +1,156 @@
+/*********************************************************************************
+ *
+ *  MIT License
+ *
+ *  Copyright (c) 2017 Nenad Zikic
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ *********************************************************************************/
+
+
+// Parsing and formatting of lengths next to `std::from_chars` / `std::to_chars`
+// of raw doubles, i.e. the cost of unit symbols on top of number conversion.
+
+#include "bench_common.hpp"
+
+#include <length/format.hpp>
+#include <length/parse.hpp>
+
+#include <charconv>
+#include <iterator>
+#include <string>
+
+
+namespace
+{
+    using namespace length;
+    using namespace length::bench;
+
+    const char* const test_symbols[] = {" mm", " cm", " m", " in", " ft", " nmi"};
+
+    /** `bench_size` comma separated lengths like "12.5 mm,3.25 ft" **/
+    std::string length_csv(bool with_units)
+    {
+        const auto values = random_values();
+        std::string csv;
+        char buffer[64];
+        for (std::size_t i = 0; i < values.size(); ++i)
+        {
+            char* end = std::to_chars(buffer, buffer + sizeof buffer, values[i]).ptr;
+            csv.append(buffer, end);
+            if (with_units)
+            {
+                csv += test_symbols[i % std::size(test_symbols)];
+            }
+            csv += ',';
+        }
+        return csv;
+    }
+
+    void parse_single(benchmark::State& state)
+    {
+        const std::string_view text = "1234.5678 mm";
+        Length<metre> out;
+        for (auto _ : state)
+        {
+            benchmark::DoNotOptimize(parse(text, out));
+            benchmark::DoNotOptimize(out);
+        }
+        state.SetItemsProcessed(state.iterations());
+    }
+
+    void parse_single_raw_double(benchmark::State& state)
+    {
+        const std::string_view text = "1234.5678";
+        double out;
+        for (auto _ : state)
+        {
+            benchmark::DoNotOptimize(std::from_chars(text.data(), text.data() + text.size(), out));
+            benchmark::DoNotOptimize(out);
+        }
+        state.SetItemsProcessed(state.iterations());
+    }
+
+    void parse_n_csv(benchmark::State& state)
+    {
+        const std::string csv = length_csv(true);
+        std::vector<Length<metre>> out(bench_size);
+        for (auto _ : state)
+        {
+            benchmark::DoNotOptimize(parse_n(csv.data(), csv.data() + csv.size(), ',', out.data(), out.size()));
+            benchmark::ClobberMemory();
+        }
+        set_items(state);
+        state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * csv.size()));
+    }
+
+    void parse_csv_raw_double(benchmark::State& state)
+    {
+        const std::string csv = length_csv(false);
+        std::vector<double> out(bench_size);
+        for (auto _ : state)
+        {
+            const char* p   = csv.data();
+            const char* end = csv.data() + csv.size();
+            for (std::size_t i = 0; i < out.size() && p != end; ++i)
+            {
+                p = std::from_chars(p, end, out[i]).ptr + 1;
+            }
+            benchmark::ClobberMemory();
+        }
+        set_items(state);
+        state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * csv.size()));
+    }
+
+    void format_to_chars(benchmark::State& state)
+    {
+        const auto in = random_lengths<millimetre>();
+        char buffer[64];
+        for (auto _ : state)
+        {
+            for (const auto& len : in)
+            {
+                benchmark::DoNotOptimize(to_chars(buffer, buffer + sizeof buffer, len));
+            }
+        }
+        set_items(state);
+    }
+
+    void format_raw_double(benchmark::State& state)
+    {
+        const auto in = random_values();
+        char buffer[64];
+        for (auto _ : state)
+        {
+            for (const double v : in)
+            {
+                benchmark::DoNotOptimize(std::to_chars(buffer, buffer + sizeof buffer, v));
+            }
+        }
+        set_items(state);
+    }
+}
+
+BENCHMARK(parse_single);
+BENCHMARK(parse_single_raw_double);
+BENCHMARK(parse_n_csv);
+BENCHMARK(parse_csv_raw_double);
+BENCHMARK(format_to_chars);
+BENCHMARK(format_raw_double);
@@ -0,0 +1,92 @@
+/*********************************************************************************
+ *
+ *  MIT License
+ *
+ *  Copyright (c) 2017 Nenad Zikic
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ *********************************************************************************/
+
+
+
+// Synthetic translation unit for compile-time measurements: every operator of
+// `length.hpp` instantiated for every pair of built-in units and representations.
+// Built once as C++17 (SFINAE constrained operators) and once as C++20 (concept
+// constrained operators) by `length_compile_time`, see bench/CMakeLists.txt.
+
+#include <length/dynamic_length.hpp>
+
+#include <cstddef>
+#include <tuple>
+#include <utility>
+
+
+namespace
+{
+    using namespace length;
+
+    using reps = std::tuple<float, double, int, long long>;
+
+    template <typename Unit1, typename Rep1, typename Unit2, typename Rep2>
+    double every_operator(Length<Unit1, Rep1> a, Length<Unit2, Rep2> b)
+    {
+        Length<Unit1, Rep1> c = a;
+        c += b;
+        c -= b;
+        c *= Rep1{2};
+        c /= Rep1{2};
+
+        const bool compared = (a == b) + (a != b) + (a < b) + (a <= b) + (a > b) + (a >= b);
+        const auto sum = a + b;
+        const auto difference = a - b;
+        const auto scaled = Rep2{3} * b * Rep2{2} / Rep2{4};
+        const auto ratio = a / b;
+        const auto converted = convert<Unit1, Unit2>(c);
+
+        return compared + sum.value() + difference.value() + scaled.value() + ratio + converted.value();
+    }
+
+    template <typename Unit1, typename Rep1, typename Unit2, std::size_t... R>
+    double every_rep(std::index_sequence<R...>)
+    {
+        return (every_operator(Length<Unit1, Rep1>{Rep1{1}}, Length<Unit2, std::tuple_element_t<R, reps>>{1}) + ...);
+    }
+
+    template <typename Unit1, std::size_t... U>
+    double every_unit(std::index_sequence<U...>)
+    {
+        constexpr auto rep_indices = std::make_index_sequence<std::tuple_size_v<reps>>{};
+        return ((every_rep<Unit1, float, std::tuple_element_t<U, dynamic_units>>(rep_indices) +
+                 every_rep<Unit1, double, std::tuple_element_t<U, dynamic_units>>(rep_indices) +
+                 every_rep<Unit1, int, std::tuple_element_t<U, dynamic_units>>(rep_indices) +
+                 every_rep<Unit1, long long, std::tuple_element_t<U, dynamic_units>>(rep_indices)) + ...);
+    }
+
+    template <std::size_t... U>
+    double every_pair(std::index_sequence<U...> units)
+    {
+        return (every_unit<std::tuple_element_t<U, dynamic_units>>(units) + ...);
+    }
+}
+
+double length_compile_time()
+{
+    return every_pair(std::make_index_sequence<std::tuple_size_v<dynamic_units>>{});
+}
@@ -0,0 +1,153 @@
+/*********************************************************************************
+ *
+ *  MIT License
+ *
+ *  Copyright (c) 2017 Nenad Zikic
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ *********************************************************************************/
+
+
+#pragma once
+
+#include "length.hpp"
+#include "simd.hpp"
+
+#include <cstddef>
+#include <type_traits>
+
+
+namespace length
+{
+
+    namespace detail
+    {
+        /** Error free `sum + x`, rounding error of the addition goes to `error` (Knuth's TwoSum) **/
+        template <typename Rep>
+        constexpr void two_sum(Rep& sum, Rep& error, Rep x)
+        {
+            const Rep t  = sum + x;
+            const Rep bp = t - sum;
+            error += (sum - (t - bp)) + (x - bp);
+            sum = t;
+        }
+    }
+
+    /** Compensated running total of lengths in `Unit`
+     *
+     * Keeps rounding error of every addition in a separate term, so totals of millions of
+     * lengths of very different magnitudes are as accurate as if summed in twice the
+     * precision of `Rep`. Lengths in other units are converted once per add, runs of them
+     * go through the vectorised multi-lane kernel. Accumulators of parallel chunks
+     * combine losslessly with `merge`. Needs strict IEEE arithmetic, i.e. no `-ffast-math`.
+     *
+     * @example usage
+     *          1. LengthAccumulator<metre> total;
+     *             total += 1_in;
+     *             total.add(segments.data(), segments.size());
+     *             Length<metre> result = total.total();
+     */
+    template <typename Unit, typename Rep = double>
+    class LengthAccumulator
+    {
+            static_assert (std::is_floating_point_v<Rep>, "`LengthAccumulator` is for floating point reps, integral sums are already exact");
+
+            template <typename, typename>
+            friend class LengthAccumulator;
+
+            Rep m_sum   = Rep{};
+            Rep m_error = Rep{};
+
+        public:
+            using unit       = Unit;
+            using rep        = Rep;
+            using value_type = Length<Unit, Rep>;
+
+            constexpr LengthAccumulator() = default;
+            constexpr explicit LengthAccumulator(value_type initial) : m_sum{initial.value()} {}
+
+            /** Adds single length, any unit **/
+            template <typename Unit2>
+            constexpr LengthAccumulator& add(const Length<Unit2, Rep>& length)
+            {
+                detail::two_sum(m_sum, m_error, convert<Unit2, Unit>(length).value());
+                return *this;
+            }
+
+            /** Adds `n` lengths starting at `data`, converted by one folded factor **/
+            template <typename Unit2>
+            LengthAccumulator& add(const Length<Unit2, Rep>* data, std::size_t n)
+            {
+                using r = detail::conversion_ratio<Unit2, Unit>;
+                simd::detail::compensated_sum(as_values(data), n, detail::conversion_factor<Rep, r>, m_sum, m_error);
+                return *this;
+            }
+
+#if defined(__cpp_lib_span)
+            template <typename Unit2, std::size_t Extent>
+            LengthAccumulator& add(std::span<const Length<Unit2, Rep>, Extent> data) { return add(data.data(), data.size()); }
+#endif
+
+            /** Adds total of `other`, e.g. partial accumulator of another thread **/
+            template <typename Unit2>
+            constexpr LengthAccumulator& merge(const LengthAccumulator<Unit2, Rep>& other)
+            {
+                using r = detail::conversion_ratio<Unit2, Unit>;
+                detail::two_sum(m_sum, m_error, other.m_sum * detail::conversion_factor<Rep, r>);
+                m_error += other.m_error * detail::conversion_factor<Rep, r>;
+                return *this;
+            }
+
+            template <typename Unit2>
+            constexpr LengthAccumulator& operator+= (const Length<Unit2, Rep>& length) { return add(length); }
+
+            template <typename Unit2>
+            constexpr LengthAccumulator& operator+= (const LengthAccumulator<Unit2, Rep>& other) { return merge(other); }
+
+            /** Compensated total **/
+            [[nodiscard]] constexpr value_type total() const { return value_type{m_sum + m_error}; }
+
+            /** Accumulated rounding error not yet folded into the total **/
+            [[nodiscard]] constexpr value_type error() const { return value_type{m_error}; }
+
+            constexpr void reset() { m_sum = m_error = Rep{}; }
+    };
+
+    /** Compensated sum of `n` lengths starting at `data`, in units `ToUnit` (units of `data` by default)
+     *
+     * @example usage
+     *          1. Length<metre> perimeter = accumulate<metre>(edges.data(), edges.size()).total();
+     */
+    template <typename ToUnit = void, typename Unit, typename Rep>
+    [[nodiscard]] auto accumulate(const Length<Unit, Rep>* data, std::size_t n)
+    {
+        LengthAccumulator<std::conditional_t<std::is_void_v<ToUnit>, Unit, ToUnit>, Rep> acc;
+        acc.add(data, n);
+        return acc;
+    }
+
+
+    //////////////////
+    // layout
+    //////////////////
+
+    static_assert (sizeof(LengthAccumulator<metre>) == 2 * sizeof(double));
+
+}
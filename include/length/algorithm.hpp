@@ -0,0 +1,147 @@
+/*********************************************************************************
+ *
+ *  MIT License
+ *
+ *  Copyright (c) 2017 Nenad Zikic
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ *********************************************************************************/
+
+
+#pragma once
+
+#include "length.hpp"
+#include "length_array.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+
+// Sorting and sorted search over contiguous lengths of one unit.
+//
+// Sorting only moves raw `Rep` values. Search keys may be in any unit and are
+// converted once, before the search, so every probe is a plain `Rep` comparison
+// instead of a mixed-unit `operator<` rescaling the element. Integral keys are
+// rounded towards the element unit such that results match exact mixed-unit
+// comparison; floating point keys are converted like the right operand of
+// `element < key`.
+
+namespace length
+{
+
+    /** Sorts `n` lengths starting at `data` in ascending order **/
+    template <typename Unit, typename Rep>
+    void sort(Length<Unit, Rep>* data, std::size_t n)
+    {
+        Rep* values = as_values(data);
+        std::sort(values, values + n);
+    }
+
+    template <typename Unit, typename Rep, typename Allocator>
+    void sort(LengthArray<Unit, Rep, Allocator>& array) { sort(array.data(), array.size()); }
+
+    /** Partially sorts `n` lengths starting at `data` so `data[nth]` is the length that would be there if sorted
+     *
+     * @example usage
+     *          1. nth_element(depths, depths.size() / 2); // median at depths[depths.size() / 2]
+     */
+    template <typename Unit, typename Rep>
+    void nth_element(Length<Unit, Rep>* data, std::size_t n, std::size_t nth)
+    {
+        Rep* values = as_values(data);
+        std::nth_element(values, values + nth, values + n);
+    }
+
+    template <typename Unit, typename Rep, typename Allocator>
+    void nth_element(LengthArray<Unit, Rep, Allocator>& array, std::size_t nth) { nth_element(array.data(), array.size(), nth); }
+
+    /** First of `n` sorted lengths starting at `data` not less than `key`, `key` converted once
+     *
+     * @example usage
+     *          1. const Length<millimetre>* first = lower_bound(sorted.data(), sorted.size(), 6_in);
+     */
+    template <typename Unit, typename Rep, typename Unit2, typename Rep2>
+    [[nodiscard]] const Length<Unit, Rep>* lower_bound(const Length<Unit, Rep>* data, std::size_t n, const Length<Unit2, Rep2>& key)
+    {
+        using CR = detail::common_rep_t<Rep, Rep2>;
+        const CR k = detail::search_key<Unit, Rep, detail::key_rounding::up>(key);
+        const Rep* values = as_values(data);
+        return data + (std::lower_bound(values, values + n, k, [](Rep v, CR t) { return static_cast<CR>(v) < t; }) - values);
+    }
+
+    /** First of `n` sorted lengths starting at `data` greater than `key`, `key` converted once **/
+    template <typename Unit, typename Rep, typename Unit2, typename Rep2>
+    [[nodiscard]] const Length<Unit, Rep>* upper_bound(const Length<Unit, Rep>* data, std::size_t n, const Length<Unit2, Rep2>& key)
+    {
+        using CR = detail::common_rep_t<Rep, Rep2>;
+        const CR k = detail::search_key<Unit, Rep, detail::key_rounding::down>(key);
+        const Rep* values = as_values(data);
+        return data + (std::upper_bound(values, values + n, k, [](CR t, Rep v) { return t < static_cast<CR>(v); }) - values);
+    }
+
+    /** Range of `n` sorted lengths starting at `data` equal to `key` **/
+    template <typename Unit, typename Rep, typename Unit2, typename Rep2>
+    [[nodiscard]] std::pair<const Length<Unit, Rep>*, const Length<Unit, Rep>*>
+    equal_range(const Length<Unit, Rep>* data, std::size_t n, const Length<Unit2, Rep2>& key)
+    {
+        const Length<Unit, Rep>* first = lower_bound(data, n, key);
+        return {first, upper_bound(first, static_cast<std::size_t>(data + n - first), key)};
+    }
+
+    template <typename Unit, typename Rep, typename Unit2, typename Rep2>
+    [[nodiscard]] const Length<Unit, Rep>* lower_bound(LengthArrayView<Unit, Rep> sorted, const Length<Unit2, Rep2>& key)
+    {
+        return lower_bound(sorted.data(), sorted.size(), key);
+    }
+
+    template <typename Unit, typename Rep, typename Unit2, typename Rep2>
+    [[nodiscard]] const Length<Unit, Rep>* upper_bound(LengthArrayView<Unit, Rep> sorted, const Length<Unit2, Rep2>& key)
+    {
+        return upper_bound(sorted.data(), sorted.size(), key);
+    }
+
+    template <typename Unit, typename Rep, typename Unit2, typename Rep2>
+    [[nodiscard]] std::pair<const Length<Unit, Rep>*, const Length<Unit, Rep>*>
+    equal_range(LengthArrayView<Unit, Rep> sorted, const Length<Unit2, Rep2>& key)
+    {
+        return equal_range(sorted.data(), sorted.size(), key);
+    }
+
+    template <typename Unit, typename Rep, typename Allocator, typename Unit2, typename Rep2>
+    [[nodiscard]] const Length<Unit, Rep>* lower_bound(const LengthArray<Unit, Rep, Allocator>& sorted, const Length<Unit2, Rep2>& key)
+    {
+        return lower_bound(sorted.data(), sorted.size(), key);
+    }
+
+    template <typename Unit, typename Rep, typename Allocator, typename Unit2, typename Rep2>
+    [[nodiscard]] const Length<Unit, Rep>* upper_bound(const LengthArray<Unit, Rep, Allocator>& sorted, const Length<Unit2, Rep2>& key)
+    {
+        return upper_bound(sorted.data(), sorted.size(), key);
+    }
+
+    template <typename Unit, typename Rep, typename Allocator, typename Unit2, typename Rep2>
+    [[nodiscard]] std::pair<const Length<Unit, Rep>*, const Length<Unit, Rep>*>
+    equal_range(const LengthArray<Unit, Rep, Allocator>& sorted, const Length<Unit2, Rep2>& key)
+    {
+        return equal_range(sorted.data(), sorted.size(), key);
+    }
+}
@@ -0,0 +1,201 @@
+/*********************************************************************************
+ *
+ *  MIT License
+ *
+ *  Copyright (c) 2017 Nenad Zikic
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ *********************************************************************************/
+
+
+#pragma once
+
+#include "length_array.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+#if __has_include(<memory_resource>)
+#include <memory_resource>
+#endif
+
+
+// Bump allocating arena for short lived, SIMD friendly length buffers.
+//
+// Intended use is one arena per request: every `pmr::LengthArray` and temporary of
+// the request is carved out of the same chunk by bumping a pointer, deallocation
+// is a no-op, and `reset` rewinds the arena for the next request while keeping its
+// largest chunk, so steady state needs no upstream allocation at all.
+
+#if defined(__cpp_lib_memory_resource)
+
+namespace length::pmr
+{
+
+    /** Monotonic `std::pmr::memory_resource` handing out 64-byte aligned, 64-byte padded blocks
+     *
+     * Unlike `std::pmr::monotonic_buffer_resource`, buffers never share a cache line,
+     * so SIMD kernels over neighbouring arrays don't false share or split loads, and
+     * `reset` keeps memory for reuse. Not thread safe, use one arena per thread.
+     *
+     * @example usage
+     *          1. AlignedArena arena{256 * 1024};
+     *             pmr::LengthArray<metre> points(n, {}, &arena);
+     *             auto total = expr::evaluate(expr::lazy(points) * 2.0, std::pmr::polymorphic_allocator<double>{&arena});
+     *             arena.reset(); // end of request
+     */
+    class AlignedArena : public std::pmr::memory_resource
+    {
+            static constexpr std::size_t alignment = length::detail::array_alignment;
+
+            /** Header in the first cache line of every upstream chunk **/
+            struct chunk
+            {
+                chunk*      next;
+                std::size_t bytes;
+            };
+
+            static_assert (sizeof(chunk) <= alignment);
+
+            std::pmr::memory_resource* m_upstream;
+            std::size_t                m_next_chunk_bytes;
+            chunk*                     m_chunks = nullptr;   // newest and largest first
+            std::byte*                 m_buffer = nullptr;   // caller supplied initial buffer
+            std::size_t                m_buffer_bytes = 0;
+            std::byte*                 m_cursor = nullptr;
+            std::byte*                 m_end    = nullptr;
+
+            [[nodiscard]] static constexpr std::size_t round_up(std::size_t bytes, std::size_t to) { return (bytes + to - 1) / to * to; }
+
+            [[nodiscard]] static std::byte* align_up(std::byte* p, std::size_t to)
+            {
+                const auto address = reinterpret_cast<std::uintptr_t>(p);
+                return p + (round_up(address, to) - address);
+            }
+
+            void use(std::byte* first, std::byte* last)
+            {
+                m_cursor = first;
+                m_end    = last;
+            }
+
+            void use_buffer()
+            {
+                if (m_buffer != nullptr)
+                {
+                    use(align_up(m_buffer, alignment), m_buffer + m_buffer_bytes);
+                    if (m_cursor > m_end) m_cursor = m_end;
+                }
+                else
+                {
+                    use(nullptr, nullptr);
+                }
+            }
+
+            void use_chunk(chunk* c) { use(reinterpret_cast<std::byte*>(c) + alignment, reinterpret_cast<std::byte*>(c) + c->bytes); }
+
+            void free_chunks(chunk* c) noexcept
+            {
+                while (c != nullptr)
+                {
+                    chunk* next = c->next;
+                    m_upstream->deallocate(c, c->bytes, alignment);
+                    c = next;
+                }
+            }
+
+            void grow(std::size_t bytes, std::size_t align)
+            {
+                const std::size_t chunk_bytes = round_up(std::max(m_next_chunk_bytes, alignment + bytes + align), alignment);
+                chunk* c = static_cast<chunk*>(m_upstream->allocate(chunk_bytes, alignment));
+                c->next  = m_chunks;
+                c->bytes = chunk_bytes;
+                m_chunks = c;
+                m_next_chunk_bytes = 2 * chunk_bytes;
+                use_chunk(c);
+            }
+
+        protected:
+            void* do_allocate(std::size_t bytes, std::size_t align) override
+            {
+                align = std::max(align, alignment);
+                bytes = round_up(std::max<std::size_t>(bytes, 1), alignment);
+                std::byte* p = align_up(m_cursor, align);
+                if (m_cursor == nullptr || p > m_end || static_cast<std::size_t>(m_end - p) < bytes)
+                {
+                    grow(bytes, align);
+                    p = align_up(m_cursor, align);
+                }
+                m_cursor = p + bytes;
+                return p;
+            }
+
+            void do_deallocate(void*, std::size_t, std::size_t) override {}
+
+            [[nodiscard]] bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+        public:
+            /** Arena whose first chunk of `initial_bytes` is allocated lazily from `upstream` **/
+            explicit AlignedArena(std::size_t initial_bytes = 64 * 1024,
+                                  std::pmr::memory_resource* upstream = std::pmr::get_default_resource())
+                : m_upstream{upstream}, m_next_chunk_bytes{round_up(std::max(initial_bytes, 2 * alignment), alignment)}
+            {}
+
+            /** Arena serving from caller `buffer` first, e.g. stack array, then from `upstream` **/
+            AlignedArena(void* buffer, std::size_t bytes,
+                         std::pmr::memory_resource* upstream = std::pmr::get_default_resource())
+                : m_upstream{upstream}, m_next_chunk_bytes{round_up(std::max(2 * bytes, 2 * alignment), alignment)},
+                  m_buffer{static_cast<std::byte*>(buffer)}, m_buffer_bytes{bytes}
+            {
+                use_buffer();
+            }
+
+            AlignedArena(const AlignedArena&) = delete;
+            AlignedArena& operator=(const AlignedArena&) = delete;
+
+            ~AlignedArena() override { free_chunks(m_chunks); }
+
+            /** Rewinds the arena, invalidating everything allocated from it, and keeps its largest chunk **/
+            void reset() noexcept
+            {
+                if (m_chunks == nullptr)
+                {
+                    use_buffer();
+                    return;
+                }
+                free_chunks(m_chunks->next);
+                m_chunks->next = nullptr;
+                use_chunk(m_chunks);
+            }
+
+            /** Rewinds the arena and returns all chunks to upstream **/
+            void release() noexcept
+            {
+                free_chunks(m_chunks);
+                m_chunks = nullptr;
+                use_buffer();
+            }
+
+            [[nodiscard]] std::pmr::memory_resource* upstream_resource() const noexcept { return m_upstream; }
+    };
+}
+
+#endif
@@ -0,0 +1,132 @@
+/*********************************************************************************
+ *
+ *  MIT License
+ *
+ *  Copyright (c) 2017 Nenad Zikic
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ *********************************************************************************/
+
+
+#pragma once
+
+#include "length.hpp"
+#include "simd.hpp"
+
+#include <algorithm>
+#include <cstddef>
+
+
+namespace length
+{
+
+    /** Converts `n` lengths of `FromUnit` starting at `in` to lengths of `ToUnit` written to `out`
+     *
+     * Same as calling `convert<FromUnit, ToUnit>` for every element, but floating point
+     * lengths go through explicitly vectorised kernel (SSE2/AVX2/AVX-512/NEON), picked at
+     * run time as the widest one the CPU supports, see `simd::active_isa`.
+     * `in` and `out` may point to the same buffer.
+     *
+     * @param in  - first of `n` lengths of unit `FromUnit` being converted
+     * @param n   - number of lengths to convert
+     * @param out - first of `n` lengths receiving results in units `ToUnit`
+     * @return - pointer one past the last written length
+     *
+     * @example usage
+     *          1. convert_n<inch, metre>(cad.data(), cad.size(), metres.data());
+     */
+    template <typename FromUnit, typename ToUnit, typename Rep>
+    Length<ToUnit, Rep>* convert_n(const Length<FromUnit, Rep>* in, std::size_t n, Length<ToUnit, Rep>* out)
+    {
+        using r = detail::conversion_ratio<FromUnit, ToUnit>;
+        LENGTH_INSTRUMENT(conversion, FromUnit, ToUnit, n);
+
+        const Rep* src = as_values(in);
+        Rep*       dst = as_values(out);
+
+        if constexpr (r::num == 1 && r::den == 1)
+        {
+            if (static_cast<const void*>(src) != static_cast<const void*>(dst))
+            {
+                std::copy_n(src, n, dst);
+            }
+        }
+        else if constexpr (std::is_floating_point_v<Rep>)
+        {
+            simd::detail::multiply(src, dst, n, detail::conversion_factor<Rep, r>);
+        }
+        else
+        {
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                dst[i] = detail::rescale<r>(src[i]);
+            }
+        }
+        return out + n;
+    }
+
+    /** Converts `n` lengths of `FromUnit` in place, reusing the same memory for `ToUnit` lengths
+     *
+     * @return - pointer to the converted lengths, aliasing `data`
+     *
+     * @example usage
+     *          1. Length<metre>* metres = convert_in_place<inch, metre>(buffer, count);
+     */
+    template <typename FromUnit, typename ToUnit, typename Rep>
+    Length<ToUnit, Rep>* convert_in_place(Length<FromUnit, Rep>* data, std::size_t n)
+    {
+        Length<ToUnit, Rep>* out = as_lengths<ToUnit>(as_values(data));
+        convert_n<FromUnit, ToUnit>(data, n, out);
+        return out;
+    }
+
+#if defined(__cpp_lib_span)
+    /** Converts contiguous range of `FromUnit` lengths into `out`
+     *
+     * Converts `min(in.size(), out.size())` lengths, so shorter `out` truncates the
+     * conversion instead of overrunning. `Rep` is not deduced, so any contiguous
+     * container converts implicitly.
+     *
+     * @return - the converted lengths, leading subspan of `out`
+     *
+     * @example usage
+     *          1. convert<inch, metre>(std::span{cad}, std::span{metres});
+     *          2. convert<foot, metre, float>(feet, metres);
+     */
+    template <typename FromUnit, typename ToUnit, typename Rep = double>
+    std::span<Length<ToUnit, Rep>> convert(std::span<const Length<FromUnit, std::type_identity_t<Rep>>> in,
+                                           std::span<Length<ToUnit, std::type_identity_t<Rep>>> out)
+    {
+        const std::size_t n = std::min(in.size(), out.size());
+        convert_n<FromUnit, ToUnit>(in.data(), n, out.data());
+        return out.first(n);
+    }
+
+    /** Converts contiguous range of `FromUnit` lengths in place
+     *
+     * @return - span of `ToUnit` lengths, aliasing `data`
+     */
+    template <typename FromUnit, typename ToUnit, typename Rep = double>
+    std::span<Length<ToUnit, Rep>> convert_in_place(std::span<Length<FromUnit, std::type_identity_t<Rep>>> data)
+    {
+        return {convert_in_place<FromUnit, ToUnit>(data.data(), data.size()), data.size()};
+    }
+#endif
+}
@@ -0,0 +1,407 @@
+/*********************************************************************************
+ *
+ *  MIT License
+ *
+ *  Copyright (c) 2017 Nenad Zikic
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ *********************************************************************************/
+
+
+#pragma once
+
+#include <cstddef>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#include <immintrin.h>
+#define LENGTH_SIMD_X86 1
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define LENGTH_SIMD_NEON 1
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define LENGTH_SIMD_TARGET(isa) __attribute__((target(isa)))
+#else
+#define LENGTH_SIMD_TARGET(isa)
+#endif
+
+// With `LENGTH_SIMD_LIBRARY` defined, vectorised kernels are only declared here and
+// linked from `length_simd` library instead of being compiled in every translation
+// unit. The library builds each ISA in its own object file, which defines
+// `LENGTH_SIMD_BUILD_<ISA>` before including this header.
+#if defined(LENGTH_SIMD_LIBRARY)
+#define LENGTH_SIMD_LINKAGE
+#else
+#define LENGTH_SIMD_LINKAGE inline
+#endif
+
+
+// Per instruction set primitives the kernels in `simd_kernels.inl` are built from.
+// Every ISA gets its own namespace with `batch<T>` for `double` and `float`,
+// functions carry target attribute so all of them can live in the same
+// translation unit and be selected at runtime.
+//
+// Kernels must round like the scalar operators on every ISA: GCC contracts
+// `add(a, mul(b, k))` into a fused multiply-add wherever the target has FMA
+// (`-ffp-contract=fast` is its default), so contraction is off for everything
+// defined here. Clang only contracts within a single expression by default.
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC push_options
+#pragma GCC optimize("fp-contract=off")
+#endif
+
+namespace length::simd::detail
+{
+
+    /** Values starting reductions, `+-inf` for floating point types **/
+    template <typename T>
+    constexpr T highest() { return std::numeric_limits<T>::has_infinity ? std::numeric_limits<T>::infinity() : std::numeric_limits<T>::max(); }
+
+    template <typename T>
+    constexpr T lowest() { return std::numeric_limits<T>::has_infinity ? -std::numeric_limits<T>::infinity() : std::numeric_limits<T>::lowest(); }
+
+    /** Number of values counted in narrow lane counters before they are reduced **/
+    inline constexpr std::size_t count_block = std::size_t{1} << 24;
+
+    namespace scalar
+    {
+        template <typename T>
+        struct batch
+        {
+                using reg        = T;
+                using count_reg  = std::size_t;
+                using count_type = std::size_t;
+                static constexpr std::size_t width       = 1;
+                static constexpr std::size_t count_width = 1;
+
+                static reg  load (const T* p)          { return *p; }
+                static void store(T* p, reg v)         { *p = v; }
+                static reg  broadcast(T v)             { return v; }
+                static reg  zero()                     { return T{}; }
+                static reg  add(reg a, reg b)          { return a + b; }
+                static reg  mul(reg a, reg b)          { return a * b; }
+                static reg  sub(reg a, reg b)          { return a - b; }
+                static reg  div(reg a, reg b)          { return a / b; }
+                static reg  sqrt(reg a)                { return std::sqrt(a); }
+                static reg  min(reg a, reg b)          { return b < a ? b : a; }
+                static reg  max(reg a, reg b)          { return b > a ? b : a; }
+
+                static count_reg count_zero()                             { return 0; }
+                static count_reg count_greater(count_reg acc, reg v, reg t) { return acc + (v > t ? 1 : 0); }
+                static void      store_counts(count_type* p, count_reg acc) { *p = acc; }
+        };
+
+#define LENGTH_SIMD_KERNEL inline
+#include "simd_kernels.inl"
+#undef LENGTH_SIMD_KERNEL
+    }
+
+#if defined(LENGTH_SIMD_X86)
+
+#define LENGTH_SIMD_SSE2 LENGTH_SIMD_TARGET("sse2")
+
+    namespace sse2
+    {
+        template <typename T>
+        struct batch;
+
+        template <>
+        struct batch<double>
+        {
+                using reg        = __m128d;
+                using count_reg  = __m128i;
+                using count_type = std::uint64_t;
+                static constexpr std::size_t width       = 2;
+                static constexpr std::size_t count_width = 2;
+
+                LENGTH_SIMD_SSE2 static reg  load(const double* p)    { return _mm_loadu_pd(p); }
+                LENGTH_SIMD_SSE2 static void store(double* p, reg v)  { _mm_storeu_pd(p, v); }
+                LENGTH_SIMD_SSE2 static reg  broadcast(double v)      { return _mm_set1_pd(v); }
+                LENGTH_SIMD_SSE2 static reg  zero()                   { return _mm_setzero_pd(); }
+                LENGTH_SIMD_SSE2 static reg  add(reg a, reg b)        { return _mm_add_pd(a, b); }
+                LENGTH_SIMD_SSE2 static reg  mul(reg a, reg b)        { return _mm_mul_pd(a, b); }
+                LENGTH_SIMD_SSE2 static reg  sub(reg a, reg b)        { return _mm_sub_pd(a, b); }
+                LENGTH_SIMD_SSE2 static reg  div(reg a, reg b)        { return _mm_div_pd(a, b); }
+                LENGTH_SIMD_SSE2 static reg  sqrt(reg a)              { return _mm_sqrt_pd(a); }
+                LENGTH_SIMD_SSE2 static reg  min(reg a, reg b)        { return _mm_min_pd(a, b); }
+                LENGTH_SIMD_SSE2 static reg  max(reg a, reg b)        { return _mm_max_pd(a, b); }
+
+                // comparison yields all ones (-1) in matching lanes, subtracting it counts them
+                LENGTH_SIMD_SSE2 static count_reg count_zero() { return _mm_setzero_si128(); }
+                LENGTH_SIMD_SSE2 static count_reg count_greater(count_reg acc, reg v, reg t) { return _mm_sub_epi64(acc, _mm_castpd_si128(_mm_cmpgt_pd(v, t))); }
+                LENGTH_SIMD_SSE2 static void      store_counts(count_type* p, count_reg acc) { _mm_storeu_si128(reinterpret_cast<__m128i*>(p), acc); }
+        };
+
+        template <>
+        struct batch<float>
+        {
+                using reg        = __m128;
+                using count_reg  = __m128i;
+                using count_type = std::uint32_t;
+                static constexpr std::size_t width       = 4;
+                static constexpr std::size_t count_width = 4;
+
+                LENGTH_SIMD_SSE2 static reg  load(const float* p)     { return _mm_loadu_ps(p); }
+                LENGTH_SIMD_SSE2 static void store(float* p, reg v)   { _mm_storeu_ps(p, v); }
+                LENGTH_SIMD_SSE2 static reg  broadcast(float v)       { return _mm_set1_ps(v); }
+                LENGTH_SIMD_SSE2 static reg  zero()                   { return _mm_setzero_ps(); }
+                LENGTH_SIMD_SSE2 static reg  add(reg a, reg b)        { return _mm_add_ps(a, b); }
+                LENGTH_SIMD_SSE2 static reg  mul(reg a, reg b)        { return _mm_mul_ps(a, b); }
+                LENGTH_SIMD_SSE2 static reg  sub(reg a, reg b)        { return _mm_sub_ps(a, b); }
+                LENGTH_SIMD_SSE2 static reg  div(reg a, reg b)        { return _mm_div_ps(a, b); }
+                LENGTH_SIMD_SSE2 static reg  sqrt(reg a)              { return _mm_sqrt_ps(a); }
+                LENGTH_SIMD_SSE2 static reg  min(reg a, reg b)        { return _mm_min_ps(a, b); }
+                LENGTH_SIMD_SSE2 static reg  max(reg a, reg b)        { return _mm_max_ps(a, b); }
+
+                LENGTH_SIMD_SSE2 static count_reg count_zero() { return _mm_setzero_si128(); }
+                LENGTH_SIMD_SSE2 static count_reg count_greater(count_reg acc, reg v, reg t) { return _mm_sub_epi32(acc, _mm_castps_si128(_mm_cmpgt_ps(v, t))); }
+                LENGTH_SIMD_SSE2 static void      store_counts(count_type* p, count_reg acc) { _mm_storeu_si128(reinterpret_cast<__m128i*>(p), acc); }
+        };
+
+#if defined(LENGTH_SIMD_LIBRARY) && !defined(LENGTH_SIMD_BUILD_SSE2)
+#define LENGTH_SIMD_KERNEL_DECLARATIONS_ONLY
+#endif
+#define LENGTH_SIMD_KERNEL LENGTH_SIMD_SSE2 LENGTH_SIMD_LINKAGE
+#include "simd_kernels.inl"
+#undef LENGTH_SIMD_KERNEL
+#undef LENGTH_SIMD_KERNEL_DECLARATIONS_ONLY
+    }
+
+#define LENGTH_SIMD_AVX2 LENGTH_SIMD_TARGET("avx2")
+
+    namespace avx2
+    {
+        template <typename T>
+        struct batch;
+
+        template <>
+        struct batch<double>
+        {
+                using reg        = __m256d;
+                using count_reg  = __m256i;
+                using count_type = std::uint64_t;
+                static constexpr std::size_t width       = 4;
+                static constexpr std::size_t count_width = 4;
+
+                LENGTH_SIMD_AVX2 static reg  load(const double* p)    { return _mm256_loadu_pd(p); }
+                LENGTH_SIMD_AVX2 static void store(double* p, reg v)  { _mm256_storeu_pd(p, v); }
+                LENGTH_SIMD_AVX2 static reg  broadcast(double v)      { return _mm256_set1_pd(v); }
+                LENGTH_SIMD_AVX2 static reg  zero()                   { return _mm256_setzero_pd(); }
+                LENGTH_SIMD_AVX2 static reg  add(reg a, reg b)        { return _mm256_add_pd(a, b); }
+                LENGTH_SIMD_AVX2 static reg  mul(reg a, reg b)        { return _mm256_mul_pd(a, b); }
+                LENGTH_SIMD_AVX2 static reg  sub(reg a, reg b)        { return _mm256_sub_pd(a, b); }
+                LENGTH_SIMD_AVX2 static reg  div(reg a, reg b)        { return _mm256_div_pd(a, b); }
+                LENGTH_SIMD_AVX2 static reg  sqrt(reg a)              { return _mm256_sqrt_pd(a); }
+                LENGTH_SIMD_AVX2 static reg  min(reg a, reg b)        { return _mm256_min_pd(a, b); }
+                LENGTH_SIMD_AVX2 static reg  max(reg a, reg b)        { return _mm256_max_pd(a, b); }
+
+                LENGTH_SIMD_AVX2 static count_reg count_zero() { return _mm256_setzero_si256(); }
+                LENGTH_SIMD_AVX2 static count_reg count_greater(count_reg acc, reg v, reg t) { return _mm256_sub_epi64(acc, _mm256_castpd_si256(_mm256_cmp_pd(v, t, _CMP_GT_OQ))); }
+                LENGTH_SIMD_AVX2 static void      store_counts(count_type* p, count_reg acc) { _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), acc); }
+        };
+
+        template <>
+        struct batch<float>
+        {
+                using reg        = __m256;
+                using count_reg  = __m256i;
+                using count_type = std::uint32_t;
+                static constexpr std::size_t width       = 8;
+                static constexpr std::size_t count_width = 8;
+
+                LENGTH_SIMD_AVX2 static reg  load(const float* p)     { return _mm256_loadu_ps(p); }
+                LENGTH_SIMD_AVX2 static void store(float* p, reg v)   { _mm256_storeu_ps(p, v); }
+                LENGTH_SIMD_AVX2 static reg  broadcast(float v)       { return _mm256_set1_ps(v); }
+                LENGTH_SIMD_AVX2 static reg  zero()                   { return _mm256_setzero_ps(); }
+                LENGTH_SIMD_AVX2 static reg  add(reg a, reg b)        { return _mm256_add_ps(a, b); }
+                LENGTH_SIMD_AVX2 static reg  mul(reg a, reg b)        { return _mm256_mul_ps(a, b); }
+                LENGTH_SIMD_AVX2 static reg  sub(reg a, reg b)        { return _mm256_sub_ps(a, b); }
+                LENGTH_SIMD_AVX2 static reg  div(reg a, reg b)        { return _mm256_div_ps(a, b); }
+                LENGTH_SIMD_AVX2 static reg  sqrt(reg a)              { return _mm256_sqrt_ps(a); }
+                LENGTH_SIMD_AVX2 static reg  min(reg a, reg b)        { return _mm256_min_ps(a, b); }
+                LENGTH_SIMD_AVX2 static reg  max(reg a, reg b)        { return _mm256_max_ps(a, b); }
+
+                LENGTH_SIMD_AVX2 static count_reg count_zero() { return _mm256_setzero_si256(); }
+                LENGTH_SIMD_AVX2 static count_reg count_greater(count_reg acc, reg v, reg t) { return _mm256_sub_epi32(acc, _mm256_castps_si256(_mm256_cmp_ps(v, t, _CMP_GT_OQ))); }
+                LENGTH_SIMD_AVX2 static void      store_counts(count_type* p, count_reg acc) { _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), acc); }
+        };
+
+#if defined(LENGTH_SIMD_LIBRARY) && !defined(LENGTH_SIMD_BUILD_AVX2)
+#define LENGTH_SIMD_KERNEL_DECLARATIONS_ONLY
+#endif
+#define LENGTH_SIMD_KERNEL LENGTH_SIMD_AVX2 LENGTH_SIMD_LINKAGE
+#include "simd_kernels.inl"
+#undef LENGTH_SIMD_KERNEL
+#undef LENGTH_SIMD_KERNEL_DECLARATIONS_ONLY
+    }
+
+#define LENGTH_SIMD_AVX512 LENGTH_SIMD_TARGET("avx512f")
+
+    namespace avx512
+    {
+        template <typename T>
+        struct batch;
+
+        template <>
+        struct batch<double>
+        {
+                using reg        = __m512d;
+                using count_reg  = __m512i;
+                using count_type = std::uint64_t;
+                static constexpr std::size_t width       = 8;
+                static constexpr std::size_t count_width = 8;
+
+                // full zero-mask min/max avoid `_mm512_undefined_*` operand and its spurious warnings
+                LENGTH_SIMD_AVX512 static reg  load(const double* p)    { return _mm512_loadu_pd(p); }
+                LENGTH_SIMD_AVX512 static void store(double* p, reg v)  { _mm512_storeu_pd(p, v); }
+                LENGTH_SIMD_AVX512 static reg  broadcast(double v)      { return _mm512_set1_pd(v); }
+                LENGTH_SIMD_AVX512 static reg  zero()                   { return _mm512_setzero_pd(); }
+                LENGTH_SIMD_AVX512 static reg  add(reg a, reg b)        { return _mm512_add_pd(a, b); }
+                LENGTH_SIMD_AVX512 static reg  mul(reg a, reg b)        { return _mm512_mul_pd(a, b); }
+                LENGTH_SIMD_AVX512 static reg  sub(reg a, reg b)        { return _mm512_sub_pd(a, b); }
+                LENGTH_SIMD_AVX512 static reg  div(reg a, reg b)        { return _mm512_div_pd(a, b); }
+                LENGTH_SIMD_AVX512 static reg  sqrt(reg a)              { return _mm512_maskz_sqrt_pd(0xFF, a); }
+                LENGTH_SIMD_AVX512 static reg  min(reg a, reg b)        { return _mm512_maskz_min_pd(0xFF, a, b); }
+                LENGTH_SIMD_AVX512 static reg  max(reg a, reg b)        { return _mm512_maskz_max_pd(0xFF, a, b); }
+
+                LENGTH_SIMD_AVX512 static count_reg count_zero() { return _mm512_setzero_si512(); }
+                LENGTH_SIMD_AVX512 static count_reg count_greater(count_reg acc, reg v, reg t) { return _mm512_mask_add_epi64(acc, _mm512_cmp_pd_mask(v, t, _CMP_GT_OQ), acc, _mm512_set1_epi64(1)); }
+                LENGTH_SIMD_AVX512 static void      store_counts(count_type* p, count_reg acc) { _mm512_storeu_si512(p, acc); }
+        };
+
+        template <>
+        struct batch<float>
+        {
+                using reg        = __m512;
+                using count_reg  = __m512i;
+                using count_type = std::uint32_t;
+                static constexpr std::size_t width       = 16;
+                static constexpr std::size_t count_width = 16;
+
+                LENGTH_SIMD_AVX512 static reg  load(const float* p)     { return _mm512_loadu_ps(p); }
+                LENGTH_SIMD_AVX512 static void store(float* p, reg v)   { _mm512_storeu_ps(p, v); }
+                LENGTH_SIMD_AVX512 static reg  broadcast(float v)       { return _mm512_set1_ps(v); }
+                LENGTH_SIMD_AVX512 static reg  zero()                   { return _mm512_setzero_ps(); }
+                LENGTH_SIMD_AVX512 static reg  add(reg a, reg b)        { return _mm512_add_ps(a, b); }
+                LENGTH_SIMD_AVX512 static reg  mul(reg a, reg b)        { return _mm512_mul_ps(a, b); }
+                LENGTH_SIMD_AVX512 static reg  sub(reg a, reg b)        { return _mm512_sub_ps(a, b); }
+                LENGTH_SIMD_AVX512 static reg  div(reg a, reg b)        { return _mm512_div_ps(a, b); }
+                LENGTH_SIMD_AVX512 static reg  sqrt(reg a)              { return _mm512_maskz_sqrt_ps(0xFFFF, a); }
+                LENGTH_SIMD_AVX512 static reg  min(reg a, reg b)        { return _mm512_maskz_min_ps(0xFFFF, a, b); }
+                LENGTH_SIMD_AVX512 static reg  max(reg a, reg b)        { return _mm512_maskz_max_ps(0xFFFF, a, b); }
+
+                LENGTH_SIMD_AVX512 static count_reg count_zero() { return _mm512_setzero_si512(); }
+                LENGTH_SIMD_AVX512 static count_reg count_greater(count_reg acc, reg v, reg t) { return _mm512_mask_add_epi32(acc, _mm512_cmp_ps_mask(v, t, _CMP_GT_OQ), acc, _mm512_set1_epi32(1)); }
+                LENGTH_SIMD_AVX512 static void      store_counts(count_type* p, count_reg acc) { _mm512_storeu_si512(p, acc); }
+        };
+
+#if defined(LENGTH_SIMD_LIBRARY) && !defined(LENGTH_SIMD_BUILD_AVX512)
+#define LENGTH_SIMD_KERNEL_DECLARATIONS_ONLY
+#endif
+#define LENGTH_SIMD_KERNEL LENGTH_SIMD_AVX512 LENGTH_SIMD_LINKAGE
+#include "simd_kernels.inl"
+#undef LENGTH_SIMD_KERNEL
+#undef LENGTH_SIMD_KERNEL_DECLARATIONS_ONLY
+    }
+
+#endif // LENGTH_SIMD_X86
+
+#if defined(LENGTH_SIMD_NEON)
+
+    // NEON is part of the AArch64 baseline, no target attribute is needed
+
+    namespace neon
+    {
+        template <typename T>
+        struct batch;
+
+        template <>
+        struct batch<double>
+        {
+                using reg        = float64x2_t;
+                using count_reg  = uint64x2_t;
+                using count_type = std::uint64_t;
+                static constexpr std::size_t width       = 2;
+                static constexpr std::size_t count_width = 2;
+
+                static reg  load(const double* p)    { return vld1q_f64(p); }
+                static void store(double* p, reg v)  { vst1q_f64(p, v); }
+                static reg  broadcast(double v)      { return vdupq_n_f64(v); }
+                static reg  zero()                   { return vdupq_n_f64(0.0); }
+                static reg  add(reg a, reg b)        { return vaddq_f64(a, b); }
+                static reg  mul(reg a, reg b)        { return vmulq_f64(a, b); }
+                static reg  sub(reg a, reg b)        { return vsubq_f64(a, b); }
+                static reg  div(reg a, reg b)        { return vdivq_f64(a, b); }
+                static reg  sqrt(reg a)              { return vsqrtq_f64(a); }
+                static reg  min(reg a, reg b)        { return vminq_f64(a, b); }
+                static reg  max(reg a, reg b)        { return vmaxq_f64(a, b); }
+
+                static count_reg count_zero() { return vdupq_n_u64(0); }
+                static count_reg count_greater(count_reg acc, reg v, reg t) { return vsubq_u64(acc, vcgtq_f64(v, t)); }
+                static void      store_counts(count_type* p, count_reg acc) { vst1q_u64(p, acc); }
+        };
+
+        template <>
+        struct batch<float>
+        {
+                using reg        = float32x4_t;
+                using count_reg  = uint32x4_t;
+                using count_type = std::uint32_t;
+                static constexpr std::size_t width       = 4;
+                static constexpr std::size_t count_width = 4;
+
+                static reg  load(const float* p)     { return vld1q_f32(p); }
+                static void store(float* p, reg v)   { vst1q_f32(p, v); }
+                static reg  broadcast(float v)       { return vdupq_n_f32(v); }
+                static reg  zero()                   { return vdupq_n_f32(0.0f); }
+                static reg  add(reg a, reg b)        { return vaddq_f32(a, b); }
+                static reg  mul(reg a, reg b)        { return vmulq_f32(a, b); }
+                static reg  sub(reg a, reg b)        { return vsubq_f32(a, b); }
+                static reg  div(reg a, reg b)        { return vdivq_f32(a, b); }
+                static reg  sqrt(reg a)              { return vsqrtq_f32(a); }
+                static reg  min(reg a, reg b)        { return vminq_f32(a, b); }
+                static reg  max(reg a, reg b)        { return vmaxq_f32(a, b); }
+
+                static count_reg count_zero() { return vdupq_n_u32(0); }
+                static count_reg count_greater(count_reg acc, reg v, reg t) { return vsubq_u32(acc, vcgtq_f32(v, t)); }
+                static void      store_counts(count_type* p, count_reg acc) { vst1q_u32(p, acc); }
+        };
+
+#if defined(LENGTH_SIMD_LIBRARY) && !defined(LENGTH_SIMD_BUILD_NEON)
+#define LENGTH_SIMD_KERNEL_DECLARATIONS_ONLY
+#endif
+#define LENGTH_SIMD_KERNEL LENGTH_SIMD_LINKAGE
+#include "simd_kernels.inl"
+#undef LENGTH_SIMD_KERNEL
+#undef LENGTH_SIMD_KERNEL_DECLARATIONS_ONLY
+    }
+
+#endif // LENGTH_SIMD_NEON
+
+}
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC pop_options
+#endif
@@ -0,0 +1,303 @@
+/*********************************************************************************
+ *
+ *  MIT License
+ *
+ *  Copyright (c) 2017 Nenad Zikic
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ *********************************************************************************/
+
+
+// Bulk kernels shared by every instruction set. This file is intentionally
+// included once per ISA namespace in `simd_isa.hpp`, after that namespace has
+// defined `batch<T>` primitives and `LENGTH_SIMD_KERNEL` target attribute and linkage.
+// With `LENGTH_SIMD_KERNEL_DECLARATIONS_ONLY` kernels are only declared, their
+// definitions are then compiled into `length_simd` library.
+
+#if defined(LENGTH_SIMD_KERNEL_DECLARATIONS_ONLY)
+
+template <typename T>
+void multiply(const T* in, T* out, std::size_t n, T k);
+
+template <typename T>
+void add_scaled(const T* a, const T* b, T k, T* out, std::size_t n);
+
+template <typename T>
+void divide(const T* in, T* out, std::size_t n, T k);
+
+template <typename T>
+T sum(const T* data, std::size_t n);
+
+template <typename T>
+void compensated_sum(const T* data, std::size_t n, T k, T& total, T& error);
+
+template <typename T>
+void minmax(const T* data, std::size_t n, T& lo, T& hi);
+
+template <typename T>
+std::size_t count_greater(const T* data, std::size_t n, T threshold);
+
+template <typename T>
+void distance(const T* ax, const T* ay, const T* az, const T* bx, const T* by, const T* bz, T k, T* out, std::size_t n);
+
+#else
+
+/** Multiplies `n` values of `in` by `k` into `out`; `in` and `out` may be the same buffer **/
+template <typename T>
+LENGTH_SIMD_KERNEL void multiply(const T* in, T* out, std::size_t n, T k)
+{
+    using B = batch<T>;
+    const typename B::reg vk = B::broadcast(k);
+    std::size_t i = 0;
+    for (; i + B::width <= n; i += B::width)
+    {
+        B::store(out + i, B::mul(B::load(in + i), vk));
+    }
+    for (; i < n; ++i)
+    {
+        out[i] = in[i] * k;
+    }
+}
+
+/** Computes `a[i] + b[i] * k` into `out`, i.e. adds `b` rescaled by `k`; `out` may alias `a` or `b` **/
+template <typename T>
+LENGTH_SIMD_KERNEL void add_scaled(const T* a, const T* b, T k, T* out, std::size_t n)
+{
+    using B = batch<T>;
+    const typename B::reg vk = B::broadcast(k);
+    std::size_t i = 0;
+    for (; i + B::width <= n; i += B::width)
+    {
+        B::store(out + i, B::add(B::load(a + i), B::mul(B::load(b + i), vk)));
+    }
+    for (; i < n; ++i)
+    {
+        out[i] = a[i] + b[i] * k;
+    }
+}
+
+/** Divides `n` values of `in` by `k` into `out`; `in` and `out` may be the same buffer **/
+template <typename T>
+LENGTH_SIMD_KERNEL void divide(const T* in, T* out, std::size_t n, T k)
+{
+    using B = batch<T>;
+    const typename B::reg vk = B::broadcast(k);
+    std::size_t i = 0;
+    for (; i + B::width <= n; i += B::width)
+    {
+        B::store(out + i, B::div(B::load(in + i), vk));
+    }
+    for (; i < n; ++i)
+    {
+        out[i] = in[i] / k;
+    }
+}
+
+/** Sum of `n` values of `data`, accumulated in `2 * batch<T>::width` independent lanes **/
+template <typename T>
+LENGTH_SIMD_KERNEL T sum(const T* data, std::size_t n)
+{
+    using B = batch<T>;
+    typename B::reg acc0 = B::zero();
+    typename B::reg acc1 = B::zero();
+    std::size_t i = 0;
+    for (; i + 2 * B::width <= n; i += 2 * B::width)
+    {
+        acc0 = B::add(acc0, B::load(data + i));
+        acc1 = B::add(acc1, B::load(data + i + B::width));
+    }
+    acc0 = B::add(acc0, acc1);
+    for (; i + B::width <= n; i += B::width)
+    {
+        acc0 = B::add(acc0, B::load(data + i));
+    }
+
+    T lanes[B::width];
+    B::store(lanes, acc0);
+    T total = T{};
+    for (std::size_t l = 0; l < B::width; ++l)
+    {
+        total += lanes[l];
+    }
+    for (; i < n; ++i)
+    {
+        total += data[i];
+    }
+    return total;
+}
+
+/** One vector step of TwoSum: `s += x`, rounding error of the addition added to `c` **/
+template <typename B>
+LENGTH_SIMD_KERNEL void two_sum_step(typename B::reg& s, typename B::reg& c, typename B::reg x)
+{
+    const typename B::reg t  = B::add(s, x);
+    const typename B::reg bp = B::sub(t, s);
+    c = B::add(c, B::add(B::sub(s, B::sub(t, bp)), B::sub(x, bp)));
+    s = t;
+}
+
+/** Adds `n` values of `data` scaled by `k` to `total`, collecting rounding error of every addition in `error`
+ *
+ *  Error free TwoSum in `2 * batch<T>::width` independent lanes, needs strict IEEE addition (no `-ffast-math`).
+ */
+template <typename T>
+LENGTH_SIMD_KERNEL void compensated_sum(const T* data, std::size_t n, T k, T& total, T& error)
+{
+    using B = batch<T>;
+    using R = typename B::reg;
+    const auto scalar_step = [](T& s, T& c, T x)
+    {
+        const T t  = s + x;
+        const T bp = t - s;
+        c += (s - (t - bp)) + (x - bp);
+        s = t;
+    };
+
+    // TwoSum is 6 operations per value, two lanes already keep the adders busy
+    constexpr std::size_t L = 2;
+    const R vk = B::broadcast(k);
+    R s[L];
+    R c[L];
+    for (std::size_t l = 0; l < L; ++l)
+    {
+        s[l] = B::zero();
+        c[l] = B::zero();
+    }
+    std::size_t i = 0;
+    for (; i + L * B::width <= n; i += L * B::width)
+    {
+        for (std::size_t l = 0; l < L; ++l)
+        {
+            two_sum_step<B>(s[l], c[l], B::mul(B::load(data + i + l * B::width), vk));
+        }
+    }
+    for (; i + B::width <= n; i += B::width)
+    {
+        two_sum_step<B>(s[0], c[0], B::mul(B::load(data + i), vk));
+    }
+
+    T sums[B::width];
+    T errors[B::width];
+    for (std::size_t l = 0; l < L; ++l)
+    {
+        B::store(sums, s[l]);
+        B::store(errors, c[l]);
+        for (std::size_t w = 0; w < B::width; ++w)
+        {
+            scalar_step(total, error, sums[w]);
+            error += errors[w];
+        }
+    }
+    for (; i < n; ++i)
+    {
+        scalar_step(total, error, data[i] * k);
+    }
+}
+
+/** Smallest and largest of `n` values of `data`; result for NaN values is unspecified **/
+template <typename T>
+LENGTH_SIMD_KERNEL void minmax(const T* data, std::size_t n, T& lo, T& hi)
+{
+    using B = batch<T>;
+    typename B::reg vlo = B::broadcast(highest<T>());
+    typename B::reg vhi = B::broadcast(lowest<T>());
+    std::size_t i = 0;
+    for (; i + B::width <= n; i += B::width)
+    {
+        const typename B::reg v = B::load(data + i);
+        vlo = B::min(vlo, v);
+        vhi = B::max(vhi, v);
+    }
+
+    T lanes_lo[B::width];
+    T lanes_hi[B::width];
+    B::store(lanes_lo, vlo);
+    B::store(lanes_hi, vhi);
+    lo = highest<T>();
+    hi = lowest<T>();
+    for (std::size_t l = 0; l < B::width; ++l)
+    {
+        lo = lanes_lo[l] < lo ? lanes_lo[l] : lo;
+        hi = lanes_hi[l] > hi ? lanes_hi[l] : hi;
+    }
+    for (; i < n; ++i)
+    {
+        lo = data[i] < lo ? data[i] : lo;
+        hi = data[i] > hi ? data[i] : hi;
+    }
+}
+
+/** Number of `n` values of `data` greater than `threshold` **/
+template <typename T>
+LENGTH_SIMD_KERNEL std::size_t count_greater(const T* data, std::size_t n, T threshold)
+{
+    using B = batch<T>;
+    const typename B::reg vt = B::broadcast(threshold);
+    std::size_t total = 0;
+    std::size_t i = 0;
+    while (i + B::width <= n)
+    {
+        // lane counters are reduced every `count_block` values so narrow counters never overflow
+        const std::size_t block_end = (n - i > count_block) ? i + count_block : n;
+        typename B::count_reg acc = B::count_zero();
+        for (; i + B::width <= block_end; i += B::width)
+        {
+            acc = B::count_greater(acc, B::load(data + i), vt);
+        }
+
+        typename B::count_type lanes[B::count_width];
+        B::store_counts(lanes, acc);
+        for (std::size_t l = 0; l < B::count_width; ++l)
+        {
+            total += static_cast<std::size_t>(lanes[l]);
+        }
+    }
+    for (; i < n; ++i)
+    {
+        total += (data[i] > threshold) ? 1 : 0;
+    }
+    return total;
+}
+
+/** Euclidean distances between points `a` and points `b` rescaled by `k`, coordinates given as separate x/y/z arrays **/
+template <typename T>
+LENGTH_SIMD_KERNEL void distance(const T* ax, const T* ay, const T* az,
+                                        const T* bx, const T* by, const T* bz, T k, T* out, std::size_t n)
+{
+    using B = batch<T>;
+    const typename B::reg vk = B::broadcast(k);
+    std::size_t i = 0;
+    for (; i + B::width <= n; i += B::width)
+    {
+        const typename B::reg dx = B::sub(B::load(ax + i), B::mul(B::load(bx + i), vk));
+        const typename B::reg dy = B::sub(B::load(ay + i), B::mul(B::load(by + i), vk));
+        const typename B::reg dz = B::sub(B::load(az + i), B::mul(B::load(bz + i), vk));
+        B::store(out + i, B::sqrt(B::add(B::add(B::mul(dx, dx), B::mul(dy, dy)), B::mul(dz, dz))));
+    }
+    for (; i < n; ++i)
+    {
+        const T dx = ax[i] - bx[i] * k;
+        const T dy = ay[i] - by[i] * k;
+        const T dz = az[i] - bz[i] * k;
+        out[i] = static_cast<T>(std::sqrt(dx * dx + dy * dy + dz * dz));
+    }
+}
+
+#endif // LENGTH_SIMD_KERNEL_DECLARATIONS_ONLY
@@ -0,0 +1,369 @@
+/*********************************************************************************
+ *
+ *  MIT License
+ *
+ *  Copyright (c) 2017 Nenad Zikic
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ *********************************************************************************/
+
+
+#pragma once
+
+#include "length.hpp"
+#include "simd.hpp"
+
+#include <algorithm>
+#include <cstddef>
+
+
+// Powers of length: `Area` and `Volume` produced by multiplying lengths.
+//
+// Like `Length`, a `LengthPower` is a plain `Rep` with the unit and dimension
+// in its type, so products cost exactly the multiplication of values and
+// conversions fold the squared/cubed ratio into a single compile time constant.
+
+namespace length
+{
+
+    /** `Unit` raised to power `Dim` (2 for area, 3 for volume), stored as a value of type `Rep` **/
+    template <typename Unit, int Dim, typename Rep = double>
+    class LengthPower
+    {
+            static_assert (is_length_unit_v<Unit>, "LengthPower `Unit` template parameter must be of type length_unit");
+            static_assert (Dim >= 2, "LengthPower of dimension 1 is `Length`");
+
+            Rep m_value;
+
+        public:
+            using unit = Unit;
+            using rep  = Rep;
+            static constexpr int dimension = Dim;
+
+            constexpr explicit LengthPower(Rep val = Rep{}) : m_value{val} {}
+
+            /** Value measured in units `Unit` to the power `Dim` **/
+            [[nodiscard]] constexpr Rep value() const { return m_value; }
+
+            // compound assignment, updating the value in place
+
+            template <typename Unit2, typename Rep2>
+            constexpr LengthPower& operator+= (const LengthPower<Unit2, Dim, Rep2>& rhs);
+
+            template <typename Unit2, typename Rep2>
+            constexpr LengthPower& operator-= (const LengthPower<Unit2, Dim, Rep2>& rhs);
+
+            constexpr LengthPower& operator*= (const Rep& k) { m_value *= k; return *this; }
+            constexpr LengthPower& operator/= (const Rep& k) { m_value /= k; return *this; }
+    };
+
+    template <typename Unit, typename Rep = double>
+    using Area = LengthPower<Unit, 2, Rep>;
+
+    template <typename Unit, typename Rep = double>
+    using Volume = LengthPower<Unit, 3, Rep>;
+
+    template <typename T>
+    struct is_length_power : std::false_type {};
+
+    template <typename Unit, int Dim, typename Rep>
+    struct is_length_power<LengthPower<Unit, Dim, Rep>> : std::true_type {};
+
+    template <typename T>
+    inline constexpr bool is_length_power_v = is_length_power<T>::value;
+
+    namespace detail
+    {
+        // unit, dimension and rep of `Length` (dimension 1) and `LengthPower`
+
+        template <typename T>
+        struct dimension_of;
+
+        template <typename Unit, typename Rep>
+        struct dimension_of<Length<Unit, Rep>>
+        {
+            using unit = Unit;
+            using rep  = Rep;
+            static constexpr int value = 1;
+        };
+
+        template <typename Unit, int Dim, typename Rep>
+        struct dimension_of<LengthPower<Unit, Dim, Rep>>
+        {
+            using unit = Unit;
+            using rep  = Rep;
+            static constexpr int value = Dim;
+        };
+
+        template <typename T>
+        inline constexpr bool is_dimensioned_v = is_length_v<T> || is_length_power_v<T>;
+
+        /** Type of `Unit` to power `Dim`: plain `Rep` for 0, `Length` for 1, `LengthPower` above **/
+        template <typename Unit, int Dim, typename Rep>
+        struct power_type { using type = LengthPower<Unit, Dim, Rep>; };
+
+        template <typename Unit, typename Rep>
+        struct power_type<Unit, 1, Rep> { using type = Length<Unit, Rep>; };
+
+        template <typename Unit, typename Rep>
+        struct power_type<Unit, 0, Rep> { using type = Rep; };
+
+        template <typename Unit, int Dim, typename Rep>
+        using power_t = typename power_type<Unit, Dim, Rep>::type;
+
+        template <typename Ratio, int Dim>
+        struct ratio_power { using type = std::ratio_multiply<Ratio, typename ratio_power<Ratio, Dim - 1>::type>; };
+
+        template <typename Ratio>
+        struct ratio_power<Ratio, 0> { using type = std::ratio<1>; };
+
+        /** Factor converting `Dim` powers of values by `Ratio`; raised in floating point so ratios can't overflow **/
+        template <typename Rep, typename Ratio, int Dim>
+        inline constexpr Rep power_factor = [] {
+            std::common_type_t<Rep, double> factor = 1;
+            for (int i = 0; i < Dim; ++i)
+            {
+                factor *= conversion_factor<std::common_type_t<Rep, double>, Ratio>;
+            }
+            return static_cast<Rep>(factor);
+        }();
+
+        /** Rescales value of `FromUnit` to power `Dim` into `ToUnit` to power `Dim` **/
+        template <typename FromUnit, typename ToUnit, int Dim, typename Rep>
+        [[nodiscard]] constexpr Rep rescale_power(Rep value)
+        {
+            using r = conversion_ratio<FromUnit, ToUnit>;
+            if constexpr (Dim == 0 || (r::num == 1 && r::den == 1))
+            {
+                return value;
+            }
+            else if constexpr (std::is_floating_point_v<Rep>)
+            {
+                return value * power_factor<Rep, r, Dim>;
+            }
+            else
+            {
+                return rescale<typename ratio_power<r, Dim>::type>(value);
+            }
+        }
+
+        /** Value of `Length` or `LengthPower` in units `ToUnit` (to the same power) as `ToRep` **/
+        template <typename ToUnit, typename ToRep, typename T>
+        [[nodiscard]] constexpr ToRep power_value_in(const T& x)
+        {
+            using d = dimension_of<T>;
+            return rescale_power<typename d::unit, ToUnit, d::value>(static_cast<ToRep>(x.value()));
+        }
+
+        template <typename A, typename B>
+        using common_dimension_rep_t = common_rep_t<typename dimension_of<A>::rep, typename dimension_of<B>::rep>;
+    }
+
+    /** Converts `LengthPower` of `FromUnit` to `ToUnit`, scaling by the conversion ratio to power `Dim`
+     *
+     * @example usage
+     *          1. Area<metre> aM = convert<centimetre, metre>(Area<centimetre>{2500}); // 0.25 m^2
+     */
+    template <typename FromUnit, typename ToUnit, int Dim, typename Rep>
+    [[nodiscard]] constexpr LengthPower<ToUnit, Dim, Rep> convert(const LengthPower<FromUnit, Dim, Rep>& from)
+    {
+        return LengthPower<ToUnit, Dim, Rep>{detail::rescale_power<FromUnit, ToUnit, Dim>(from.value())};
+    }
+
+    // comparison
+
+    template <typename Unit1, typename Rep1, typename Unit2, typename Rep2, int Dim>
+    [[nodiscard]] constexpr bool operator==(const LengthPower<Unit1, Dim, Rep1>& lhs, const LengthPower<Unit2, Dim, Rep2>& rhs)
+    {
+        using CR = detail::common_rep_t<Rep1, Rep2>;
+        if constexpr (std::is_integral_v<CR>)
+        {
+            using CU = detail::common_unit_t<Unit1, Unit2>;
+            return detail::power_value_in<CU, CR>(lhs) == detail::power_value_in<CU, CR>(rhs);
+        }
+        else
+        {
+            return static_cast<CR>(lhs.value()) == detail::power_value_in<Unit1, CR>(rhs);
+        }
+    }
+
+    template <typename Unit1, typename Rep1, typename Unit2, typename Rep2, int Dim>
+    [[nodiscard]] constexpr bool operator!=(const LengthPower<Unit1, Dim, Rep1>& lhs, const LengthPower<Unit2, Dim, Rep2>& rhs)
+    {
+        return !(lhs == rhs);
+    }
+
+    // addition and subtraction, result is in units of lhs
+
+    template <typename Unit1, typename Rep1, typename Unit2, typename Rep2, int Dim>
+    [[nodiscard]] constexpr LengthPower<Unit1, Dim, detail::common_rep_t<Rep1, Rep2>> operator+ (LengthPower<Unit1, Dim, Rep1> lhs, LengthPower<Unit2, Dim, Rep2> rhs)
+    {
+        using CR = detail::common_rep_t<Rep1, Rep2>;
+        return LengthPower<Unit1, Dim, CR>{static_cast<CR>(lhs.value()) + detail::power_value_in<Unit1, CR>(rhs)};
+    }
+
+    template <typename Unit1, typename Rep1, typename Unit2, typename Rep2, int Dim>
+    [[nodiscard]] constexpr LengthPower<Unit1, Dim, detail::common_rep_t<Rep1, Rep2>> operator- (LengthPower<Unit1, Dim, Rep1> lhs, LengthPower<Unit2, Dim, Rep2> rhs)
+    {
+        using CR = detail::common_rep_t<Rep1, Rep2>;
+        return LengthPower<Unit1, Dim, CR>{static_cast<CR>(lhs.value()) - detail::power_value_in<Unit1, CR>(rhs)};
+    }
+
+    // scaling
+
+    template <typename Unit, int Dim, typename Rep, LENGTH_SCALAR_PARAM(Rep, K)>
+    [[nodiscard]] constexpr LengthPower<Unit, Dim, detail::common_rep_t<Rep, K>> operator* (const K& k, LengthPower<Unit, Dim, Rep> x)
+    {
+        using CR = detail::common_rep_t<Rep, K>;
+        return LengthPower<Unit, Dim, CR>{static_cast<CR>(k) * static_cast<CR>(x.value())};
+    }
+
+    template <typename Unit, int Dim, typename Rep, LENGTH_SCALAR_PARAM(Rep, K)>
+    [[nodiscard]] constexpr LengthPower<Unit, Dim, detail::common_rep_t<Rep, K>> operator* (LengthPower<Unit, Dim, Rep> x, const K& k)
+    {
+        using CR = detail::common_rep_t<Rep, K>;
+        return LengthPower<Unit, Dim, CR>{static_cast<CR>(x.value()) * static_cast<CR>(k)};
+    }
+
+    template <typename Unit, int Dim, typename Rep, LENGTH_SCALAR_PARAM(Rep, K)>
+    [[nodiscard]] constexpr LengthPower<Unit, Dim, detail::common_rep_t<Rep, K>> operator/ (LengthPower<Unit, Dim, Rep> x, const K& k)
+    {
+        using CR = detail::common_rep_t<Rep, K>;
+        return LengthPower<Unit, Dim, CR>{static_cast<CR>(x.value()) / static_cast<CR>(k)};
+    }
+
+    /** Product of lengths and their powers, in units of lhs, e.g. `Length * Length` is `Area`
+     *  and `Area * Length` is `Volume`; rhs is converted into lhs units first
+     *
+     * @example usage
+     *          1. Area<metre> a = 2_m * 50_cm;              // 1 m^2
+     *          2. Volume<foot> v = Area<foot>{2} * 6_in;   // 1 ft^3
+     */
+    template <typename A, typename B, std::enable_if_t<detail::is_dimensioned_v<A> && detail::is_dimensioned_v<B>, int> = 0>
+    [[nodiscard]] constexpr auto operator* (const A& lhs, const B& rhs)
+    {
+        using CR   = detail::common_dimension_rep_t<A, B>;
+        using Unit = typename detail::dimension_of<A>::unit;
+        constexpr int dim = detail::dimension_of<A>::value + detail::dimension_of<B>::value;
+        return detail::power_t<Unit, dim, CR>{static_cast<CR>(lhs.value()) * detail::power_value_in<Unit, CR>(rhs)};
+    }
+
+    /** Quotient of lengths and their powers, in units of lhs, e.g. `Volume / Area` is `Length`
+     *  and `Area / Area` is plain ratio (`Length / Length` is in length.hpp)
+     */
+    template <typename A, typename B, std::enable_if_t<detail::is_dimensioned_v<A> && detail::is_dimensioned_v<B> &&
+                                                       !(is_length_v<A> && is_length_v<B>) &&
+                                                       (detail::dimension_of<A>::value >= detail::dimension_of<B>::value), int> = 0>
+    [[nodiscard]] constexpr auto operator/ (const A& lhs, const B& rhs)
+    {
+        using CR   = detail::common_dimension_rep_t<A, B>;
+        using Unit = typename detail::dimension_of<A>::unit;
+        constexpr int dim = detail::dimension_of<A>::value - detail::dimension_of<B>::value;
+        return detail::power_t<Unit, dim, CR>{static_cast<CR>(lhs.value()) / detail::power_value_in<Unit, CR>(rhs)};
+    }
+
+    // compound assignment
+
+    template <typename Unit, int Dim, typename Rep>
+    template <typename Unit2, typename Rep2>
+    constexpr LengthPower<Unit, Dim, Rep>& LengthPower<Unit, Dim, Rep>::operator+= (const LengthPower<Unit2, Dim, Rep2>& rhs)
+    {
+        m_value = static_cast<Rep>((*this + rhs).value());
+        return *this;
+    }
+
+    template <typename Unit, int Dim, typename Rep>
+    template <typename Unit2, typename Rep2>
+    constexpr LengthPower<Unit, Dim, Rep>& LengthPower<Unit, Dim, Rep>::operator-= (const LengthPower<Unit2, Dim, Rep2>& rhs)
+    {
+        m_value = static_cast<Rep>((*this - rhs).value());
+        return *this;
+    }
+
+    // bulk operations, `LengthPower` has the same layout as its `Rep` value just like `Length`
+
+    template <typename Unit, int Dim, typename Rep>
+    [[nodiscard]] inline Rep* as_values(LengthPower<Unit, Dim, Rep>* powers) noexcept
+    {
+        return reinterpret_cast<Rep*>(powers);
+    }
+
+    template <typename Unit, int Dim, typename Rep>
+    [[nodiscard]] inline const Rep* as_values(const LengthPower<Unit, Dim, Rep>* powers) noexcept
+    {
+        return reinterpret_cast<const Rep*>(powers);
+    }
+
+    /** Converts `n` areas/volumes of `FromUnit` starting at `in` to `ToUnit` written to `out`,
+     *  floating point values go through the same vectorised kernel as `Length` conversions
+     *
+     * @return - pointer one past the last written value
+     *
+     * @example usage
+     *          1. convert_n<inch, metre>(areas_in.data(), areas_in.size(), areas_m.data());
+     */
+    template <typename FromUnit, typename ToUnit, int Dim, typename Rep>
+    LengthPower<ToUnit, Dim, Rep>* convert_n(const LengthPower<FromUnit, Dim, Rep>* in, std::size_t n, LengthPower<ToUnit, Dim, Rep>* out)
+    {
+        using r = detail::conversion_ratio<FromUnit, ToUnit>;
+
+        const Rep* src = as_values(in);
+        Rep*       dst = as_values(out);
+
+        if constexpr (r::num == 1 && r::den == 1)
+        {
+            if (static_cast<const void*>(src) != static_cast<const void*>(dst))
+            {
+                std::copy_n(src, n, dst);
+            }
+        }
+        else if constexpr (std::is_floating_point_v<Rep>)
+        {
+            simd::detail::multiply(src, dst, n, detail::power_factor<Rep, r, Dim>);
+        }
+        else
+        {
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                dst[i] = detail::rescale_power<FromUnit, ToUnit, Dim>(src[i]);
+            }
+        }
+        return out + n;
+    }
+
+    namespace simd
+    {
+        /** Sum of `n` areas/volumes starting at `data` **/
+        template <typename Unit, int Dim, typename Rep>
+        [[nodiscard]] inline LengthPower<Unit, Dim, Rep> sum(const LengthPower<Unit, Dim, Rep>* data, std::size_t n)
+        {
+            return LengthPower<Unit, Dim, Rep>{detail::sum(as_values(data), n)};
+        }
+    }
+
+    //////////////////
+    // layout
+    //////////////////
+
+    static_assert (std::is_standard_layout_v<Area<metre>> && std::is_trivially_copyable_v<Area<metre>> && sizeof(Area<metre>) == sizeof(double));
+    static_assert (sizeof(Volume<millimetre, float>) == sizeof(float));
+    static_assert (std::is_trivially_copy_constructible_v<Volume<metre>> && std::is_trivially_destructible_v<Volume<metre>>);
+
+}
@@ -0,0 +1,211 @@
+/*********************************************************************************
+ *
+ *  MIT License
+ *
+ *  Copyright (c) 2017 Nenad Zikic
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ *********************************************************************************/
+
+
+#pragma once
+
+#include "length.hpp"
+#include "simd.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <tuple>
+#include <utility>
+
+
+namespace length
+{
+
+    /** Units `DynamicLength` can hold, in order of their `unit_id` **/
+    using dynamic_units = std::tuple<metre, centimetre, millimetre, inch, foot, micrometre, nanometre, yard, mile, nautical_mile>;
+
+    /** Identifier of a built-in unit known only at runtime **/
+    enum class unit_id : std::uint8_t
+    {
+        metre,
+        centimetre,
+        millimetre,
+        inch,
+        foot,
+        micrometre,
+        nanometre,
+        yard,
+        mile,
+        nautical_mile
+    };
+
+    inline constexpr std::size_t unit_count = std::tuple_size_v<dynamic_units>;
+
+    namespace detail
+    {
+        template <typename Unit, std::size_t I = 0>
+        [[nodiscard]] constexpr std::size_t unit_index()
+        {
+            static_assert (I < unit_count, "`Unit` has no `unit_id`");
+            if constexpr (std::is_same_v<Unit, std::tuple_element_t<I, dynamic_units>>) return I;
+            else                                                                         return unit_index<Unit, I + 1>();
+        }
+
+        template <std::size_t From, std::size_t... To>
+        [[nodiscard]] constexpr std::array<double, unit_count> factor_row(std::index_sequence<To...>)
+        {
+            return {conversion_factor<double, conversion_ratio<std::tuple_element_t<From, dynamic_units>,
+                                                               std::tuple_element_t<To, dynamic_units>>>...};
+        }
+
+        template <std::size_t... From>
+        [[nodiscard]] constexpr std::array<std::array<double, unit_count>, unit_count> factor_table(std::index_sequence<From...>)
+        {
+            return {factor_row<From>(std::make_index_sequence<unit_count>{})...};
+        }
+
+        template <std::size_t... I>
+        [[nodiscard]] constexpr std::array<std::string_view, unit_count> symbol_table(std::index_sequence<I...>)
+        {
+            return {std::tuple_element_t<I, dynamic_units>::symbol...};
+        }
+    }
+
+    /** `unit_id` of `Unit` **/
+    template <typename Unit>
+    inline constexpr unit_id unit_id_of = static_cast<unit_id>(detail::unit_index<Unit>());
+
+    /** `conversion_factors[from][to]` multiplies value in unit `from` into unit `to`,
+     *  derived at compile time from the ratios of the built-in units
+     */
+    inline constexpr std::array<std::array<double, unit_count>, unit_count> conversion_factors =
+        detail::factor_table(std::make_index_sequence<unit_count>{});
+
+    inline constexpr std::array<std::string_view, unit_count> unit_symbols =
+        detail::symbol_table(std::make_index_sequence<unit_count>{});
+
+    /** `unit_id` of a raw tag, e.g. a byte read from file or stream header; empty if it names no unit
+     *
+     * @example usage
+     *          1. const std::optional<unit_id> unit = to_unit_id(header[5]);
+     *             if (!unit) return std::errc::invalid_argument;
+     */
+    [[nodiscard]] constexpr std::optional<unit_id> to_unit_id(std::uint8_t tag)
+    {
+        return tag < unit_count ? std::optional<unit_id>{static_cast<unit_id>(tag)} : std::nullopt;
+    }
+
+    // functions taking `unit_id` index tables with it unchecked, ids made from untrusted
+    // bytes have to be validated with `to_unit_id` first
+
+    [[nodiscard]] constexpr double conversion_factor(unit_id from, unit_id to)
+    {
+        return conversion_factors[static_cast<std::size_t>(from)][static_cast<std::size_t>(to)];
+    }
+
+    [[nodiscard]] constexpr std::string_view symbol(unit_id unit)
+    {
+        return unit_symbols[static_cast<std::size_t>(unit)];
+    }
+
+    /** Length in unit chosen at runtime; value and small unit id
+     *
+     * Conversions index constant table of factors instead of branching on units,
+     * and `Length<Unit>` converts to and from it implicitly.
+     *
+     * @example usage
+     *          1. DynamicLength len{12.0, unit}; // unit = to_unit_id(header.unit), checked
+     *             Length<metre> m = len.as<metre>();
+     *          2. DynamicLength d = 3_ft; // unit_id::foot
+     */
+    class DynamicLength
+    {
+            double  m_value = 0.0;
+            unit_id m_unit  = unit_id::metre;
+
+        public:
+            constexpr DynamicLength() = default;
+
+            /** Requires valid `unit`, see `to_unit_id` **/
+            constexpr DynamicLength(double value, unit_id unit) : m_value{value}, m_unit{unit} {}
+
+            template <typename Unit>
+            constexpr DynamicLength(Length<Unit> length) : m_value{length.value()}, m_unit{unit_id_of<Unit>} {}
+
+            /** Value of length measured in current units **/
+            [[nodiscard]] constexpr double  value() const { return m_value; }
+            [[nodiscard]] constexpr unit_id unit()  const { return m_unit; }
+
+            /** Same length expressed in `target` units **/
+            [[nodiscard]] constexpr DynamicLength to(unit_id target) const
+            {
+                return DynamicLength{m_value * conversion_factor(m_unit, target), target};
+            }
+
+            /** Same length as `Length<Unit>` **/
+            template <typename Unit>
+            [[nodiscard]] constexpr Length<Unit> as() const
+            {
+                return Length<Unit>{m_value * conversion_factor(m_unit, unit_id_of<Unit>)};
+            }
+
+            template <typename Unit>
+            [[nodiscard]] constexpr explicit operator Length<Unit>() const { return as<Unit>(); }
+
+            // operations, like `Length` mixed unit operators, are done in units of lhs
+
+            [[nodiscard]] friend constexpr bool operator== (const DynamicLength& lhs, const DynamicLength& rhs)
+            {
+                return lhs.m_value == rhs.to(lhs.m_unit).m_value;
+            }
+
+            [[nodiscard]] friend constexpr bool operator!= (const DynamicLength& lhs, const DynamicLength& rhs) { return !(lhs == rhs); }
+
+            [[nodiscard]] friend constexpr DynamicLength operator+ (const DynamicLength& lhs, const DynamicLength& rhs)
+            {
+                return DynamicLength{lhs.m_value + rhs.to(lhs.m_unit).m_value, lhs.m_unit};
+            }
+
+            [[nodiscard]] friend constexpr DynamicLength operator- (const DynamicLength& lhs, const DynamicLength& rhs)
+            {
+                return DynamicLength{lhs.m_value - rhs.to(lhs.m_unit).m_value, lhs.m_unit};
+            }
+
+            [[nodiscard]] friend constexpr DynamicLength operator* (const DynamicLength& length, double k) { return DynamicLength{length.m_value * k, length.m_unit}; }
+            [[nodiscard]] friend constexpr DynamicLength operator* (double k, const DynamicLength& length) { return DynamicLength{length.m_value * k, length.m_unit}; }
+            [[nodiscard]] friend constexpr DynamicLength operator/ (const DynamicLength& length, double k) { return DynamicLength{length.m_value / k, length.m_unit}; }
+    };
+
+    /** Converts `n` values measured in `from` units into `to` units, e.g. with units read from file header
+     *  and validated with `to_unit_id`
+     *
+     * @example usage
+     *          1. convert_n(samples.data(), samples.size(), header.unit, unit_id::metre, metres.data());
+     */
+    inline double* convert_n(const double* in, std::size_t n, unit_id from, unit_id to, double* out)
+    {
+        simd::detail::multiply(in, out, n, conversion_factor(from, to));
+        return out + n;
+    }
+}
@@ -0,0 +1,167 @@
+/*********************************************************************************
+ *
+ *  MIT License
+ *
+ *  Copyright (c) 2017 Nenad Zikic
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ *********************************************************************************/
+
+
+#pragma once
+
+#include "length.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+
+// Exact mode: lengths stored as `std::int64_t` count of ticks of 1/2540000 m.
+//
+// Every metric unit from millimetre up and every imperial unit is a whole number
+// of ticks, so conversions, sums and comparisons of exact lengths are plain
+// integer operations free of floating point drift. `int64_t` ticks cover about
+// +-3.6e12 m, far more than any realistic measurement needs.
+
+namespace length
+{
+
+    /** 1/2540000 m, i.e. 1/64516 in or 1/2540 mm, so built-in units from millimetre up are whole tick counts **/
+    struct tick : length_unit<std::ratio<1, 2540000>> { static constexpr std::string_view symbol = "tick"; };
+
+    using ExactLength = Length<tick, std::int64_t>;
+
+    /** Whether lengths of `Unit` are a whole number of ticks, i.e. convert to ticks exactly **/
+    template <typename Unit>
+    inline constexpr bool is_exact_unit_v = detail::conversion_ratio<Unit, tick>::den == 1;
+
+    namespace detail
+    {
+        /** Rounds to nearest integer, halves away from zero, usable in constant expressions **/
+        template <typename Rep>
+        [[nodiscard]] constexpr std::int64_t round_ticks(Rep ticks)
+        {
+            return static_cast<std::int64_t>(ticks + (ticks < Rep{0} ? Rep{-0.5} : Rep{0.5}));
+        }
+
+        template <typename Unit, typename Rep>
+        [[nodiscard]] constexpr std::int64_t to_ticks(Rep value)
+        {
+            using r = conversion_ratio<Unit, tick>;
+            if constexpr (std::is_floating_point_v<Rep>)
+            {
+                return round_ticks(value * conversion_factor<Rep, r>);
+            }
+            else
+            {
+                static_assert (is_exact_unit_v<Unit>, "Integral length of `Unit` can not be converted to ticks exactly");
+                return rescale<r>(static_cast<std::int64_t>(value));
+            }
+        }
+
+        template <typename Unit, typename Rep>
+        [[nodiscard]] constexpr Rep from_ticks(std::int64_t ticks)
+        {
+            using r = conversion_ratio<tick, Unit>;
+            if constexpr (std::is_floating_point_v<Rep> && r::num == 1)
+            {
+                // dividing by whole tick count of `Unit` is correctly rounded, unlike multiplying by its inverse
+                return static_cast<Rep>(ticks) / static_cast<Rep>(r::den);
+            }
+            else if constexpr (std::is_floating_point_v<Rep>)
+            {
+                return static_cast<Rep>(ticks) * conversion_factor<Rep, r>;
+            }
+            else
+            {
+                return static_cast<Rep>(rescale<r>(ticks));
+            }
+        }
+    }
+
+    /** Converts `length` to exact tick count
+     *
+     * Integral lengths convert exactly (units finer than tick are rejected at compile time),
+     * floating point lengths are rounded to the nearest tick.
+     *
+     * @example usage
+     *          1. ExactLength len = to_exact(Length<inch, std::int32_t>{3}); // 193548 ticks
+     *          2. ExactLength len = to_exact(0.1_m) + to_exact(0.2_m);       // exactly 0.3 m
+     */
+    template <typename Unit, typename Rep>
+    [[nodiscard]] constexpr ExactLength to_exact(const Length<Unit, Rep>& length)
+    {
+        return ExactLength{detail::to_ticks<Unit>(length.value())};
+    }
+
+    /** Converts exact `length` to `Length<Unit, Rep>`; integral `Rep` truncates towards zero
+     *
+     * @example usage
+     *          1. Length<metre> lenM = from_exact<metre>(total);
+     *          2. auto lenMm = from_exact<millimetre, std::int64_t>(total);
+     */
+    template <typename Unit, typename Rep = double>
+    [[nodiscard]] constexpr Length<Unit, Rep> from_exact(const ExactLength& length)
+    {
+        return Length<Unit, Rep>{detail::from_ticks<Unit, Rep>(length.value())};
+    }
+
+    /** Converts `n` lengths starting at `in` to exact lengths written to `out`
+     *
+     * Loop is branch free, so compilers vectorise it (as integer multiply, or
+     * multiply-round-convert for floating point input).
+     *
+     * @return - pointer one past the last written length
+     */
+    template <typename Unit, typename Rep>
+    ExactLength* to_exact_n(const Length<Unit, Rep>* in, std::size_t n, ExactLength* out)
+    {
+        const Rep*    src = as_values(in);
+        std::int64_t* dst = as_values(out);
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            dst[i] = detail::to_ticks<Unit>(src[i]);
+        }
+        return out + n;
+    }
+
+    /** Converts `n` exact lengths starting at `in` to lengths of `Unit` written to `out`
+     *
+     * @return - pointer one past the last written length
+     */
+    template <typename Unit, typename Rep>
+    Length<Unit, Rep>* from_exact_n(const ExactLength* in, std::size_t n, Length<Unit, Rep>* out)
+    {
+        const std::int64_t* src = as_values(in);
+        Rep*                dst = as_values(out);
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            dst[i] = detail::from_ticks<Unit, Rep>(src[i]);
+        }
+        return out + n;
+    }
+
+    //////////////////
+    // layout
+    //////////////////
+
+    static_assert (is_layout_compatible_v<tick, std::int64_t>);
+
+}
@@ -0,0 +1,322 @@
+/*********************************************************************************
+ *
+ *  MIT License
+ *
+ *  Copyright (c) 2017 Nenad Zikic
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ *********************************************************************************/
+
+
+#pragma once
+
+#include "length.hpp"
+#include "length_array.hpp"
+
+#include <cstddef>
+#include <stdexcept>
+#include <type_traits>
+
+
+// Opt-in lazy expression layer over `LengthArray`, views and spans.
+//
+// Operands wrapped with `expr::lazy` build expression tree instead of evaluating
+// each operation into temporary array; the whole chain is then computed in a
+// single pass by `expr::evaluate` or `expr::assign`. Every node can produce its
+// value directly in any unit, so each operand is rescaled exactly once, by one
+// compile-time factor from its own unit to the unit of the result.
+//
+// @example usage
+//          LengthArray<metre> r = expr::evaluate<metre>(expr::lazy(a) * k + expr::convert<inch>(expr::lazy(b)) - expr::lazy(c));
+
+namespace length::expr
+{
+
+    template <typename T, typename = void>
+    struct is_expression : std::false_type {};
+
+    template <typename T>
+    struct is_expression<T, std::void_t<typename T::is_length_expression>> : std::true_type {};
+
+    template <typename T>
+    inline constexpr bool is_expression_v = is_expression<std::decay_t<T>>::value;
+
+    template <typename Unit, typename Rep> class terminal;
+    template <typename Unit, typename Rep> class constant;
+    template <typename Lhs, typename Rhs, bool Subtract> class additive;
+    template <typename Expr, typename K, bool Divide> class scaled;
+    template <typename Unit, typename Expr> class converted;
+
+    /** Whether node is built from `constant`s only, so it is broadcast and has no size of its own **/
+    template <typename T>
+    struct is_constant_node : std::false_type {};
+
+    template <typename Unit, typename Rep>
+    struct is_constant_node<constant<Unit, Rep>> : std::true_type {};
+
+    template <typename Lhs, typename Rhs, bool Subtract>
+    struct is_constant_node<additive<Lhs, Rhs, Subtract>> : std::bool_constant<is_constant_node<Lhs>::value && is_constant_node<Rhs>::value> {};
+
+    template <typename Expr, typename K, bool Divide>
+    struct is_constant_node<scaled<Expr, K, Divide>> : is_constant_node<Expr> {};
+
+    template <typename Unit, typename Expr>
+    struct is_constant_node<converted<Unit, Expr>> : is_constant_node<Expr> {};
+
+    template <typename T>
+    inline constexpr bool is_constant_node_v = is_constant_node<T>::value;
+
+    /** Contiguous lengths in `Unit` read element by element **/
+    template <typename Unit, typename Rep>
+    class terminal
+    {
+            const Rep*  m_values;
+            std::size_t m_size;
+
+        public:
+            using is_length_expression = void;
+            using unit = Unit;
+            using rep  = Rep;
+
+            constexpr terminal(const Rep* values, std::size_t size) : m_values{values}, m_size{size} {}
+
+            [[nodiscard]] constexpr std::size_t size() const { return m_size; }
+
+            template <typename ToUnit, typename ToRep = rep>
+            [[nodiscard]] constexpr ToRep value_in(std::size_t i) const
+            {
+                return length::detail::rescale<length::detail::conversion_ratio<Unit, ToUnit>>(static_cast<ToRep>(m_values[i]));
+            }
+    };
+
+    /** Single `Length` broadcast to every element of the expression **/
+    template <typename Unit, typename Rep>
+    class constant
+    {
+            Length<Unit, Rep> m_length;
+
+        public:
+            using is_length_expression = void;
+            using unit = Unit;
+            using rep  = Rep;
+
+            constexpr explicit constant(Length<Unit, Rep> length) : m_length{length} {}
+
+            /** Constants have no size, see `is_constant_node` **/
+            [[nodiscard]] constexpr std::size_t size() const { return 0; }
+
+            template <typename ToUnit, typename ToRep = rep>
+            [[nodiscard]] constexpr ToRep value_in(std::size_t) const
+            {
+                return length::detail::rescale<length::detail::conversion_ratio<Unit, ToUnit>>(static_cast<ToRep>(m_length.value()));
+            }
+    };
+
+    /** `lhs + rhs` or `lhs - rhs`, in units of `lhs`; array operands of different sizes, empty ones
+     *  included, throw `std::length_error`
+     */
+    template <typename Lhs, typename Rhs, bool Subtract>
+    class additive
+    {
+            Lhs m_lhs;
+            Rhs m_rhs;
+
+        public:
+            using is_length_expression = void;
+            using unit = typename Lhs::unit;
+            using rep  = length::detail::common_rep_t<typename Lhs::rep, typename Rhs::rep>;
+
+            constexpr additive(Lhs lhs, Rhs rhs) : m_lhs{lhs}, m_rhs{rhs}
+            {
+                if constexpr (!is_constant_node_v<Lhs> && !is_constant_node_v<Rhs>)
+                {
+                    if (m_lhs.size() != m_rhs.size())
+                    {
+                        throw std::length_error("length: lazy operands must have the same size");
+                    }
+                }
+            }
+
+            [[nodiscard]] constexpr std::size_t size() const { return is_constant_node_v<Lhs> ? m_rhs.size() : m_lhs.size(); }
+
+            template <typename ToUnit, typename ToRep = rep>
+            [[nodiscard]] constexpr ToRep value_in(std::size_t i) const
+            {
+                if constexpr (Subtract)
+                {
+                    return m_lhs.template value_in<ToUnit, ToRep>(i) - m_rhs.template value_in<ToUnit, ToRep>(i);
+                }
+                else
+                {
+                    return m_lhs.template value_in<ToUnit, ToRep>(i) + m_rhs.template value_in<ToUnit, ToRep>(i);
+                }
+            }
+    };
+
+    /** `expr * k` or `expr / k` **/
+    template <typename Expr, typename K, bool Divide>
+    class scaled
+    {
+            Expr m_expr;
+            K    m_k;
+
+        public:
+            using is_length_expression = void;
+            using unit = typename Expr::unit;
+            using rep  = length::detail::common_rep_t<typename Expr::rep, K>;
+
+            constexpr scaled(Expr expr, K k) : m_expr{expr}, m_k{k} {}
+
+            [[nodiscard]] constexpr std::size_t size() const { return m_expr.size(); }
+
+            template <typename ToUnit, typename ToRep = rep>
+            [[nodiscard]] constexpr ToRep value_in(std::size_t i) const
+            {
+                if constexpr (Divide)
+                {
+                    return m_expr.template value_in<ToUnit, ToRep>(i) / static_cast<ToRep>(m_k);
+                }
+                else
+                {
+                    return m_expr.template value_in<ToUnit, ToRep>(i) * static_cast<ToRep>(m_k);
+                }
+            }
+    };
+
+    /** `expr` expressed in `Unit`; conversion is folded into the factor of its operands **/
+    template <typename Unit, typename Expr>
+    class converted
+    {
+            Expr m_expr;
+
+        public:
+            using is_length_expression = void;
+            using unit = Unit;
+            using rep  = typename Expr::rep;
+
+            constexpr explicit converted(Expr expr) : m_expr{expr} {}
+
+            [[nodiscard]] constexpr std::size_t size() const { return m_expr.size(); }
+
+            template <typename ToUnit, typename ToRep = rep>
+            [[nodiscard]] constexpr ToRep value_in(std::size_t i) const
+            {
+                return m_expr.template value_in<ToUnit, ToRep>(i);
+            }
+    };
+
+    // building expressions
+
+    template <typename Unit, typename Rep>
+    [[nodiscard]] constexpr terminal<Unit, Rep> lazy(const Length<Unit, Rep>* data, std::size_t size) { return {as_values(data), size}; }
+
+    template <typename Unit, typename Rep>
+    [[nodiscard]] constexpr terminal<Unit, Rep> lazy(LengthArrayView<Unit, Rep> view) { return {view.values(), view.size()}; }
+
+    template <typename Unit, typename Rep, typename Allocator>
+    [[nodiscard]] constexpr terminal<Unit, Rep> lazy(const LengthArray<Unit, Rep, Allocator>& array) { return {array.values(), array.size()}; }
+
+#if defined(__cpp_lib_span)
+    template <typename Unit, typename Rep, std::size_t Extent>
+    [[nodiscard]] constexpr terminal<Unit, Rep> lazy(std::span<const Length<Unit, Rep>, Extent> data) { return {as_values(data.data()), data.size()}; }
+#endif
+
+    template <typename Unit, typename Expr, std::enable_if_t<is_expression_v<Expr>, int> = 0>
+    [[nodiscard]] constexpr converted<Unit, Expr> convert(Expr expr) { return converted<Unit, Expr>{expr}; }
+
+    namespace detail
+    {
+        template <typename T>
+        [[nodiscard]] constexpr auto operand(T t)
+        {
+            if constexpr (is_length_v<T>) return constant<typename T::unit, typename T::rep>{t};
+            else                          return t;
+        }
+
+        template <typename L, typename R>
+        inline constexpr bool is_additive_operands_v = (is_expression_v<L> && (is_expression_v<R> || is_length_v<R>)) ||
+                                                       (is_length_v<L> && is_expression_v<R>);
+
+        template <typename L, typename R>
+        using enable_if_additive_t = std::enable_if_t<is_additive_operands_v<L, R>, int>;
+
+        template <typename E, typename K>
+        using enable_if_scaled_t = std::enable_if_t<is_expression_v<E> && length::detail::is_scalar_for<typename E::rep, K>::value, int>;
+    }
+
+    template <typename L, typename R, detail::enable_if_additive_t<L, R> = 0>
+    [[nodiscard]] constexpr auto operator+ (L lhs, R rhs)
+    {
+        return additive<decltype(detail::operand(lhs)), decltype(detail::operand(rhs)), false>{detail::operand(lhs), detail::operand(rhs)};
+    }
+
+    template <typename L, typename R, detail::enable_if_additive_t<L, R> = 0>
+    [[nodiscard]] constexpr auto operator- (L lhs, R rhs)
+    {
+        return additive<decltype(detail::operand(lhs)), decltype(detail::operand(rhs)), true>{detail::operand(lhs), detail::operand(rhs)};
+    }
+
+    template <typename E, typename K, detail::enable_if_scaled_t<E, K> = 0>
+    [[nodiscard]] constexpr scaled<E, K, false> operator* (E expr, K k) { return {expr, k}; }
+
+    template <typename E, typename K, detail::enable_if_scaled_t<E, K> = 0>
+    [[nodiscard]] constexpr scaled<E, K, false> operator* (K k, E expr) { return {expr, k}; }
+
+    template <typename E, typename K, detail::enable_if_scaled_t<E, K> = 0>
+    [[nodiscard]] constexpr scaled<E, K, true> operator/ (E expr, K k) { return {expr, k}; }
+
+    // evaluation
+
+    /** Evaluates `expr` into `out` in a single pass, `out` may be one of the operands **/
+    template <typename Unit, typename Rep, typename Allocator, typename Expr, std::enable_if_t<is_expression_v<Expr>, int> = 0>
+    void assign(LengthArray<Unit, Rep, Allocator>& out, const Expr& expr)
+    {
+        const std::size_t n = expr.size();
+        if (out.size() != n)
+        {
+            out.resize(n);
+        }
+        Rep* values = out.values();
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            values[i] = expr.template value_in<Unit, Rep>(i);
+        }
+    }
+
+    /** Evaluates `expr` into new array of lengths in `Unit` (units of `expr` by default) **/
+    template <typename Unit = void, typename Expr, std::enable_if_t<is_expression_v<Expr>, int> = 0>
+    [[nodiscard]] auto evaluate(const Expr& expr)
+    {
+        using unit = std::conditional_t<std::is_void_v<Unit>, typename Expr::unit, Unit>;
+        LengthArray<unit, typename Expr::rep> out;
+        assign(out, expr);
+        return out;
+    }
+
+    /** Evaluates `expr` into new array allocated with `allocator`, e.g. `std::pmr::polymorphic_allocator` over request arena **/
+    template <typename Unit = void, typename Expr, typename Allocator, std::enable_if_t<is_expression_v<Expr>, int> = 0>
+    [[nodiscard]] auto evaluate(const Expr& expr, const Allocator& allocator)
+    {
+        using unit = std::conditional_t<std::is_void_v<Unit>, typename Expr::unit, Unit>;
+        LengthArray<unit, typename Expr::rep, Allocator> out(allocator);
+        assign(out, expr);
+        return out;
+    }
+}
@@ -0,0 +1,630 @@
+/*********************************************************************************
+ *
+ *  MIT License
+ *
+ *  Copyright (c) 2017 Nenad Zikic
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ *********************************************************************************/
+
+
+#pragma once
+
+#include "length.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <climits>
+#include <cmath>
+#include <cstddef>
+#include <locale>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
+
+#if defined(__cpp_lib_format)
+#include <format>
+#endif
+
+#if defined(LENGTH_WITH_FMT)
+#include <fmt/format.h>
+#include <fmt/xchar.h>
+#endif
+
+
+// Allocation free formatting of lengths as "<value> <symbol>", e.g. "12.5 mm".
+// Value is written with `std::to_chars`, by default in the shortest form that
+// parses back (see `length::parse`) to exactly the same value.
+//
+// `std::format` support is enabled when the standard library provides it,
+// `fmt` support when `LENGTH_WITH_FMT` is defined. Like for `std::chrono`
+// types fill, align and width apply to the whole text and the rest of the
+// spec to the value, e.g. `std::format("{:>10.1f}", 12.34_mm)` gives
+// "   12.3 mm". The value is written with `std::to_chars` into a stack buffer
+// and the padded text straight to the output, so they don't allocate either.
+
+namespace length
+{
+
+    namespace detail
+    {
+        /** Appends " <symbol>" of `Unit` after number written by `std::to_chars` **/
+        template <typename Unit>
+        [[nodiscard]] std::to_chars_result append_symbol(std::to_chars_result number, char* last)
+        {
+            if (number.ec != std::errc{})
+            {
+                return number;
+            }
+
+            constexpr std::string_view symbol = Unit::symbol;
+            if (static_cast<std::size_t>(last - number.ptr) < symbol.size() + 1)
+            {
+                return {last, std::errc::value_too_large};
+            }
+
+            char* p = number.ptr;
+            *p++ = ' ';
+            for (const char c : symbol)
+            {
+                *p++ = c;
+            }
+            return {p, std::errc{}};
+        }
+    }
+
+    /** Writes `length` as "<value> <symbol>" into [first, last) using shortest round-trip representation
+     *
+     * @return - `ptr` one past the last written character and `std::errc{}` on success,
+     *           `{last, std::errc::value_too_large}` if the buffer is too small
+     *
+     * @example usage
+     *          1. char buf[32]; auto [end, ec] = to_chars(buf, buf + sizeof buf, 12.5_mm); // "12.5 mm"
+     */
+    template <typename Unit, typename Rep>
+    std::to_chars_result to_chars(char* first, char* last, const Length<Unit, Rep>& length)
+    {
+        return detail::append_symbol<Unit>(std::to_chars(first, last, length.value()), last);
+    }
+
+    /** Writes `length` with floating point value in format `fmt` **/
+    template <typename Unit, typename Rep, std::enable_if_t<std::is_floating_point_v<Rep>, int> = 0>
+    std::to_chars_result to_chars(char* first, char* last, const Length<Unit, Rep>& length, std::chars_format fmt)
+    {
+        return detail::append_symbol<Unit>(std::to_chars(first, last, length.value(), fmt), last);
+    }
+
+    /** Writes `length` with floating point value in format `fmt` with `precision` digits **/
+    template <typename Unit, typename Rep, std::enable_if_t<std::is_floating_point_v<Rep>, int> = 0>
+    std::to_chars_result to_chars(char* first, char* last, const Length<Unit, Rep>& length, std::chars_format fmt, int precision)
+    {
+        return detail::append_symbol<Unit>(std::to_chars(first, last, length.value(), fmt, precision), last);
+    }
+}
+
+#if defined(__cpp_lib_format) || defined(LENGTH_WITH_FMT)
+namespace length::detail
+{
+    /** Parsed `[[fill]align][sign][#][0][width][.precision][L][type]` spec of a formatted length
+     *  Fill, align and width apply to the whole "<value> <symbol>" text, the rest to the value
+     */
+    template <typename CharT>
+    struct length_format_spec
+    {
+        CharT       fill[4]       = {CharT(' ')};
+        std::size_t fill_size     = 1;
+        CharT       align         = 0;
+        CharT       sign          = 0;
+        bool        alternate     = false;
+        bool        zero          = false;
+        bool        localized     = false;
+        int         width         = 0;
+        int         width_arg     = -1;
+        int         precision     = -1;
+        int         precision_arg = -1;
+        CharT       type          = 0;
+    };
+
+    template <typename CharT>
+    [[nodiscard]] constexpr bool is_format_align(CharT c)
+    {
+        return c == CharT('<') || c == CharT('>') || c == CharT('^');
+    }
+
+    template <typename CharT>
+    [[nodiscard]] constexpr bool is_format_digit(CharT c)
+    {
+        return c >= CharT('0') && c <= CharT('9');
+    }
+
+    /** Number of code units of the fill character starting at `p`, UTF-8 sequences are kept whole **/
+    template <typename CharT>
+    [[nodiscard]] constexpr std::size_t fill_size(const CharT* p, const CharT* end)
+    {
+        std::size_t n = 1;
+        if constexpr (sizeof(CharT) == 1)
+        {
+            const auto lead = static_cast<unsigned char>(*p);
+            n = (lead >> 5) == 0x6 ? 2 : (lead >> 4) == 0xE ? 3 : (lead >> 3) == 0x1E ? 4 : 1;
+        }
+        return static_cast<std::size_t>(end - p) < n ? 1 : n;
+    }
+
+    /** Parses width or precision, either a number into `value` or `{}`/`{n}` argument id into `arg` **/
+    template <typename Error, typename CharT, typename ParseContext>
+    constexpr const CharT* parse_format_number(const CharT* p, const CharT* end, ParseContext& ctx, int& value, int& arg)
+    {
+        if (*p == CharT('{'))
+        {
+            ++p;
+            if (p != end && *p == CharT('}'))
+            {
+                arg = static_cast<int>(ctx.next_arg_id());
+                return p + 1;
+            }
+
+            int id = 0;
+            const CharT* digits = p;
+            for (; p != end && is_format_digit(*p) && id < 1'000'000; ++p)
+            {
+                id = id * 10 + static_cast<int>(*p - CharT('0'));
+            }
+            if (p == digits || p == end || *p != CharT('}'))
+            {
+                throw Error("length: invalid dynamic width or precision");
+            }
+            ctx.check_arg_id(id);
+            arg = id;
+            return p + 1;
+        }
+
+        value = 0;
+        for (; p != end && is_format_digit(*p); ++p)
+        {
+            if (value >= 100'000'000)
+            {
+                throw Error("length: width or precision is too large");
+            }
+            value = value * 10 + static_cast<int>(*p - CharT('0'));
+        }
+        return p;
+    }
+
+    /** Parses format spec of a length with `Floating` point or integral value into `spec` **/
+    template <typename Error, bool Floating, typename CharT, typename ParseContext>
+    constexpr auto parse_length_format(ParseContext& ctx, length_format_spec<CharT>& spec)
+    {
+        auto p = ctx.begin();
+        const auto end = ctx.end();
+        if (p == end || *p == CharT('}'))
+        {
+            return p;
+        }
+
+        const std::size_t fill = fill_size(p, end);
+        if (static_cast<std::size_t>(end - p) > fill && is_format_align(p[fill]) && *p != CharT('{') && *p != CharT('}'))
+        {
+            for (std::size_t i = 0; i < fill; ++i)
+            {
+                spec.fill[i] = p[i];
+            }
+            spec.fill_size = fill;
+            spec.align = p[fill];
+            p += fill + 1;
+        }
+        else if (is_format_align(*p))
+        {
+            spec.align = *p++;
+        }
+
+        if (p != end && (*p == CharT('+') || *p == CharT('-') || *p == CharT(' ')))
+        {
+            spec.sign = *p++;
+        }
+        if (p != end && *p == CharT('#'))
+        {
+            spec.alternate = true;
+            ++p;
+        }
+        if (p != end && *p == CharT('0'))
+        {
+            spec.zero = true;
+            ++p;
+        }
+        if (p != end && (is_format_digit(*p) || *p == CharT('{')))
+        {
+            p = parse_format_number<Error>(p, end, ctx, spec.width, spec.width_arg);
+        }
+        if (p != end && *p == CharT('.'))
+        {
+            if constexpr (!Floating)
+            {
+                throw Error("length: precision is not allowed for integral values");
+            }
+            ++p;
+            if (p == end || !(is_format_digit(*p) || *p == CharT('{')))
+            {
+                throw Error("length: missing precision");
+            }
+            p = parse_format_number<Error>(p, end, ctx, spec.precision, spec.precision_arg);
+        }
+        if (p != end && *p == CharT('L'))
+        {
+            spec.localized = true;
+            ++p;
+        }
+        if (p != end && *p != CharT('}'))
+        {
+            constexpr std::string_view types = Floating ? std::string_view{"aAeEfFgG"} : std::string_view{"bBdoxX"};
+            if (static_cast<unsigned long>(*p) > 127 || types.find(static_cast<char>(*p)) == std::string_view::npos)
+            {
+                throw Error("length: invalid presentation type");
+            }
+            spec.type = *p++;
+        }
+        if (p != end && *p != CharT('}'))
+        {
+            throw Error("length: invalid format spec");
+        }
+        return p;
+    }
+
+    /** Value of dynamic width or precision argument, a non-negative integer **/
+    template <typename Error, typename CharT>
+    struct format_arg_value
+    {
+        template <typename T>
+        int operator()(T value) const
+        {
+            if constexpr (std::is_integral_v<T> && !std::is_same_v<T, bool> && !std::is_same_v<T, CharT>)
+            {
+                if constexpr (std::is_signed_v<T>)
+                {
+                    if (value < 0)
+                    {
+                        throw Error("length: negative width or precision");
+                    }
+                }
+                if (static_cast<std::make_unsigned_t<T>>(value) > static_cast<unsigned>(INT_MAX))
+                {
+                    throw Error("length: width or precision is too large");
+                }
+                return static_cast<int>(value);
+            }
+            else
+            {
+                throw Error("length: width or precision is not an integer");
+            }
+        }
+    };
+
+    /** Characters written by `std::to_chars`, in a stack buffer unless a huge precision or fixed value needs more **/
+    class number_chars
+    {
+        public:
+            /** Calls `write(first, last) -> std::to_chars_result` with ever larger buffers until it fits **/
+            template <typename Write>
+            explicit number_chars(Write&& write)
+            {
+                std::to_chars_result r = write(m_stack, m_stack + sizeof m_stack);
+                for (std::size_t size = sizeof m_stack; r.ec == std::errc::value_too_large; )
+                {
+                    size *= 4;
+                    m_heap  = std::make_unique<char[]>(size);
+                    m_first = m_heap.get();
+                    r = write(m_first, m_first + size);
+                }
+                m_last = r.ptr;
+            }
+
+            number_chars(const number_chars&) = delete;
+            number_chars& operator= (const number_chars&) = delete;
+
+            [[nodiscard]] const char* begin() const { return m_first; }
+            [[nodiscard]] const char* end() const   { return m_last; }
+
+        private:
+            char                    m_stack[512];
+            std::unique_ptr<char[]> m_heap;
+            char*                   m_first = m_stack;
+            char*                   m_last  = m_stack;
+    };
+
+    /** Value of a length formatted as per `length_format_spec`, in parts so padding is known before writing
+     *
+     *  Text is `sign prefix [zeros] mantissa [point] [trailing zeros] exponent`, where mantissa holds
+     *  `std::to_chars` output of the magnitude up to exponent and its first `integer_digits` characters
+     *  are grouped in localized form.
+     */
+    template <typename Rep>
+    struct length_number
+    {
+            template <typename CharT>
+            length_number(Rep value, const length_format_spec<CharT>& spec, int precision)
+                : sign{negative(value) ? '-' : spec.sign == CharT('+') ? '+' : spec.sign == CharT(' ') ? ' ' : '\0'}
+                , upper{spec.type == CharT('A') || spec.type == CharT('E') || spec.type == CharT('F') || spec.type == CharT('G') || spec.type == CharT('X') || spec.type == CharT('B')}
+                , digits{[&](char* first, char* last) { return write(first, last, value, static_cast<char>(spec.type), precision); }}
+            {
+                const char type = static_cast<char>(spec.type);
+                if constexpr (std::is_integral_v<Rep>)
+                {
+                    if (spec.alternate)
+                    {
+                        prefix = type == 'b' ? "0b" : type == 'B' ? "0B" : type == 'x' ? "0x" : type == 'X' ? "0X" : type == 'o' && value != 0 ? "0" : "";
+                    }
+                    exponent = static_cast<std::size_t>(digits.end() - digits.begin());
+                    integer_digits = type == '\0' || type == 'd' ? exponent : 0;
+                }
+                else
+                {
+                    const bool hex = type == 'a' || type == 'A';
+                    const std::string_view text{digits.begin(), static_cast<std::size_t>(digits.end() - digits.begin())};
+                    finite = std::isfinite(value);
+                    exponent = std::min(text.find(hex ? 'p' : 'e'), text.size());
+                    const std::size_t dot = text.find('.');
+                    integer_digits = hex || !finite ? 0 : std::min(dot, exponent);
+                    if (spec.alternate && finite)
+                    {
+                        point = dot == std::string_view::npos;
+                        const bool general = type == 'g' || type == 'G' || (type == '\0' && precision >= 0);
+                        if (general)
+                        {
+                            // printf `%#g` keeps trailing zeros up to `precision` significant digits
+                            const std::size_t wanted = precision == 0 ? 1 : precision < 0 ? 6 : static_cast<std::size_t>(precision);
+                            const std::size_t first = text.substr(0, exponent).find_first_of("123456789");
+                            std::size_t significant = 0;
+                            for (std::size_t i = first == std::string_view::npos ? 0 : first; i < exponent; ++i)
+                            {
+                                significant += text[i] != '.' ? 1 : 0;
+                            }
+                            zeros = wanted > significant ? wanted - significant : 0;
+                        }
+                    }
+                }
+            }
+
+            char             sign;
+            std::string_view prefix;
+            bool             upper;
+            bool             finite = true;
+            bool             point  = false;
+            std::size_t      zeros  = 0;
+            std::size_t      integer_digits = 0;
+            std::size_t      exponent = 0;
+            number_chars     digits;
+
+        private:
+            static bool negative(Rep value)
+            {
+                if constexpr (std::is_floating_point_v<Rep>)
+                {
+                    return std::signbit(value);
+                }
+                else
+                {
+                    return value < 0;
+                }
+            }
+
+            /** Magnitude of `value` in presentation `type`, like `std::format` does **/
+            static std::to_chars_result write(char* first, char* last, Rep value, char type, int precision)
+            {
+                if constexpr (std::is_floating_point_v<Rep>)
+                {
+                    const Rep magnitude = std::abs(value);
+                    switch (type)
+                    {
+                        case 'a': case 'A':
+                            return precision < 0 ? std::to_chars(first, last, magnitude, std::chars_format::hex)
+                                                 : std::to_chars(first, last, magnitude, std::chars_format::hex, precision);
+                        case 'e': case 'E':
+                            return std::to_chars(first, last, magnitude, std::chars_format::scientific, precision < 0 ? 6 : precision);
+                        case 'f': case 'F':
+                            return std::to_chars(first, last, magnitude, std::chars_format::fixed, precision < 0 ? 6 : precision);
+                        case 'g': case 'G':
+                            return std::to_chars(first, last, magnitude, std::chars_format::general, precision < 0 ? 6 : precision);
+                        default:
+                            return precision < 0 ? std::to_chars(first, last, magnitude)
+                                                 : std::to_chars(first, last, magnitude, std::chars_format::general, precision);
+                    }
+                }
+                else
+                {
+                    using U = std::make_unsigned_t<Rep>;
+                    const U magnitude = value < 0 ? static_cast<U>(U{0} - static_cast<U>(value)) : static_cast<U>(value);
+                    const int base = type == 'b' || type == 'B' ? 2 : type == 'o' ? 8 : type == 'x' || type == 'X' ? 16 : 10;
+                    return std::to_chars(first, last, magnitude, base);
+                }
+            }
+    };
+
+    /** Size of `i`-th digit group from the right per `std::numpunct::grouping`, 0 if the rest is not grouped **/
+    [[nodiscard]] inline std::size_t digit_group(const std::string& grouping, std::size_t i)
+    {
+        const char g = grouping.empty() ? 0 : grouping[std::min(i, grouping.size() - 1)];
+        return g <= 0 || g == CHAR_MAX ? 0 : static_cast<std::size_t>(g);
+    }
+
+    /** Number of separators in a run of `n` digits grouped per `grouping` **/
+    [[nodiscard]] inline std::size_t digit_separators(const std::string& grouping, std::size_t n)
+    {
+        std::size_t count = 0;
+        for (std::size_t g = digit_group(grouping, 0); g != 0 && n > g; g = digit_group(grouping, ++count))
+        {
+            n -= g;
+        }
+        return count;
+    }
+
+    /** Writes "<value> <symbol>" of `Unit` to `out` padded to `width` as per `spec`, without allocating
+     *
+     *  Default alignment is left like for `std::chrono` types, `0` without explicit align pads the
+     *  value with zeros to `width`. `locale` is only used for localized (`L`) specs.
+     */
+    template <typename Unit, typename CharT, typename OutputIt, typename Rep, typename GetLocale>
+    OutputIt write_length(OutputIt out, const length_format_spec<CharT>& spec, int width, const length_number<Rep>& number, GetLocale&& locale)
+    {
+        constexpr std::string_view symbol = Unit::symbol;
+
+        // localized form groups integer digits and uses locale's decimal point
+        std::string grouping;
+        CharT separator = CharT(',');
+        CharT decimal_point = CharT('.');
+        if (spec.localized)
+        {
+            const std::locale loc = locale();
+            const auto& punct = std::use_facet<std::numpunct<CharT>>(loc);
+            grouping = punct.grouping();
+            separator = punct.thousands_sep();
+            decimal_point = punct.decimal_point();
+        }
+
+        const std::string_view mantissa{number.digits.begin(), number.exponent};
+        const std::string_view exponent{number.digits.begin() + number.exponent, static_cast<std::size_t>(number.digits.end() - number.digits.begin()) - number.exponent};
+        const std::size_t separators = spec.localized ? digit_separators(grouping, number.integer_digits) : 0;
+        const std::size_t value_size = (number.sign != '\0' ? 1 : 0) + number.prefix.size() + mantissa.size() + separators
+                                     + (number.point ? 1 : 0) + number.zeros + exponent.size();
+        const std::size_t text_size = value_size + 1 + symbol.size();
+        const std::size_t target = width > 0 ? static_cast<std::size_t>(width) : 0;
+
+        const bool zero_fill = spec.zero && spec.align == 0 && number.finite;
+        const std::size_t zero_padding = zero_fill && target > text_size ? target - text_size : 0;
+        const std::size_t padding = !zero_fill && target > text_size ? target - text_size : 0;
+        // infinity and NaN aren't zero padded but still right aligned like a zero padded number
+        const bool right = spec.align == CharT('>') || (spec.zero && spec.align == 0);
+        const std::size_t before = right ? padding : spec.align == CharT('^') ? padding / 2 : 0;
+
+        const auto fill = [&](std::size_t count) {
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                out = std::copy(spec.fill, spec.fill + spec.fill_size, out);
+            }
+        };
+        const auto put = [&](char c) {
+            *out++ = c == '.' ? decimal_point : CharT(number.upper && c >= 'a' && c <= 'z' ? c - 'a' + 'A' : c);
+        };
+        const auto put_all = [&](std::string_view s) {
+            for (const char c : s)
+            {
+                put(c);
+            }
+        };
+
+        fill(before);
+        if (number.sign != '\0')
+        {
+            put(number.sign);
+        }
+        put_all(number.prefix);
+        for (std::size_t i = 0; i < zero_padding; ++i)
+        {
+            put('0');
+        }
+
+        // integer digits, leftmost group first
+        std::size_t written = 0;
+        if (separators > 0)
+        {
+            std::size_t grouped = 0;
+            for (std::size_t i = 0; i < separators; ++i)
+            {
+                grouped += digit_group(grouping, i);
+            }
+            written = number.integer_digits - grouped;
+            put_all(mantissa.substr(0, written));
+            for (std::size_t i = separators; i-- > 0; )
+            {
+                const std::size_t size = digit_group(grouping, i);
+                *out++ = separator;
+                put_all(mantissa.substr(written, size));
+                written += size;
+            }
+        }
+
+        put_all(mantissa.substr(written));
+        if (number.point)
+        {
+            put('.');
+        }
+        for (std::size_t i = 0; i < number.zeros; ++i)
+        {
+            put('0');
+        }
+        put_all(exponent);
+        *out++ = CharT(' ');
+        for (const char c : symbol)
+        {
+            *out++ = CharT(c);
+        }
+        fill(padding - before);
+        return out;
+    }
+}
+#endif
+
+#if defined(__cpp_lib_format)
+template <typename Unit, typename Rep, typename CharT>
+struct std::formatter<length::Length<Unit, Rep>, CharT>
+{
+        length::detail::length_format_spec<CharT> spec;
+
+        template <typename ParseContext>
+        constexpr auto parse(ParseContext& ctx)
+        {
+            return length::detail::parse_length_format<std::format_error, std::is_floating_point_v<Rep>>(ctx, spec);
+        }
+
+        template <typename FormatContext>
+        auto format(const length::Length<Unit, Rep>& length, FormatContext& ctx) const
+        {
+            const auto resolve = [&](int value, int arg) {
+                return arg < 0 ? value : std::visit_format_arg(length::detail::format_arg_value<std::format_error, CharT>{}, ctx.arg(static_cast<std::size_t>(arg)));
+            };
+            const length::detail::length_number<Rep> number{length.value(), spec, resolve(spec.precision, spec.precision_arg)};
+            return length::detail::write_length<Unit>(ctx.out(), spec, resolve(spec.width, spec.width_arg), number, [&] { return ctx.locale(); });
+        }
+};
+#endif
+
+#if defined(LENGTH_WITH_FMT)
+template <typename Unit, typename Rep, typename CharT>
+struct fmt::formatter<length::Length<Unit, Rep>, CharT>
+{
+        length::detail::length_format_spec<CharT> spec;
+
+        template <typename ParseContext>
+        constexpr auto parse(ParseContext& ctx) -> decltype(ctx.begin())
+        {
+            return length::detail::parse_length_format<fmt::format_error, std::is_floating_point_v<Rep>>(ctx, spec);
+        }
+
+        template <typename FormatContext>
+        auto format(const length::Length<Unit, Rep>& length, FormatContext& ctx) const -> decltype(ctx.out())
+        {
+            const auto resolve = [&](int value, int arg) {
+                return arg < 0 ? value : fmt::visit_format_arg(length::detail::format_arg_value<fmt::format_error, CharT>{}, ctx.arg(arg));
+            };
+            const length::detail::length_number<Rep> number{length.value(), spec, resolve(spec.precision, spec.precision_arg)};
+            return length::detail::write_length<Unit>(ctx.out(), spec, resolve(spec.width, spec.width_arg), number, [&] { return ctx.locale().template get<std::locale>(); });
+        }
+};
+#endif
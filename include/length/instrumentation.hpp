@@ -0,0 +1,220 @@
+/*********************************************************************************
+ *
+ *  MIT License
+ *
+ *  Copyright (c) 2017 Nenad Zikic
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ *********************************************************************************/
+
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <ostream>
+#include <ratio>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#if __has_include(<version>)
+#include <version>
+#endif
+
+
+// Opt-in counters of unit conversions and mixed-unit operations.
+//
+// Defining `LENGTH_INSTRUMENTATION` before including any length header makes
+// `convert`, mixed-unit `+`, `-`, comparisons and the bulk conversion and
+// arithmetic APIs count their calls and converted values per (from, to) unit pair.
+// Counters register themselves on first use; constant evaluation is never counted.
+// A mixed-unit operation is one `mixed_*` event, its own rescale is not counted
+// as a conversion as well. Without the macro the hooks expand to nothing.
+//
+// Like `LENGTH_COMMON_UNIT_ARITHMETIC`, the macro has to be defined consistently
+// in every translation unit of the program: inline functions and templates with
+// and without hooks would otherwise violate the one definition rule, and which of
+// the copies the linker keeps, so which calls are counted, is unspecified.
+//
+//      length::instrumentation::report(std::cerr);
+//      length::instrumentation::for_each([](const length::instrumentation::snapshot& s) { ... });
+
+#if defined(__cpp_lib_is_constant_evaluated)
+#define LENGTH_IS_CONSTANT_EVALUATED() std::is_constant_evaluated()
+#elif defined(__GNUC__) || defined(__clang__) || (defined(_MSC_VER) && _MSC_VER >= 1925)
+#define LENGTH_IS_CONSTANT_EVALUATED() __builtin_is_constant_evaluated()
+#else
+#error "LENGTH_INSTRUMENTATION needs std::is_constant_evaluated or compiler builtin"
+#endif
+
+namespace length::instrumentation
+{
+
+    /** What caused a rescale **/
+    enum class event
+    {
+        conversion,        // `convert`, `convert_n` and everything built on them
+        mixed_arithmetic,  // `+`, `-`, `+=`, `-=`, `/` of lengths in different units
+        mixed_comparison   // `==`, `<`, `<=>`, ... of lengths in different units
+    };
+
+    [[nodiscard]] constexpr std::string_view to_string(event e)
+    {
+        switch (e)
+        {
+            case event::conversion:       return "conversion";
+            case event::mixed_arithmetic: return "mixed_arithmetic";
+            case event::mixed_comparison: return "mixed_comparison";
+        }
+        return "";
+    }
+
+    /** Unit as size in metres, with symbol if it has one **/
+    struct unit_info
+    {
+        std::intmax_t    num;
+        std::intmax_t    den;
+        std::string_view symbol;
+    };
+
+    /** Counts of one (event, from, to) triple at the time it was read **/
+    struct snapshot
+    {
+        event         kind;
+        unit_info     from;
+        unit_info     to;
+        std::uint64_t calls;
+        std::uint64_t values;
+    };
+
+    namespace detail
+    {
+        template <typename Unit, typename = void>
+        struct has_symbol : std::false_type {};
+
+        template <typename Unit>
+        struct has_symbol<Unit, std::void_t<decltype(Unit::symbol)>> : std::true_type {};
+
+        template <typename Unit>
+        [[nodiscard]] constexpr unit_info info_of()
+        {
+            if constexpr (has_symbol<Unit>::value) return {Unit::ratio::num, Unit::ratio::den, Unit::symbol};
+            else                                   return {Unit::ratio::num, Unit::ratio::den, {}};
+        }
+
+        struct counter;
+
+        inline std::atomic<counter*>& registry()
+        {
+            static std::atomic<counter*> head{nullptr};
+            return head;
+        }
+
+        /** Counter of one (event, from, to) triple, pushed on lock-free registry list when constructed **/
+        struct counter
+        {
+                event                      kind;
+                unit_info                  from;
+                unit_info                  to;
+                std::atomic<std::uint64_t> calls{0};
+                std::atomic<std::uint64_t> values{0};
+                counter*                   next = nullptr;
+
+                counter(event k, unit_info f, unit_info t) : kind{k}, from{f}, to{t}
+                {
+                    std::atomic<counter*>& head = registry();
+                    next = head.load(std::memory_order_relaxed);
+                    while (!head.compare_exchange_weak(next, this, std::memory_order_release, std::memory_order_relaxed)) {}
+                }
+        };
+
+        template <event Kind, typename From, typename To>
+        void record(std::uint64_t values) noexcept
+        {
+            static counter c{Kind, info_of<From>(), info_of<To>()};
+            c.calls.fetch_add(1, std::memory_order_relaxed);
+            c.values.fetch_add(values, std::memory_order_relaxed);
+        }
+
+        /** Hook called by instrumented operations, no-op for same units and during constant evaluation **/
+        template <event Kind, typename From, typename To>
+        constexpr void hook(std::uint64_t values)
+        {
+            if constexpr (!std::is_same_v<From, To>)
+            {
+                if (!LENGTH_IS_CONSTANT_EVALUATED())
+                {
+                    record<Kind, From, To>(values);
+                }
+            }
+        }
+
+        inline void print_unit(std::ostream& os, const unit_info& unit)
+        {
+            if (!unit.symbol.empty()) os << unit.symbol;
+            else                      os << '[' << unit.num << '/' << unit.den << " m]";
+        }
+    }
+
+    /** Calls `f(snapshot)` for every counter used so far, in no particular order **/
+    template <typename F>
+    void for_each(F&& f)
+    {
+        for (const detail::counter* c = detail::registry().load(std::memory_order_acquire); c != nullptr; c = c->next)
+        {
+            f(snapshot{c->kind, c->from, c->to, c->calls.load(std::memory_order_relaxed), c->values.load(std::memory_order_relaxed)});
+        }
+    }
+
+    /** Zeroes all counters **/
+    inline void reset()
+    {
+        for (detail::counter* c = detail::registry().load(std::memory_order_acquire); c != nullptr; c = c->next)
+        {
+            c->calls.store(0, std::memory_order_relaxed);
+            c->values.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    /** Writes one line per non-zero counter, most converted values first, e.g.
+     *  "conversion in -> m: 1200 calls, 480000 values"
+     */
+    inline void report(std::ostream& os)
+    {
+        std::vector<snapshot> all;
+        for_each([&](const snapshot& s) { if (s.calls != 0) all.push_back(s); });
+        std::sort(all.begin(), all.end(), [](const snapshot& a, const snapshot& b) { return a.values > b.values; });
+        for (const snapshot& s : all)
+        {
+            os << to_string(s.kind) << ' ';
+            detail::print_unit(os, s.from);
+            os << " -> ";
+            detail::print_unit(os, s.to);
+            os << ": " << s.calls << " calls, " << s.values << " values\n";
+        }
+    }
+}
+
+// hooks only record with LENGTH_INSTRUMENTATION; otherwise length.hpp keeps them no-ops
+#if defined(LENGTH_INSTRUMENTATION)
+#define LENGTH_INSTRUMENT(Event, From, To, n) ::length::instrumentation::detail::hook<::length::instrumentation::event::Event, From, To>(n)
+#endif
@@ -28,66 +28,466 @@
 
 #include <type_traits>
 #include <ratio>
+#include <cstddef>
+#include <cstdint>
+#include <numeric>
+#include <string_view>
+
+#if __has_include(<version>)
+#include <version>
+#endif
+
+#if defined(__cpp_lib_span)
+#include <span>
+#endif
+
+#if defined(__cpp_lib_three_way_comparison)
+#include <compare>
+#endif
+
+// opt-in counters, defined alike in every translation unit or none, see instrumentation.hpp
+#if defined(LENGTH_INSTRUMENTATION)
+#include "instrumentation.hpp"
+#else
+#define LENGTH_INSTRUMENT(Event, From, To, n) static_cast<void>(0)
+#endif
+
+// core arithmetic is callable from CUDA / HIP kernels; SYCL device code needs no annotation
+#if defined(__CUDACC__) || defined(__HIPCC__)
+#define LENGTH_HOST_DEVICE __host__ __device__
+#else
+#define LENGTH_HOST_DEVICE
+#endif
 
 
 namespace length
 {
 
+    /** Base of every length unit; `Ratio` is the size of the unit in metres
+     *
+     * Any type deriving from `length_unit` can be used as `Length` unit, e.g.
+     *
+     *      struct league : length_unit<std::ratio<4828>> { static constexpr std::string_view symbol = "lea"; };
+     *
+     * `symbol` is optional, needed only for formatting.
+     */
     template <typename Ratio>
     struct length_unit
     {
             using ratio = Ratio;
     };
 
-    struct metre      : length_unit<std::ratio<1>> {};
-    struct centimetre : length_unit<std::centi> {};
-    struct millimetre : length_unit<std::milli> {};
-    struct inch       : length_unit<std::ratio_multiply<std::ratio<254, 100>, centimetre::ratio>> {};
-    struct foot       : length_unit<std::ratio_multiply<std::ratio<12, 1>, inch::ratio>> {};
+    // built-in units, `symbol` is used when parsing and formatting lengths
+
+    struct metre         : length_unit<std::ratio<1>> { static constexpr std::string_view symbol = "m"; };
+    struct centimetre    : length_unit<std::centi>     { static constexpr std::string_view symbol = "cm"; };
+    struct millimetre    : length_unit<std::milli>     { static constexpr std::string_view symbol = "mm"; };
+    struct micrometre    : length_unit<std::micro>     { static constexpr std::string_view symbol = "um"; };
+    struct nanometre     : length_unit<std::nano>      { static constexpr std::string_view symbol = "nm"; };
+    struct inch          : length_unit<std::ratio_multiply<std::ratio<254, 100>, centimetre::ratio>> { static constexpr std::string_view symbol = "in"; };
+    struct foot          : length_unit<std::ratio_multiply<std::ratio<12, 1>, inch::ratio>>         { static constexpr std::string_view symbol = "ft"; };
+    struct yard          : length_unit<std::ratio_multiply<std::ratio<3, 1>, foot::ratio>>          { static constexpr std::string_view symbol = "yd"; };
+    struct mile          : length_unit<std::ratio_multiply<std::ratio<1760, 1>, yard::ratio>>       { static constexpr std::string_view symbol = "mi"; };
+    struct nautical_mile : length_unit<std::ratio<1852>> { static constexpr std::string_view symbol = "nmi"; };
+
+    namespace detail
+    {
+        template <typename Ratio>
+        std::true_type derives_from_length_unit(const length_unit<Ratio>*);
+
+        std::false_type derives_from_length_unit(...);
+    }
+
+    /** Whether `T` is a length unit, i.e. derives from `length_unit<Ratio>` **/
+    template <typename T>
+    struct is_length_unit : decltype(detail::derives_from_length_unit(static_cast<const T*>(nullptr))) {};
 
-    template <typename Unit>
+    template <typename T>
+    inline constexpr bool is_length_unit_v = is_length_unit<T>::value;
+
+    namespace detail
+    {
+        /** Whether `Length<FromUnit, FromRep>` converts to `Length<ToUnit, ToRep>` without truncation, by `std::chrono::duration` rules:
+         *  floating point `ToRep`, or integral `FromRep` and `FromUnit` a whole multiple of `ToUnit`
+         */
+        template <typename FromUnit, typename FromRep, typename ToUnit, typename ToRep>
+        inline constexpr bool is_lossless_conversion_v =
+            std::is_convertible_v<const FromRep&, ToRep> &&
+            (std::is_floating_point_v<ToRep> ||
+             (!std::is_floating_point_v<FromRep> && std::ratio_divide<typename FromUnit::ratio, typename ToUnit::ratio>::den == 1));
+    }
+
+    /** Length measured in units `Unit`, stored as a value of type `Rep`
+     *
+     * `Rep` defaults to `double`, but any arithmetic (or arithmetic-like) type
+     * can be used, e.g. `float` or `std::int32_t` to save memory and bandwidth.
+     * Operations mixing different representations are carried out in
+     * `std::common_type_t<Rep1, Rep2>`, in the same way as `std::chrono::duration`.
+     */
+    template <typename Unit, typename Rep = double>
     class Length
     {
-            static_assert (std::disjunction_v<
-                           std::is_same<metre, Unit>,
-                           std::is_same<centimetre, Unit>,
-                           std::is_same<millimetre, Unit>,
-                           std::is_same<inch, Unit>,
-                           std::is_same<foot, Unit>>
-                           , "Lenght `Unit` template parameter must be of type length_unit");
+            static_assert (is_length_unit_v<Unit>, "Lenght `Unit` template parameter must be of type length_unit");
 
-            double m_value;
+            Rep m_value;
 
         public:
             using unit = Unit;
-            Unit base_unit = Unit{};
+            using rep  = Rep;
+            static constexpr Unit base_unit = Unit{};
+
+            LENGTH_HOST_DEVICE constexpr Length() : m_value{} {}
+            LENGTH_HOST_DEVICE constexpr explicit Length(Rep val) : m_value{val} {}
 
-            constexpr explicit Length(double val = 0.0) : m_value{val} {}
+            /** Implicit conversion from length in other units and reps wherever it can't truncate,
+             *  e.g. `Length<metre> total = 1_in + 1_mm;`
+             */
+            template <typename Unit2, typename Rep2, std::enable_if_t<detail::is_lossless_conversion_v<Unit2, Rep2, Unit, Rep>, int> = 0>
+            LENGTH_HOST_DEVICE constexpr Length(const Length<Unit2, Rep2>& other);
 
             /** Value of length measured in current units **/
-            [[nodiscard]] constexpr double value() const { return m_value; }
+            [[nodiscard]] LENGTH_HOST_DEVICE constexpr Rep value() const { return m_value; }
+
+            // compound assignment, updating the value in place
+
+            template <typename Unit2, typename Rep2>
+            LENGTH_HOST_DEVICE constexpr Length& operator+= (const Length<Unit2, Rep2>& rhs);
+
+            template <typename Unit2, typename Rep2>
+            LENGTH_HOST_DEVICE constexpr Length& operator-= (const Length<Unit2, Rep2>& rhs);
+
+            LENGTH_HOST_DEVICE constexpr Length& operator*= (const Rep& k) { m_value *= k; return *this; }
+            LENGTH_HOST_DEVICE constexpr Length& operator/= (const Rep& k) { m_value /= k; return *this; }
 
     };
 
+    template <typename T>
+    struct is_length : std::false_type {};
+
+    template <typename Unit, typename Rep>
+    struct is_length<Length<Unit, Rep>> : std::true_type {};
+
+    template <typename T>
+    inline constexpr bool is_length_v = is_length<T>::value;
+
+    // `Length` is guaranteed to have the same layout as its `Rep` value,
+    // so contiguous buffers of values and lengths can be reinterpreted freely
+
+    template <typename Unit, typename Rep = double>
+    inline constexpr bool is_layout_compatible_v = std::is_standard_layout_v<Length<Unit, Rep>> &&
+                                                   std::is_trivially_copyable_v<Length<Unit, Rep>> &&
+                                                   sizeof(Length<Unit, Rep>) == sizeof(Rep) &&
+                                                   alignof(Length<Unit, Rep>) == alignof(Rep);
+
+    static_assert (is_layout_compatible_v<metre>);
+    static_assert (is_layout_compatible_v<centimetre>);
+    static_assert (is_layout_compatible_v<millimetre>);
+    static_assert (is_layout_compatible_v<inch>);
+    static_assert (is_layout_compatible_v<foot>);
+    static_assert (is_layout_compatible_v<nautical_mile>);
+    static_assert (is_layout_compatible_v<millimetre, float>);
+    static_assert (is_layout_compatible_v<millimetre, std::int32_t>);
+    static_assert (is_layout_compatible_v<millimetre, std::int64_t>);
+
+    // Zero overhead beyond layout: trivially copyable and destructible types of
+    // scalar size are passed and returned in registers like `Rep` itself on every
+    // mainstream ABI, and copies compile to plain register moves.
+
+    template <typename Unit, typename Rep = double>
+    inline constexpr bool is_zero_overhead_v = is_layout_compatible_v<Unit, Rep> &&
+                                               std::is_trivially_copy_constructible_v<Length<Unit, Rep>> &&
+                                               std::is_trivially_move_constructible_v<Length<Unit, Rep>> &&
+                                               std::is_trivially_copy_assignable_v<Length<Unit, Rep>> &&
+                                               std::is_trivially_destructible_v<Length<Unit, Rep>>;
+
+    static_assert (is_zero_overhead_v<metre>);
+    static_assert (is_zero_overhead_v<inch, float>);
+    static_assert (is_zero_overhead_v<nautical_mile, std::int64_t>);
+    static_assert (std::is_empty_v<metre> && std::is_empty_v<length_unit<std::milli>>);
+
+    /** Views contiguous buffer of raw values as `Length`s of `Unit` without copying
+     *
+     * @param values - pointer to values measured in units `Unit`
+     * @return - pointer to the same memory viewed as `Length<Unit, Rep>` objects
+     *
+     * @example usage
+     *          1. const Length<millimetre>* lens = as_lengths<millimetre>(sensor_buffer);
+     *          2. std::span<Length<foot, float>> lens = as_lengths<foot>(std::span{values});
+     */
+    template <typename Unit, typename Rep>
+    [[nodiscard]] inline Length<Unit, Rep>* as_lengths(Rep* values) noexcept
+    {
+        return reinterpret_cast<Length<Unit, Rep>*>(values);
+    }
+
+    template <typename Unit, typename Rep>
+    [[nodiscard]] inline const Length<Unit, Rep>* as_lengths(const Rep* values) noexcept
+    {
+        return reinterpret_cast<const Length<Unit, Rep>*>(values);
+    }
+
+    /** Views contiguous buffer of `Length`s as their raw values without copying **/
+    template <typename Unit, typename Rep>
+    [[nodiscard]] inline Rep* as_values(Length<Unit, Rep>* lengths) noexcept
+    {
+        return reinterpret_cast<Rep*>(lengths);
+    }
+
+    template <typename Unit, typename Rep>
+    [[nodiscard]] inline const Rep* as_values(const Length<Unit, Rep>* lengths) noexcept
+    {
+        return reinterpret_cast<const Rep*>(lengths);
+    }
+
+#if defined(__cpp_lib_span)
+    template <typename Unit, typename Rep, std::size_t Extent>
+    [[nodiscard]] inline std::span<Length<Unit, Rep>, Extent> as_lengths(std::span<Rep, Extent> values) noexcept
+    {
+        return std::span<Length<Unit, Rep>, Extent>(as_lengths<Unit>(values.data()), values.size());
+    }
+
+    template <typename Unit, typename Rep, std::size_t Extent>
+    [[nodiscard]] inline std::span<const Length<Unit, Rep>, Extent> as_lengths(std::span<const Rep, Extent> values) noexcept
+    {
+        return std::span<const Length<Unit, Rep>, Extent>(as_lengths<Unit>(values.data()), values.size());
+    }
+
+    template <typename Unit, typename Rep, std::size_t Extent>
+    [[nodiscard]] inline std::span<Rep, Extent> as_values(std::span<Length<Unit, Rep>, Extent> lengths) noexcept
+    {
+        return std::span<Rep, Extent>(as_values(lengths.data()), lengths.size());
+    }
+
+    template <typename Unit, typename Rep, std::size_t Extent>
+    [[nodiscard]] inline std::span<const Rep, Extent> as_values(std::span<const Length<Unit, Rep>, Extent> lengths) noexcept
+    {
+        return std::span<const Rep, Extent>(as_values(lengths.data()), lengths.size());
+    }
+#endif
+
+    namespace detail
+    {
+        template <typename Rep1, typename Rep2>
+        using common_rep_t = std::common_type_t<Rep1, Rep2>;
+
+        /** `std::type_identity_t` of C++20, keeps scalar parameters such as `const type_identity_t<Rep>& k` out of deduction
+         *  so `lengths * 2` works for `double` lengths
+         */
+        template <typename T>
+        struct type_identity { using type = T; };
+
+        template <typename T>
+        using type_identity_t = typename type_identity<T>::type;
+
+        /** Integral `Rep` widened to at least `intmax_t`, rescaling to a common unit multiplies and would overflow narrower reps **/
+        template <typename Rep>
+        using widened_rep_t = std::common_type_t<Rep, std::intmax_t>;
+
+        // scalar `K` may scale `Length` with `Rep` only if it converts to their common type
+        template <typename Rep, typename K, typename = void>
+        struct is_scalar_for : std::false_type {};
+
+        template <typename Rep, typename K>
+        struct is_scalar_for<Rep, K, std::void_t<common_rep_t<Rep, K>>>
+            : std::bool_constant<!is_length_v<K> && std::is_convertible_v<const K&, common_rep_t<Rep, K>>> {};
+
+        template <typename Rep, typename K>
+        using enable_if_scalar_t = std::enable_if_t<is_scalar_for<Rep, K>::value, int>;
+
+        template <typename ToRep, typename Unit, typename Rep>
+        [[nodiscard]] LENGTH_HOST_DEVICE constexpr Length<Unit, ToRep> rep_cast(const Length<Unit, Rep>& length)
+        {
+            return Length<Unit, ToRep>{static_cast<ToRep>(length.value())};
+        }
+    }
+
+#if defined(__cpp_concepts)
+    // C++20 concepts constraining operators and conversions, replacing SFINAE
+    // so overload sets are pruned early and errors name the unmet constraint
+
+    template <typename T>
+    concept LengthUnit = is_length_unit_v<T>;
+
+    template <typename T>
+    concept LengthType = is_length_v<T>;
+
+    template <typename K, typename Rep>
+    concept ScalarFor = detail::is_scalar_for<Rep, K>::value;
+
+#define LENGTH_REQUIRES(...) requires (__VA_ARGS__)
+#define LENGTH_SCALAR_PARAM(Rep, K) ::length::ScalarFor<Rep> K
+#else
+#define LENGTH_REQUIRES(...)
+#define LENGTH_SCALAR_PARAM(Rep, K) typename K, ::length::detail::enable_if_scalar_t<Rep, K> = 0
+#endif
+
+    namespace detail
+    {
+        template <typename FromUnit, typename ToUnit>
+        using conversion_ratio = std::ratio_divide<typename FromUnit::ratio, typename ToUnit::ratio>;
+
+        /** Largest unit both `Unit1` and `Unit2` are whole multiples of
+         *
+         * Converting an integral length to the common unit is a single exact
+         * multiplication, so integral lengths of different units can be
+         * compared without truncation.
+         */
+        template <typename Unit1, typename Unit2>
+        using common_unit_t = length_unit<std::ratio<std::gcd(Unit1::ratio::num, Unit2::ratio::num),
+                                                     std::lcm(Unit1::ratio::den, Unit2::ratio::den)>>;
+
+        /** Common unit of `Unit1` and `Unit2`, preferring one of them when it already is the common unit **/
+        template <typename Unit1, typename Unit2>
+        using common_length_unit_t =
+            std::conditional_t<std::ratio_equal_v<typename Unit1::ratio, typename common_unit_t<Unit1, Unit2>::ratio>, Unit1,
+            std::conditional_t<std::ratio_equal_v<typename Unit2::ratio, typename common_unit_t<Unit1, Unit2>::ratio>, Unit2,
+                               common_unit_t<Unit1, Unit2>>>;
+
+        /** Factor converting values of type `Rep` by `Ratio`, folded at compile time **/
+        template <typename Rep, typename Ratio>
+        inline constexpr Rep conversion_factor = static_cast<Rep>(static_cast<std::common_type_t<Rep, double>>(Ratio::num) /
+                                                                  static_cast<std::common_type_t<Rep, double>>(Ratio::den));
+
+        /** Rescales `value` by `Ratio` with a single operation where possible
+         *
+         *  - identity ratio returns value untouched
+         *  - floating point reps are multiplied by a precomputed factor
+         *  - integral reps use exact integer multiply and/or divide in `intmax_t`
+         */
+        template <typename Ratio, typename Rep>
+        [[nodiscard]] LENGTH_HOST_DEVICE constexpr Rep rescale(Rep value)
+        {
+            if constexpr (Ratio::num == 1 && Ratio::den == 1)
+            {
+                return value;
+            }
+            else if constexpr (std::is_floating_point_v<Rep>)
+            {
+                return value * conversion_factor<Rep, Ratio>;
+            }
+            else if constexpr (std::is_integral_v<Rep>)
+            {
+                using CI = std::common_type_t<Rep, std::intmax_t>;
+                if constexpr (Ratio::den == 1)
+                {
+                    return static_cast<Rep>(static_cast<CI>(value) * static_cast<CI>(Ratio::num));
+                }
+                else if constexpr (Ratio::num == 1)
+                {
+                    return static_cast<Rep>(static_cast<CI>(value) / static_cast<CI>(Ratio::den));
+                }
+                else
+                {
+                    return static_cast<Rep>(static_cast<CI>(value) * static_cast<CI>(Ratio::num) / static_cast<CI>(Ratio::den));
+                }
+            }
+            else
+            {
+                return static_cast<Rep>(value * static_cast<Rep>(Ratio::num) / static_cast<Rep>(Ratio::den));
+            }
+        }
+
+        /** `convert` without instrumentation, for mixed-unit operations that record themselves once **/
+        template <typename FromUnit, typename ToUnit, typename Rep>
+        [[nodiscard]] LENGTH_HOST_DEVICE constexpr Length<ToUnit, Rep> convert_unrecorded(const Length<FromUnit, Rep>& from)
+        {
+            return Length<ToUnit, Rep>{rescale<conversion_ratio<FromUnit, ToUnit>>(from.value())};
+        }
+    }
+
     /** Conversts `Length` of `FromUnit` to `Length` of `ToUnit`
      *
-     * @param Length<FromUnit> from - lenght of unit `FromUnit` being converted
-     * @return - Length<ToUnit> - result of cenversion in units `ToUnit`
+     * Conversion factor is folded at compile time, so converting floating point
+     * length is a single multiplication and converting to the same unit is a no-op.
+     * Integral lengths are converted with exact integer operations (truncating
+     * towards zero when `ToUnit` is coarser than `FromUnit`).
+     *
+     * @param Length<FromUnit, Rep> from - lenght of unit `FromUnit` being converted
+     * @return - Length<ToUnit, Rep> - result of cenversion in units `ToUnit`
      *
      * @example usage
      *          1. Length<meter> lenM = convert<centimetre, metre>(25_cm); // returns 0.25_m
      *          2. Length<foot> lenFt = convert<inch, foot>(24_in); // results in 2_ft
      */
-    template <typename FromUnit, typename ToUnit, template<typename> typename Length>
-    [[nodiscard]] constexpr Length<ToUnit> convert(const Length<FromUnit>& from)
+    template <typename FromUnit, typename ToUnit, typename Rep>
+    LENGTH_REQUIRES(LengthUnit<ToUnit>)
+    [[nodiscard]] LENGTH_HOST_DEVICE constexpr Length<ToUnit, Rep> convert(const Length<FromUnit, Rep>& from)
     {
-        using r = std::ratio_divide<typename FromUnit::ratio, typename ToUnit::ratio>;
-        return Length<ToUnit>{from.value() * static_cast<double>(r::ratio::num) /
-                                             static_cast<double>(r::ratio::den)};
+        LENGTH_INSTRUMENT(conversion, FromUnit, ToUnit, 1);
+        return detail::convert_unrecorded<FromUnit, ToUnit>(from);
+    }
+
+    namespace detail
+    {
+        /** Values of two lengths brought to one rep and unit for comparison **/
+        template <typename Rep>
+        struct compared_values
+        {
+                Rep lhs;
+                Rep rhs;
+        };
+
+        /** Floating point `rhs` is converted to `Unit1`, integral lengths go to their common unit exactly (in `intmax_t`) **/
+        template <typename Unit1, typename Rep1, typename Unit2, typename Rep2>
+        [[nodiscard]] LENGTH_HOST_DEVICE constexpr auto comparable(const Length<Unit1, Rep1>& lhs, const Length<Unit2, Rep2>& rhs)
+        {
+            using CR = common_rep_t<Rep1, Rep2>;
+            LENGTH_INSTRUMENT(mixed_comparison, Unit2, Unit1, 1);
+            if constexpr (std::is_same_v<Unit1, Unit2>)
+            {
+                return compared_values<CR>{static_cast<CR>(lhs.value()), static_cast<CR>(rhs.value())};
+            }
+            else if constexpr (std::is_integral_v<CR>)
+            {
+                using CU = common_unit_t<Unit1, Unit2>;
+                using WR = widened_rep_t<CR>;
+                return compared_values<WR>{convert_unrecorded<Unit1, CU>(rep_cast<WR>(lhs)).value(), convert_unrecorded<Unit2, CU>(rep_cast<WR>(rhs)).value()};
+            }
+            else
+            {
+                return compared_values<CR>{static_cast<CR>(lhs.value()), convert_unrecorded<Unit2, Unit1>(rep_cast<CR>(rhs)).value()};
+            }
+        }
+
+        /** Rounding of a search key converted to the element unit **/
+        enum class key_rounding { up, down };
+
+        /** `key` as value in `Unit`, element `e` satisfies `e < key` iff `e.value() < result` for `key_rounding::up`
+         *  and `e > key` iff `e.value() > result` for `key_rounding::down`; used by sorted searches and
+         *  bulk threshold counts, integral keys are floor/ceil divided in the common unit
+         */
+        template <typename Unit, typename Rep, key_rounding Rounding, typename Unit2, typename Rep2>
+        [[nodiscard]] constexpr common_rep_t<Rep, Rep2> search_key(const Length<Unit2, Rep2>& key)
+        {
+            using CR = common_rep_t<Rep, Rep2>;
+            if constexpr (std::is_same_v<Unit, Unit2> || !std::is_integral_v<CR>)
+            {
+                return convert<Unit2, Unit>(rep_cast<CR>(key)).value();
+            }
+            else
+            {
+                // element * a < key * b in the common unit, a and b are whole numbers
+                using CU = common_unit_t<Unit, Unit2>;
+                using WR = widened_rep_t<CR>;
+                constexpr WR a = static_cast<WR>(conversion_ratio<Unit, CU>::num);
+                const WR k = convert<Unit2, CU>(rep_cast<WR>(key)).value();
+                const WR q = k / a;
+                const WR r = k % a;
+                if constexpr (Rounding == key_rounding::up)
+                {
+                    return static_cast<CR>(r > 0 ? q + 1 : q);
+                }
+                else
+                {
+                    return static_cast<CR>(r < 0 ? q - 1 : q);
+                }
+            }
+        }
     }
 
     /** Compares lhs `Length` in units `Unit1` to rsh `Length` in units `Unit2`
      *  by converting rhs to Unit1 first and then comparing values.
+     *  Integral lengths are compared exactly in their common unit instead.
      *
      * @param lhs - lenght of unit `Unit1` being converted
      * @param rhs - lenght of unit `Unit2` being converted
@@ -97,95 +497,235 @@ namespace length
      *          1. Length<meter> lenM = convert<centimetre, metre>(25_cm); // returns 0.25_m
      *          2. Length<foot> lenFt = convert<inch, foot>(24_in); // results in 2_ft
      */
-    template <typename Unit1, typename Unit2, template<typename> typename Length>
-    [[nodiscard]] constexpr bool operator==(const Length<Unit1>& lhs, const Length<Unit2>& rhs)
+    template <typename Unit1, typename Rep1, typename Unit2, typename Rep2>
+    [[nodiscard]] LENGTH_HOST_DEVICE constexpr bool operator==(const Length<Unit1, Rep1>& lhs, const Length<Unit2, Rep2>& rhs)
     {
-        if constexpr (std::is_same_v<Unit1, Unit2>)
-        {
-            return lhs.value() == rhs.value();
-        }
-        return lhs.value() == convert<Unit2, Unit1>(rhs).value();
+        const auto v = detail::comparable(lhs, rhs);
+        return v.lhs == v.rhs;
+    }
+
+    // ordering, same conversion as `operator==`, so a mixed-unit comparison is a multiplication and a compare
+
+    template <typename Unit1, typename Rep1, typename Unit2, typename Rep2>
+    [[nodiscard]] LENGTH_HOST_DEVICE constexpr bool operator!=(const Length<Unit1, Rep1>& lhs, const Length<Unit2, Rep2>& rhs) { return !(lhs == rhs); }
+
+    template <typename Unit1, typename Rep1, typename Unit2, typename Rep2>
+    [[nodiscard]] LENGTH_HOST_DEVICE constexpr bool operator< (const Length<Unit1, Rep1>& lhs, const Length<Unit2, Rep2>& rhs)
+    {
+        const auto v = detail::comparable(lhs, rhs);
+        return v.lhs < v.rhs;
+    }
+
+    template <typename Unit1, typename Rep1, typename Unit2, typename Rep2>
+    [[nodiscard]] LENGTH_HOST_DEVICE constexpr bool operator<=(const Length<Unit1, Rep1>& lhs, const Length<Unit2, Rep2>& rhs)
+    {
+        const auto v = detail::comparable(lhs, rhs);
+        return v.lhs <= v.rhs;
+    }
+
+    template <typename Unit1, typename Rep1, typename Unit2, typename Rep2>
+    [[nodiscard]] LENGTH_HOST_DEVICE constexpr bool operator> (const Length<Unit1, Rep1>& lhs, const Length<Unit2, Rep2>& rhs)
+    {
+        const auto v = detail::comparable(lhs, rhs);
+        return v.lhs > v.rhs;
+    }
+
+    template <typename Unit1, typename Rep1, typename Unit2, typename Rep2>
+    [[nodiscard]] LENGTH_HOST_DEVICE constexpr bool operator>=(const Length<Unit1, Rep1>& lhs, const Length<Unit2, Rep2>& rhs)
+    {
+        const auto v = detail::comparable(lhs, rhs);
+        return v.lhs >= v.rhs;
+    }
+
+#if defined(__cpp_lib_three_way_comparison)
+    /** Three-way comparison, `std::partial_ordering` for floating point reps and `std::strong_ordering` for integral ones **/
+    template <typename Unit1, typename Rep1, typename Unit2, typename Rep2>
+    [[nodiscard]] LENGTH_HOST_DEVICE constexpr auto operator<=>(const Length<Unit1, Rep1>& lhs, const Length<Unit2, Rep2>& rhs)
+    {
+        const auto v = detail::comparable(lhs, rhs);
+        return v.lhs <=> v.rhs;
     }
+#endif
 
-    // addition
+    // addition and substraction
+    //
+    // Mixed-unit result is in units of the left operand, or with `LENGTH_COMMON_UNIT_ARITHMETIC`
+    // defined (consistently in the whole program) in their common unit, like `std::chrono::duration`,
+    // so chains such as `1_in + 1_mm + 1_in` never rescale back and forth and are converted
+    // once, on assignment to the final unit.
 
-    template<typename Unit1, typename Unit2, template<typename> typename Length>
-    [[nodiscard]] constexpr Length<Unit1> operator+ (Length<Unit1>&& lhs, Length<Unit2>&& rhs) { return Length<Unit1> { lhs.value() + convert<Unit2, Unit1>(rhs).value() }; }
+    namespace detail
+    {
+        template <typename Unit1, typename Rep1, typename Unit2, typename Rep2>
+        using additive_result_t =
+#if defined(LENGTH_COMMON_UNIT_ARITHMETIC)
+            Length<common_length_unit_t<Unit1, Unit2>, common_rep_t<Rep1, Rep2>>;
+#else
+            Length<Unit1, common_rep_t<Rep1, Rep2>>;
+#endif
+    }
 
-    template<typename Unit> // spacialization for same units
-    [[nodiscard]] constexpr Length<Unit> operator+ (Length<Unit>&& lhs, Length<Unit>&& rhs) { return Length<Unit> { lhs.value() + rhs.value() }; }
+    template<typename Unit1, typename Rep1, typename Unit2, typename Rep2>
+    [[nodiscard]] LENGTH_HOST_DEVICE constexpr detail::additive_result_t<Unit1, Rep1, Unit2, Rep2> operator+ (Length<Unit1, Rep1> lhs, Length<Unit2, Rep2> rhs)
+    {
+        LENGTH_INSTRUMENT(mixed_arithmetic, Unit2, Unit1, 1);
+        using CR = detail::common_rep_t<Rep1, Rep2>;
+        using R  = detail::additive_result_t<Unit1, Rep1, Unit2, Rep2>;
+        return R { detail::convert_unrecorded<Unit1, typename R::unit>(detail::rep_cast<CR>(lhs)).value() + detail::convert_unrecorded<Unit2, typename R::unit>(detail::rep_cast<CR>(rhs)).value() };
+    }
 
-    // substraction
+    template<typename Unit, typename Rep1, typename Rep2> // spacialization for same units
+    [[nodiscard]] LENGTH_HOST_DEVICE constexpr Length<Unit, detail::common_rep_t<Rep1, Rep2>> operator+ (Length<Unit, Rep1> lhs, Length<Unit, Rep2> rhs)
+    {
+        using CR = detail::common_rep_t<Rep1, Rep2>;
+        return Length<Unit, CR> { static_cast<CR>(lhs.value()) + static_cast<CR>(rhs.value()) };
+    }
 
-    template<typename Units1, typename Units2, template<typename> typename Length>
-    [[nodiscard]] constexpr Length<Units1> operator- (Length<Units1>&& lhs, Length<Units2>&& rhs) { return Length<Units1> { lhs.value() - convert<Units2, Units1>(rhs).value() }; }
+    template<typename Units1, typename Rep1, typename Units2, typename Rep2>
+    [[nodiscard]] LENGTH_HOST_DEVICE constexpr detail::additive_result_t<Units1, Rep1, Units2, Rep2> operator- (Length<Units1, Rep1> lhs, Length<Units2, Rep2> rhs)
+    {
+        LENGTH_INSTRUMENT(mixed_arithmetic, Units2, Units1, 1);
+        using CR = detail::common_rep_t<Rep1, Rep2>;
+        using R  = detail::additive_result_t<Units1, Rep1, Units2, Rep2>;
+        return R { detail::convert_unrecorded<Units1, typename R::unit>(detail::rep_cast<CR>(lhs)).value() - detail::convert_unrecorded<Units2, typename R::unit>(detail::rep_cast<CR>(rhs)).value() };
+    }
 
-    template<typename Units> // spacialization for same units
-    [[nodiscard]] constexpr Length<Units> operator- (Length<Units>&& lhs, Length<Units>&& rhs) { return Length<Units> { lhs.value() - rhs.value() }; }
+    template<typename Units, typename Rep1, typename Rep2> // spacialization for same units
+    [[nodiscard]] LENGTH_HOST_DEVICE constexpr Length<Units, detail::common_rep_t<Rep1, Rep2>> operator- (Length<Units, Rep1> lhs, Length<Units, Rep2> rhs)
+    {
+        using CR = detail::common_rep_t<Rep1, Rep2>;
+        return Length<Units, CR> { static_cast<CR>(lhs.value()) - static_cast<CR>(rhs.value()) };
+    }
 
     // multiplication
 
-    template <typename Units, template<typename> typename Length>
-    [[nodiscard]] constexpr Length<Units> operator* (double k, Length<Units>&& length) { return Length<Units> { k * length.value()}; }
+    template <typename Units, typename Rep, LENGTH_SCALAR_PARAM(Rep, K)>
+    [[nodiscard]] LENGTH_HOST_DEVICE constexpr Length<Units, detail::common_rep_t<Rep, K>> operator* (const K& k, Length<Units, Rep> length)
+    {
+        using CR = detail::common_rep_t<Rep, K>;
+        return Length<Units, CR> { static_cast<CR>(k) * static_cast<CR>(length.value())};
+    }
 
-    template <typename Units, template<typename> typename Length>
-    [[nodiscard]] constexpr Length<Units> operator* (Length<Units>&& length, double k) { return Length<Units> { k * length.value()}; }
+    template <typename Units, typename Rep, LENGTH_SCALAR_PARAM(Rep, K)>
+    [[nodiscard]] LENGTH_HOST_DEVICE constexpr Length<Units, detail::common_rep_t<Rep, K>> operator* (Length<Units, Rep> length, const K& k)
+    {
+        using CR = detail::common_rep_t<Rep, K>;
+        return Length<Units, CR> { static_cast<CR>(k) * static_cast<CR>(length.value())};
+    }
 
     // division
 
-    template <typename Units, template<typename> typename Length>
-    [[nodiscard]] constexpr Length<Units> operator/ (Length<Units> length, double k) { return Length<Units> { length.value() / k}; }
+    template <typename Units, typename Rep, LENGTH_SCALAR_PARAM(Rep, K)>
+    [[nodiscard]] LENGTH_HOST_DEVICE constexpr Length<Units, detail::common_rep_t<Rep, K>> operator/ (Length<Units, Rep> length, const K& k)
+    {
+        using CR = detail::common_rep_t<Rep, K>;
+        return Length<Units, CR> { static_cast<CR>(length.value()) / static_cast<CR>(k)};
+    }
+
+    template<typename Units1, typename Rep1, typename Units2, typename Rep2>
+    [[nodiscard]] LENGTH_HOST_DEVICE constexpr detail::common_rep_t<Rep1, Rep2> operator/ (Length<Units1, Rep1> lhs, Length<Units2, Rep2> rhs)
+    {
+        using CR = detail::common_rep_t<Rep1, Rep2>;
+        if constexpr (!std::ratio_equal_v<detail::conversion_ratio<Units2, Units1>, std::ratio<1>>)
+        {
+            LENGTH_INSTRUMENT(mixed_arithmetic, Units2, Units1, 1);
+        }
+        if constexpr (std::is_integral_v<CR>)
+        {
+            // both in their common unit, so `rhs` isn't truncated (possibly to zero) in units of `lhs`,
+            // widened first as scaling up to it overflows e.g. `int32_t` inches against nanometres
+            using CU = detail::common_unit_t<Units1, Units2>;
+            using WR = detail::widened_rep_t<CR>;
+            return static_cast<CR>(detail::convert_unrecorded<Units1, CU>(detail::rep_cast<WR>(lhs)).value() /
+                                   detail::convert_unrecorded<Units2, CU>(detail::rep_cast<WR>(rhs)).value());
+        }
+        else
+        {
+            return static_cast<CR>(lhs.value()) / detail::convert_unrecorded<Units2, Units1>(detail::rep_cast<CR>(rhs)).value();
+        }
+    }
 
-    template<typename Units1, typename Units2, template<typename> typename Length>
-    [[nodiscard]] constexpr double operator/ (Length<Units1>&& lhs, Length<Units2>&& rhs) { return lhs.value() / convert<Units2, Units1>(rhs).value(); }
+    // converting constructor
+
+    template <typename Unit, typename Rep>
+    template <typename Unit2, typename Rep2, std::enable_if_t<detail::is_lossless_conversion_v<Unit2, Rep2, Unit, Rep>, int>>
+    LENGTH_HOST_DEVICE constexpr Length<Unit, Rep>::Length(const Length<Unit2, Rep2>& other)
+        : m_value{static_cast<Rep>(convert<Unit2, Unit>(detail::rep_cast<detail::common_rep_t<Rep, Rep2>>(other)).value())}
+    {}
+
+    // compound assignment, always in units of the left operand
+
+    template <typename Unit, typename Rep>
+    template <typename Unit2, typename Rep2>
+    LENGTH_HOST_DEVICE constexpr Length<Unit, Rep>& Length<Unit, Rep>::operator+= (const Length<Unit2, Rep2>& rhs)
+    {
+        LENGTH_INSTRUMENT(mixed_arithmetic, Unit2, Unit, 1);
+        using CR = detail::common_rep_t<Rep, Rep2>;
+        m_value = static_cast<Rep>(static_cast<CR>(m_value) + detail::convert_unrecorded<Unit2, Unit>(detail::rep_cast<CR>(rhs)).value());
+        return *this;
+    }
+
+    template <typename Unit, typename Rep>
+    template <typename Unit2, typename Rep2>
+    LENGTH_HOST_DEVICE constexpr Length<Unit, Rep>& Length<Unit, Rep>::operator-= (const Length<Unit2, Rep2>& rhs)
+    {
+        LENGTH_INSTRUMENT(mixed_arithmetic, Unit2, Unit, 1);
+        using CR = detail::common_rep_t<Rep, Rep2>;
+        m_value = static_cast<Rep>(static_cast<CR>(m_value) - detail::convert_unrecorded<Unit2, Unit>(detail::rep_cast<CR>(rhs)).value());
+        return *this;
+    }
+
+}
+
+namespace std
+{
+    /** Lengths have common type in their common unit and rep, like `std::chrono::duration`, so generic code
+     *  e.g. `std::common_type_t<Length<inch>, Length<millimetre>>` gets unit both convert to exactly
+     */
+    template <typename Unit1, typename Rep1, typename Unit2, typename Rep2>
+    struct common_type<length::Length<Unit1, Rep1>, length::Length<Unit2, Rep2>>
+    {
+        using type = length::Length<length::detail::common_length_unit_t<Unit1, Unit2>, common_type_t<Rep1, Rep2>>;
+    };
+}
+
+namespace length
+{
 
     //////////////////////////////////
 
     inline
     namespace literals {
-        constexpr auto operator"" _m  (long double m)  { return Length<metre>{static_cast<double>(m)}; }
-        constexpr auto operator"" _m  (unsigned long long m)  { return Length<metre>{static_cast<double>(m)}; }
-
-        constexpr auto operator"" _cm (unsigned long long cm) { return Length<centimetre>{static_cast<double>(cm)}; }
-        constexpr auto operator"" _cm (long double cm) { return Length<centimetre>{static_cast<double>(cm)}; }
-
-        constexpr auto operator"" _mm (long double mm) { return Length<millimetre>{static_cast<double>(mm)}; }
-        constexpr auto operator"" _mm (unsigned long long mm) { return Length<millimetre>{static_cast<double>(mm)}; }
-
-        constexpr auto operator"" _in (unsigned long long in) { return Length<inch>{static_cast<double>(in)}; }
-        constexpr auto operator"" _in (long double in) { return Length<inch>{static_cast<double>(in)}; }
-
-        constexpr auto operator"" _ft (long double ft) { return Length<foot>{static_cast<double>(ft)}; }
-        constexpr auto operator"" _ft (unsigned long long ft) { return Length<foot>{static_cast<double>(ft)}; }
-    }
-
-    //////////////////
-    // test
-    //////////////////
-
-    // literals
-    static_assert (1_m == 100_cm);
-    static_assert (1_m == 100_cm);
-    // static_assert (1_m == 200_cm);
-    static_assert (12_in == 1_ft);
-    static_assert (1_ft == 12_in);
-    static_assert (250_cm == 2.5_m);
-
-    // direct object instantiation
-    static_assert (Length<metre>{2.5} == Length<centimetre>{250});
-    static_assert (Length<foot>{3} == Length<inch>{36_in});
-    static_assert (Length<millimetre>{2} == Length<centimetre>{0.2});
-    static_assert (2_m == convert<centimetre, millimetre>(200_cm));
-    static_assert (Length<millimetre>{2} == convert<centimetre, metre>(Length<centimetre>{0.2}));
-    static_assert (1_m == Length<inch>{1 / 0.0254});
-
-    // operations
-    static_assert ( 4 * 1_m == 50_cm * 8.0);
-    static_assert ( 2_mm * 10 == 0.5 * 4_cm);
-    static_assert ( 2_mm * 10 == 4_cm / 2);
-    static_assert ( 200_mm + 3_m / 6 == 2 * 10_cm + 50_cm / 1.0);
-    static_assert ( 2_m / 2 == 1_in / 0.0254);
-    static_assert ( ((2* 5_m + 10_m) / 200_cm * 1_m).value() == 10.0);
+        LENGTH_HOST_DEVICE constexpr auto operator"" _m  (long double m)  { return Length<metre>{static_cast<double>(m)}; }
+        LENGTH_HOST_DEVICE constexpr auto operator"" _m  (unsigned long long m)  { return Length<metre>{static_cast<double>(m)}; }
+
+        LENGTH_HOST_DEVICE constexpr auto operator"" _cm (unsigned long long cm) { return Length<centimetre>{static_cast<double>(cm)}; }
+        LENGTH_HOST_DEVICE constexpr auto operator"" _cm (long double cm) { return Length<centimetre>{static_cast<double>(cm)}; }
+
+        LENGTH_HOST_DEVICE constexpr auto operator"" _mm (long double mm) { return Length<millimetre>{static_cast<double>(mm)}; }
+        LENGTH_HOST_DEVICE constexpr auto operator"" _mm (unsigned long long mm) { return Length<millimetre>{static_cast<double>(mm)}; }
+
+        LENGTH_HOST_DEVICE constexpr auto operator"" _in (unsigned long long in) { return Length<inch>{static_cast<double>(in)}; }
+        LENGTH_HOST_DEVICE constexpr auto operator"" _in (long double in) { return Length<inch>{static_cast<double>(in)}; }
+
+        LENGTH_HOST_DEVICE constexpr auto operator"" _ft (long double ft) { return Length<foot>{static_cast<double>(ft)}; }
+        LENGTH_HOST_DEVICE constexpr auto operator"" _ft (unsigned long long ft) { return Length<foot>{static_cast<double>(ft)}; }
+
+        LENGTH_HOST_DEVICE constexpr auto operator"" _um (long double um) { return Length<micrometre>{static_cast<double>(um)}; }
+        LENGTH_HOST_DEVICE constexpr auto operator"" _um (unsigned long long um) { return Length<micrometre>{static_cast<double>(um)}; }
+
+        LENGTH_HOST_DEVICE constexpr auto operator"" _nm (long double nm) { return Length<nanometre>{static_cast<double>(nm)}; }
+        LENGTH_HOST_DEVICE constexpr auto operator"" _nm (unsigned long long nm) { return Length<nanometre>{static_cast<double>(nm)}; }
+
+        LENGTH_HOST_DEVICE constexpr auto operator"" _yd (long double yd) { return Length<yard>{static_cast<double>(yd)}; }
+        LENGTH_HOST_DEVICE constexpr auto operator"" _yd (unsigned long long yd) { return Length<yard>{static_cast<double>(yd)}; }
+
+        LENGTH_HOST_DEVICE constexpr auto operator"" _mi (long double mi) { return Length<mile>{static_cast<double>(mi)}; }
+        LENGTH_HOST_DEVICE constexpr auto operator"" _mi (unsigned long long mi) { return Length<mile>{static_cast<double>(mi)}; }
+
+        LENGTH_HOST_DEVICE constexpr auto operator"" _nmi (long double nmi) { return Length<nautical_mile>{static_cast<double>(nmi)}; }
+        LENGTH_HOST_DEVICE constexpr auto operator"" _nmi (unsigned long long nmi) { return Length<nautical_mile>{static_cast<double>(nmi)}; }
+    }
 }
 
 
@@ -0,0 +1,532 @@
+/*********************************************************************************
+ *
+ *  MIT License
+ *
+ *  Copyright (c) 2017 Nenad Zikic
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ *********************************************************************************/
+
+
+#pragma once
+
+#include "length.hpp"
+#include "bulk.hpp"
+#include "simd.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <initializer_list>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#if __has_include(<memory_resource>)
+#include <memory_resource>
+#endif
+
+
+namespace length
+{
+
+    template <typename Unit, typename Rep, typename Allocator>
+    class LengthArray;
+
+    /** Non-owning read-only view of contiguous lengths of `Unit`, e.g. part of `LengthArray` **/
+    template <typename Unit, typename Rep = double>
+    class LengthArrayView
+    {
+            const Length<Unit, Rep>* m_data = nullptr;
+            std::size_t              m_size = 0;
+
+        public:
+            using unit           = Unit;
+            using rep            = Rep;
+            using value_type     = Length<Unit, Rep>;
+            using size_type      = std::size_t;
+            using const_iterator = const value_type*;
+            using iterator       = const_iterator;
+
+            constexpr LengthArrayView() = default;
+            constexpr LengthArrayView(const value_type* data, size_type size) : m_data{data}, m_size{size} {}
+
+            [[nodiscard]] constexpr const value_type* data()   const { return m_data; }
+            [[nodiscard]] constexpr const Rep*        values() const { return as_values(m_data); }
+            [[nodiscard]] constexpr size_type         size()   const { return m_size; }
+            [[nodiscard]] constexpr bool              empty()  const { return m_size == 0; }
+
+            [[nodiscard]] constexpr const value_type& operator[](size_type i) const { return m_data[i]; }
+
+            [[nodiscard]] constexpr const_iterator begin() const { return m_data; }
+            [[nodiscard]] constexpr const_iterator end()   const { return m_data + m_size; }
+
+            /** View of `count` lengths starting at `offset` **/
+            [[nodiscard]] constexpr LengthArrayView subview(size_type offset, size_type count) const
+            {
+                return LengthArrayView{m_data + offset, count};
+            }
+
+#if defined(__cpp_lib_span)
+            [[nodiscard]] constexpr operator std::span<const value_type>() const { return {m_data, m_size}; }
+#endif
+    };
+
+    namespace detail
+    {
+        /** Alignment of `LengthArray` buffers, one cache line and the widest SIMD register **/
+        inline constexpr std::size_t array_alignment = 64;
+
+        /** Unit of `LengthArray` allocation, allocators are rebound to it so every buffer is 64-byte aligned **/
+        struct alignas(array_alignment) value_block
+        {
+            unsigned char bytes[array_alignment];
+        };
+
+        template <typename Rep>
+        [[nodiscard]] constexpr std::size_t blocks_for(std::size_t n) { return (n * sizeof(Rep) + array_alignment - 1) / array_alignment; }
+
+        template <typename Rep>
+        [[nodiscard]] constexpr std::size_t values_in(std::size_t blocks) { return blocks * array_alignment / sizeof(Rep); }
+
+        /** `out = a +- convert<FromUnit, ToUnit>(b)` over `n` values, same as `Length` operators element-wise;
+         *  throws `std::length_error` if `b` doesn't hold `n` values as well
+         */
+        template <typename FromUnit, typename ToUnit, typename Rep>
+        void add_scaled_n(const Rep* a, const Rep* b, Rep* out, std::size_t n, std::size_t b_size, bool subtract)
+        {
+            if (n != b_size)
+            {
+                throw std::length_error("length: `LengthArray` operands must have the same size");
+            }
+            using r = conversion_ratio<FromUnit, ToUnit>;
+            LENGTH_INSTRUMENT(mixed_arithmetic, FromUnit, ToUnit, n);
+            if constexpr (std::is_floating_point_v<Rep>)
+            {
+                const Rep k = conversion_factor<Rep, r>;
+                simd::detail::add_scaled(a, b, subtract ? -k : k, out, n);
+            }
+            else
+            {
+                for (std::size_t i = 0; i < n; ++i)
+                {
+                    out[i] = subtract ? static_cast<Rep>(a[i] - rescale<r>(b[i])) : static_cast<Rep>(a[i] + rescale<r>(b[i]));
+                }
+            }
+        }
+
+        template <typename Rep>
+        void divide_n(const Rep* in, Rep* out, std::size_t n, Rep k)
+        {
+            if constexpr (std::is_floating_point_v<Rep>)
+            {
+                simd::detail::divide(in, out, n, k);
+            }
+            else
+            {
+                for (std::size_t i = 0; i < n; ++i)
+                {
+                    out[i] = static_cast<Rep>(in[i] / k);
+                }
+            }
+        }
+    }
+
+
+    /** Contiguous container of lengths in `Unit`, owning 64-byte aligned buffer of raw `Rep` values
+     *
+     * Bulk arithmetic and conversion run over the whole buffer with SIMD kernels.
+     * Memory comes from `Allocator` rebound to 64-byte blocks, so standard, pool and
+     * `std::pmr` allocators all give aligned buffers; see `pmr::LengthArray` and `arena.hpp`.
+     *
+     * @example usage
+     *          1. LengthArray<inch> cad(1000);
+     *             LengthArray<metre> metres = std::move(cad).convert_to<metre>(); // in place, no allocation
+     *          2. LengthArray<millimetre> d = a + b * 2.0;
+     */
+    template <typename Unit, typename Rep = double, typename Allocator = std::allocator<Rep>>
+    class LengthArray
+    {
+            static_assert (std::is_trivially_copyable_v<Rep>, "`LengthArray` `Rep` must be trivially copyable");
+            static_assert (sizeof(Rep) <= detail::array_alignment, "`LengthArray` `Rep` must fit in a cache line");
+
+            template <typename, typename, typename>
+            friend class LengthArray;
+
+            using block_allocator = typename std::allocator_traits<Allocator>::template rebind_alloc<detail::value_block>;
+            using block_traits    = std::allocator_traits<block_allocator>;
+
+            static_assert (std::is_pointer_v<typename block_traits::pointer>, "`LengthArray` needs allocator returning raw pointers");
+
+            block_allocator m_allocator;
+            Rep*            m_values   = nullptr;
+            std::size_t     m_size     = 0;
+            std::size_t     m_capacity = 0;
+
+            /** Allocates room for at least `n` values, `n` becomes their real number **/
+            [[nodiscard]] Rep* allocate(std::size_t& n)
+            {
+                if (n == 0) return nullptr;
+                const std::size_t blocks = detail::blocks_for<Rep>(n);
+                detail::value_block* values = block_traits::allocate(m_allocator, blocks);
+                n = detail::values_in<Rep>(blocks);
+                return reinterpret_cast<Rep*>(values);
+            }
+
+            void deallocate() noexcept
+            {
+                if (m_values != nullptr)
+                {
+                    block_traits::deallocate(m_allocator, reinterpret_cast<detail::value_block*>(m_values), detail::blocks_for<Rep>(m_capacity));
+                }
+                m_values   = nullptr;
+                m_size     = 0;
+                m_capacity = 0;
+            }
+
+            /** Drops current buffer and takes buffer of `other`, allocators must be equal **/
+            template <typename Unit2>
+            void steal(LengthArray<Unit2, Rep, Allocator>& other) noexcept
+            {
+                deallocate();
+                m_values   = std::exchange(other.m_values, nullptr);
+                m_size     = std::exchange(other.m_size, 0);
+                m_capacity = std::exchange(other.m_capacity, 0);
+            }
+
+            /** Replaces contents with `view`, reusing buffer when it is large enough **/
+            void assign(LengthArrayView<Unit, Rep> view)
+            {
+                if (view.size() > m_capacity)
+                {
+                    std::size_t capacity = view.size();
+                    Rep* values = allocate(capacity);
+                    deallocate();
+                    m_values   = values;
+                    m_capacity = capacity;
+                }
+                if (view.values() != m_values)
+                {
+                    std::copy_n(view.values(), view.size(), m_values);
+                }
+                m_size = view.size();
+            }
+
+            [[nodiscard]] Allocator copy_allocator() const { return Allocator(block_traits::select_on_container_copy_construction(m_allocator)); }
+
+        public:
+            using unit            = Unit;
+            using rep             = Rep;
+            using allocator_type  = Allocator;
+            using value_type      = Length<Unit, Rep>;
+            using size_type       = std::size_t;
+            using reference       = value_type&;
+            using const_reference = const value_type&;
+            using iterator        = value_type*;
+            using const_iterator  = const value_type*;
+
+            static constexpr std::size_t alignment = detail::array_alignment;
+
+            LengthArray() = default;
+
+            explicit LengthArray(const Allocator& allocator) noexcept : m_allocator{allocator} {}
+
+            explicit LengthArray(size_type n, value_type fill = value_type{}, const Allocator& allocator = Allocator{})
+                : m_allocator{allocator}, m_size{n}, m_capacity{n}
+            {
+                m_values = allocate(m_capacity);
+                std::fill_n(data(), n, fill);
+            }
+
+            LengthArray(std::initializer_list<value_type> init, const Allocator& allocator = Allocator{})
+                : LengthArray(LengthArrayView<Unit, Rep>{init.begin(), init.size()}, allocator)
+            {}
+
+            explicit LengthArray(LengthArrayView<Unit, Rep> view, const Allocator& allocator = Allocator{})
+                : m_allocator{allocator}
+            {
+                assign(view);
+            }
+
+            LengthArray(const LengthArray& other) : LengthArray(other.view(), other.copy_allocator()) {}
+
+            LengthArray(const LengthArray& other, const Allocator& allocator) : LengthArray(other.view(), allocator) {}
+
+            LengthArray(LengthArray&& other) noexcept
+                : m_allocator{other.m_allocator},
+                  m_values{std::exchange(other.m_values, nullptr)},
+                  m_size{std::exchange(other.m_size, 0)},
+                  m_capacity{std::exchange(other.m_capacity, 0)}
+            {}
+
+            LengthArray& operator= (const LengthArray& other)
+            {
+                if (this != &other)
+                {
+                    if constexpr (block_traits::propagate_on_container_copy_assignment::value)
+                    {
+                        if (m_allocator != other.m_allocator)
+                        {
+                            deallocate();
+                        }
+                        m_allocator = other.m_allocator;
+                    }
+                    assign(other.view());
+                }
+                return *this;
+            }
+
+            LengthArray& operator= (LengthArray&& other) noexcept(block_traits::propagate_on_container_move_assignment::value ||
+                                                                 block_traits::is_always_equal::value)
+            {
+                if (this == &other)
+                {
+                    return *this;
+                }
+                if constexpr (block_traits::propagate_on_container_move_assignment::value)
+                {
+                    deallocate();
+                    m_allocator = std::move(other.m_allocator);
+                    steal(other);
+                }
+                else if (m_allocator == other.m_allocator)
+                {
+                    steal(other);
+                }
+                else
+                {
+                    // different memory resources, buffer can't change owner
+                    assign(other.view());
+                    other.clear();
+                }
+                return *this;
+            }
+
+            ~LengthArray() { deallocate(); }
+
+            void swap(LengthArray& other) noexcept
+            {
+                using std::swap;
+                if constexpr (block_traits::propagate_on_container_swap::value)
+                {
+                    swap(m_allocator, other.m_allocator);
+                }
+                else
+                {
+                    assert (m_allocator == other.m_allocator && "swapped `LengthArray`s must use equal allocators");
+                }
+                swap(m_values, other.m_values);
+                swap(m_size, other.m_size);
+                swap(m_capacity, other.m_capacity);
+            }
+
+            [[nodiscard]] allocator_type get_allocator() const { return allocator_type(m_allocator); }
+
+            // element access
+
+            [[nodiscard]] value_type*       data()         { return as_lengths<Unit>(m_values); }
+            [[nodiscard]] const value_type* data()   const { return as_lengths<Unit>(static_cast<const Rep*>(m_values)); }
+            [[nodiscard]] Rep*              values()       { return m_values; }
+            [[nodiscard]] const Rep*        values() const { return m_values; }
+
+            [[nodiscard]] reference       operator[](size_type i)       { return data()[i]; }
+            [[nodiscard]] const_reference operator[](size_type i) const { return data()[i]; }
+
+            [[nodiscard]] iterator       begin()       { return data(); }
+            [[nodiscard]] iterator       end()         { return data() + m_size; }
+            [[nodiscard]] const_iterator begin() const { return data(); }
+            [[nodiscard]] const_iterator end()   const { return data() + m_size; }
+
+            [[nodiscard]] LengthArrayView<Unit, Rep> view() const { return {data(), m_size}; }
+            [[nodiscard]] operator LengthArrayView<Unit, Rep>() const { return view(); }
+
+#if defined(__cpp_lib_span)
+            [[nodiscard]] operator std::span<value_type>()             { return {data(), m_size}; }
+            [[nodiscard]] operator std::span<const value_type>() const { return {data(), m_size}; }
+#endif
+
+            // capacity
+
+            [[nodiscard]] size_type size()     const { return m_size; }
+            [[nodiscard]] size_type capacity() const { return m_capacity; }
+            [[nodiscard]] bool      empty()    const { return m_size == 0; }
+
+            /** Makes room for `n` lengths, capacity is rounded up to whole 64-byte blocks **/
+            void reserve(size_type n)
+            {
+                if (n <= m_capacity) return;
+                Rep* values = allocate(n);
+                std::copy_n(m_values, m_size, values);
+                const size_type size = m_size;
+                deallocate();
+                m_values   = values;
+                m_size     = size;
+                m_capacity = n;
+            }
+
+            void resize(size_type n, value_type fill = value_type{})
+            {
+                reserve(n);
+                if (n > m_size)
+                {
+                    std::fill(data() + m_size, data() + n, fill);
+                }
+                m_size = n;
+            }
+
+            void push_back(value_type length)
+            {
+                if (m_size == m_capacity)
+                {
+                    reserve(std::max<size_type>(2 * m_capacity, alignment / sizeof(Rep)));
+                }
+                m_values[m_size++] = length.value();
+            }
+
+            void clear() { m_size = 0; }
+
+            // conversion
+
+            /** Converts all lengths to `ToUnit` reusing this buffer, which is moved into result **/
+            template <typename ToUnit>
+            [[nodiscard]] LengthArray<ToUnit, Rep, Allocator> convert_to() &&
+            {
+                convert_in_place<Unit, ToUnit>(data(), m_size);
+                LengthArray<ToUnit, Rep, Allocator> result(get_allocator());
+                result.steal(*this);
+                return result;
+            }
+
+            /** Converts all lengths to `ToUnit` into new array, allocated like a copy of this one **/
+            template <typename ToUnit>
+            [[nodiscard]] LengthArray<ToUnit, Rep, Allocator> convert_to() const &
+            {
+                LengthArray<ToUnit, Rep, Allocator> result(m_size, {}, copy_allocator());
+                convert_n<Unit, ToUnit>(data(), m_size, result.data());
+                return result;
+            }
+
+            // compound assignment, element-wise over arrays of the same size, `std::length_error` otherwise
+
+            template <typename Unit2>
+            LengthArray& operator+= (LengthArrayView<Unit2, Rep> rhs)
+            {
+                detail::add_scaled_n<Unit2, Unit>(values(), rhs.values(), values(), m_size, rhs.size(), false);
+                return *this;
+            }
+
+            template <typename Unit2>
+            LengthArray& operator-= (LengthArrayView<Unit2, Rep> rhs)
+            {
+                detail::add_scaled_n<Unit2, Unit>(values(), rhs.values(), values(), m_size, rhs.size(), true);
+                return *this;
+            }
+
+            template <typename Unit2, typename Allocator2>
+            LengthArray& operator+= (const LengthArray<Unit2, Rep, Allocator2>& rhs) { return *this += rhs.view(); }
+
+            template <typename Unit2, typename Allocator2>
+            LengthArray& operator-= (const LengthArray<Unit2, Rep, Allocator2>& rhs) { return *this -= rhs.view(); }
+
+            LengthArray& operator*= (const Rep& k)
+            {
+                simd::scale(data(), m_size, k, data());
+                return *this;
+            }
+
+            LengthArray& operator/= (const Rep& k)
+            {
+                detail::divide_n(values(), values(), m_size, k);
+                return *this;
+            }
+    };
+
+    // element-wise arithmetic, result is in allocator and units of the left operand (their common unit
+    // with `LENGTH_COMMON_UNIT_ARITHMETIC`) like `Length` operators
+
+    namespace detail
+    {
+        template <typename Unit1, typename Unit2, typename Rep>
+        using array_additive_unit_t = typename additive_result_t<Unit1, Rep, Unit2, Rep>::unit;
+
+        /** `lhs +- rhs` in `Unit`, converting `lhs` in its own buffer first if needed **/
+        template <typename Unit, bool Subtract, typename Unit1, typename Unit2, typename Rep, typename Alloc1, typename Alloc2>
+        [[nodiscard]] LengthArray<Unit, Rep, Alloc1> add_arrays(LengthArray<Unit1, Rep, Alloc1> lhs, const LengthArray<Unit2, Rep, Alloc2>& rhs)
+        {
+            LengthArray<Unit, Rep, Alloc1> result = [&] {
+                if constexpr (std::is_same_v<Unit, Unit1>)
+                {
+                    return std::move(lhs);
+                }
+                else
+                {
+                    if (lhs.size() != rhs.size())
+                    {
+                        throw std::length_error("length: `LengthArray` operands must have the same size");
+                    }
+                    return std::move(lhs).template convert_to<Unit>();
+                }
+            }();
+            if constexpr (Subtract)
+            {
+                result -= rhs;
+            }
+            else
+            {
+                result += rhs;
+            }
+            return result;
+        }
+    }
+
+    template <typename Unit1, typename Unit2, typename Rep, typename Alloc1, typename Alloc2>
+    [[nodiscard]] LengthArray<detail::array_additive_unit_t<Unit1, Unit2, Rep>, Rep, Alloc1> operator+ (LengthArray<Unit1, Rep, Alloc1> lhs, const LengthArray<Unit2, Rep, Alloc2>& rhs)
+    {
+        return detail::add_arrays<detail::array_additive_unit_t<Unit1, Unit2, Rep>, false>(std::move(lhs), rhs);
+    }
+
+    template <typename Unit1, typename Unit2, typename Rep, typename Alloc1, typename Alloc2>
+    [[nodiscard]] LengthArray<detail::array_additive_unit_t<Unit1, Unit2, Rep>, Rep, Alloc1> operator- (LengthArray<Unit1, Rep, Alloc1> lhs, const LengthArray<Unit2, Rep, Alloc2>& rhs)
+    {
+        return detail::add_arrays<detail::array_additive_unit_t<Unit1, Unit2, Rep>, true>(std::move(lhs), rhs);
+    }
+
+    template <typename Unit, typename Rep, typename Alloc>
+    [[nodiscard]] LengthArray<Unit, Rep, Alloc> operator* (LengthArray<Unit, Rep, Alloc> array, const detail::type_identity_t<Rep>& k) { return std::move(array *= k); }
+
+    template <typename Unit, typename Rep, typename Alloc>
+    [[nodiscard]] LengthArray<Unit, Rep, Alloc> operator* (const detail::type_identity_t<Rep>& k, LengthArray<Unit, Rep, Alloc> array) { return std::move(array *= k); }
+
+    template <typename Unit, typename Rep, typename Alloc>
+    [[nodiscard]] LengthArray<Unit, Rep, Alloc> operator/ (LengthArray<Unit, Rep, Alloc> array, const detail::type_identity_t<Rep>& k) { return std::move(array /= k); }
+
+    template <typename Unit, typename Rep, typename Alloc>
+    void swap(LengthArray<Unit, Rep, Alloc>& lhs, LengthArray<Unit, Rep, Alloc>& rhs) noexcept { lhs.swap(rhs); }
+
+#if defined(__cpp_lib_memory_resource)
+    namespace pmr
+    {
+        /** `LengthArray` drawing memory from `std::pmr::memory_resource`, e.g. per-request `pmr::AlignedArena` **/
+        template <typename Unit, typename Rep = double>
+        using LengthArray = length::LengthArray<Unit, Rep, std::pmr::polymorphic_allocator<Rep>>;
+    }
+#endif
+}
@@ -0,0 +1,283 @@
+/*********************************************************************************
+ *
+ *  MIT License
+ *
+ *  Copyright (c) 2017 Nenad Zikic
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ *********************************************************************************/
+
+
+#pragma once
+
+#include "length.hpp"
+#include "bulk.hpp"
+#include "length_array.hpp"
+#include "serialize.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <system_error>
+#include <utility>
+
+#if defined(_WIN32)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+
+// Read-only memory mapped length files written with `encoding::raw` (see `serialize.hpp`).
+//
+// Values are used in place, straight from the page cache: opening a file costs
+// one mapping call and pages are faulted in on first access. Quantised and delta
+// encoded files need decoding and must be read with `LengthDecoder` instead.
+
+namespace length
+{
+
+    namespace detail
+    {
+        inline constexpr bool little_endian_host =
+#if defined(_WIN32) || (defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+            true;
+#else
+            false;
+#endif
+    }
+
+    /** Read-only mapping of raw length file stored in `Unit` and `Rep`
+     *
+     * Throwing constructor reports errors as `std::system_error`; default construct and
+     * call `map` to get `std::error_code` instead. Files in a different unit, rep or
+     * encoding are rejected with `std::errc::invalid_argument`.
+     *
+     * @example usage
+     *          1. const MappedLengthFile<millimetre> survey{"survey.lens"};
+     *             Length<millimetre> total = simd::sum(survey.data(), survey.size());
+     *          2. auto metres = expr::evaluate(expr::convert<metre>(expr::lazy(survey.view()))); // converted on access
+     */
+    template <typename Unit, typename Rep = double>
+    class MappedLengthFile
+    {
+            const void*              m_mapping = nullptr;
+            std::size_t              m_bytes   = 0;
+            const Length<Unit, Rep>* m_data    = nullptr;
+            std::size_t              m_size    = 0;
+
+            void swap(MappedLengthFile& other) noexcept
+            {
+                std::swap(m_mapping, other.m_mapping);
+                std::swap(m_bytes,   other.m_bytes);
+                std::swap(m_data,    other.m_data);
+                std::swap(m_size,    other.m_size);
+            }
+
+            /** Maps whole file read-only, sets `m_mapping` and `m_bytes` **/
+            std::error_code map_file(const std::filesystem::path& path) noexcept
+            {
+#if defined(_WIN32)
+                HANDLE file = ::CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+                if (file == INVALID_HANDLE_VALUE)
+                {
+                    return {static_cast<int>(::GetLastError()), std::system_category()};
+                }
+                LARGE_INTEGER size;
+                if (!::GetFileSizeEx(file, &size))
+                {
+                    const std::error_code ec{static_cast<int>(::GetLastError()), std::system_category()};
+                    ::CloseHandle(file);
+                    return ec;
+                }
+                if (size.QuadPart == 0)
+                {
+                    ::CloseHandle(file);
+                    return std::make_error_code(std::errc::invalid_argument);
+                }
+                HANDLE mapping = ::CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+                ::CloseHandle(file);
+                if (mapping == nullptr)
+                {
+                    return {static_cast<int>(::GetLastError()), std::system_category()};
+                }
+                const void* view = ::MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+                ::CloseHandle(mapping); // view keeps the mapping alive
+                if (view == nullptr)
+                {
+                    return {static_cast<int>(::GetLastError()), std::system_category()};
+                }
+                m_mapping = view;
+                m_bytes   = static_cast<std::size_t>(size.QuadPart);
+#else
+                const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+                if (fd < 0)
+                {
+                    return {errno, std::generic_category()};
+                }
+                struct stat st;
+                if (::fstat(fd, &st) != 0)
+                {
+                    const std::error_code ec{errno, std::generic_category()};
+                    ::close(fd);
+                    return ec;
+                }
+                if (st.st_size == 0)
+                {
+                    ::close(fd);
+                    return std::make_error_code(std::errc::invalid_argument);
+                }
+                void* view = ::mmap(nullptr, static_cast<std::size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+                ::close(fd); // mapping stays valid after the descriptor is closed
+                if (view == MAP_FAILED)
+                {
+                    return {errno, std::generic_category()};
+                }
+                m_mapping = view;
+                m_bytes   = static_cast<std::size_t>(st.st_size);
+#endif
+                return {};
+            }
+
+        public:
+            using unit       = Unit;
+            using rep        = Rep;
+            using value_type = Length<Unit, Rep>;
+            using size_type  = std::size_t;
+
+            MappedLengthFile() = default;
+
+            explicit MappedLengthFile(const std::filesystem::path& path)
+            {
+                if (const std::error_code ec = map(path))
+                {
+                    throw std::system_error(ec, "length: can't map \"" + path.string() + "\"");
+                }
+            }
+
+            MappedLengthFile(const MappedLengthFile&) = delete;
+            MappedLengthFile& operator=(const MappedLengthFile&) = delete;
+
+            MappedLengthFile(MappedLengthFile&& other) noexcept { swap(other); }
+
+            MappedLengthFile& operator=(MappedLengthFile&& other) noexcept
+            {
+                MappedLengthFile{std::move(other)}.swap(*this);
+                return *this;
+            }
+
+            ~MappedLengthFile() { unmap(); }
+
+            /** Maps file at `path`, releasing previous mapping
+             *
+             * @return - empty error code on success, system error if the file can't be mapped,
+             *           `invalid_argument` if it is not raw stream of `Unit` and `Rep` lengths,
+             *           `not_supported` on big endian hosts
+             */
+            std::error_code map(const std::filesystem::path& path) noexcept
+            {
+                unmap();
+                if constexpr (!detail::little_endian_host)
+                {
+                    return std::make_error_code(std::errc::not_supported);
+                }
+                if (const std::error_code ec = map_file(path))
+                {
+                    return ec;
+                }
+
+                LengthDecoder<Unit, Rep> decoder;
+                const char* first = static_cast<const char*>(m_mapping);
+                const decode_result header = decoder.read_header(first, first + m_bytes);
+                const stream_header& h = decoder.header();
+                const std::size_t payload = m_bytes - detail::stream_header_size;
+                const std::size_t count   = h.count == unknown_count ? payload / sizeof(Rep) : static_cast<std::size_t>(h.count);
+                if (header.ec != std::errc{} || h.enc != encoding::raw || h.rep != detail::rep_code<Rep>() ||
+                    h.num != Unit::ratio::num || h.den != Unit::ratio::den ||
+                    detail::rep_size(h.rep) != sizeof(Rep) || count > payload / sizeof(Rep))
+                {
+                    unmap();
+                    return std::make_error_code(std::errc::invalid_argument);
+                }
+
+                m_data = reinterpret_cast<const Length<Unit, Rep>*>(header.ptr);
+                m_size = count;
+                return {};
+            }
+
+            /** Releases the mapping, views of it become dangling **/
+            void unmap() noexcept
+            {
+                if (m_mapping != nullptr)
+                {
+#if defined(_WIN32)
+                    ::UnmapViewOfFile(m_mapping);
+#else
+                    ::munmap(const_cast<void*>(m_mapping), m_bytes);
+#endif
+                }
+                m_mapping = nullptr;
+                m_bytes   = 0;
+                m_data    = nullptr;
+                m_size    = 0;
+            }
+
+            [[nodiscard]] bool is_mapped() const noexcept { return m_mapping != nullptr; }
+
+            [[nodiscard]] const value_type* data()   const noexcept { return m_data; }
+            [[nodiscard]] const Rep*        values() const noexcept { return as_values(m_data); }
+            [[nodiscard]] size_type         size()   const noexcept { return m_size; }
+            [[nodiscard]] bool              empty()  const noexcept { return m_size == 0; }
+
+            [[nodiscard]] const value_type& operator[](size_type i) const { return m_data[i]; }
+
+            [[nodiscard]] const value_type* begin() const noexcept { return m_data; }
+            [[nodiscard]] const value_type* end()   const noexcept { return m_data + m_size; }
+
+            /** View of all mapped lengths **/
+            [[nodiscard]] LengthArrayView<Unit, Rep> view() const noexcept { return {m_data, m_size}; }
+            [[nodiscard]] operator LengthArrayView<Unit, Rep>() const noexcept { return view(); }
+
+            /** Length at `i` converted to `ToUnit` on access **/
+            template <typename ToUnit>
+            [[nodiscard]] Length<ToUnit, Rep> at(size_type i) const { return convert<Unit, ToUnit>(m_data[i]); }
+
+            /** Converts `count` lengths starting at `offset` into caller buffer `out` with bulk kernels
+             *
+             * @return - pointer one past the last written length
+             */
+            template <typename ToUnit>
+            Length<ToUnit, Rep>* convert_to(size_type offset, size_type count, Length<ToUnit, Rep>* out) const
+            {
+                return convert_n<Unit, ToUnit>(m_data + offset, count, out);
+            }
+    };
+}
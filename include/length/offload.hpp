@@ -0,0 +1,180 @@
+/*********************************************************************************
+ *
+ *  MIT License
+ *
+ *  Copyright (c) 2017 Nenad Zikic
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ *********************************************************************************/
+
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+
+
+// Extension point for running bulk kernels on an accelerator (CUDA, SYCL, ...).
+//
+// The library ships no device code. An offload backend lives in the application,
+// compiled by the device toolchain, and installs a table of kernels at start up.
+// With `LENGTH_OFFLOAD` defined, bulk `convert_n`, `simd::scale`, `simd::sum`,
+// `simd::minmax`, `simd::count_greater`, `distance_n` and `LengthArray` sums and
+// division of at least `threshold()` values first offer the work to the installed
+// backend and run on the CPU kernels if there is none, it lacks the kernel, or it
+// declines by returning false (e.g. buffer not device accessible).
+// `distance_n` of interleaved `Point3` arrays offers the whole range to the
+// `distance_interleaved` kernel before splitting it into CPU sized blocks.
+// `LengthAccumulator` always sums on the CPU: it carries its compensation term
+// from one call to the next, which is only exact in the CPU kernel's order.
+//
+// Device code can use `Length` and `convert` directly: core operations are
+// `LENGTH_HOST_DEVICE constexpr` and conversion factors are compile time
+// constants, so device kernels get the same folded single multiplication.
+// Zero-copy buffers are `LengthArray`s with unified or pinned memory allocator,
+// e.g. `sycl::usm_allocator<double, sycl::usm::alloc::shared>`.
+
+namespace length::offload
+{
+
+    /** Device kernels for values of type `T`, null entries fall back to the CPU; each returns false to decline **/
+    template <typename T>
+    struct kernels
+    {
+            bool (*multiply)(const T* in, T* out, std::size_t n, T k) = nullptr;
+            bool (*sum)(const T* data, std::size_t n, T& total) = nullptr;
+            bool (*minmax)(const T* data, std::size_t n, T& lo, T& hi) = nullptr;
+            bool (*distance)(const T* ax, const T* ay, const T* az,
+                             const T* bx, const T* by, const T* bz, T k, T* out, std::size_t n) = nullptr;
+            bool (*distance_interleaved)(const T* a, const T* b, T k, T* out, std::size_t n) = nullptr;   // x, y, z of each point in turn
+            bool (*add_scaled)(const T* a, const T* b, T k, T* out, std::size_t n) = nullptr;              // out = a + b * k
+            bool (*divide)(const T* in, T* out, std::size_t n, T k) = nullptr;
+            bool (*count_greater)(const T* data, std::size_t n, T threshold, std::size_t& count) = nullptr;
+    };
+
+    /** Offload backend, must outlive its installation **/
+    struct backend
+    {
+            const char*      name = "";
+            kernels<double>  f64;
+            kernels<float>   f32;
+    };
+
+    /** Default size below which bulk work stays on the CPU, where transfer and launch would cost more than the kernel **/
+    inline constexpr std::size_t default_threshold = std::size_t{1} << 20;
+
+    namespace detail
+    {
+        inline std::atomic<const backend*>& installed()
+        {
+            static std::atomic<const backend*> current{nullptr};
+            return current;
+        }
+
+        inline std::atomic<std::size_t>& min_size()
+        {
+            static std::atomic<std::size_t> threshold{default_threshold};
+            return threshold;
+        }
+
+        template <typename T>
+        [[nodiscard]] inline const kernels<T>* kernels_for(std::size_t n)
+        {
+            if (n < min_size().load(std::memory_order_relaxed))
+            {
+                return nullptr;
+            }
+            const backend* b = installed().load(std::memory_order_acquire);
+            if (b == nullptr)
+            {
+                return nullptr;
+            }
+            if constexpr (sizeof(T) == sizeof(double)) return &b->f64;
+            else                                       return &b->f32;
+        }
+
+        template <typename T>
+        [[nodiscard]] inline bool run_multiply(const T* in, T* out, std::size_t n, T k)
+        {
+            const kernels<T>* ks = kernels_for<T>(n);
+            return ks != nullptr && ks->multiply != nullptr && ks->multiply(in, out, n, k);
+        }
+
+        template <typename T>
+        [[nodiscard]] inline bool run_add_scaled(const T* a, const T* b, T k, T* out, std::size_t n)
+        {
+            const kernels<T>* ks = kernels_for<T>(n);
+            return ks != nullptr && ks->add_scaled != nullptr && ks->add_scaled(a, b, k, out, n);
+        }
+
+        template <typename T>
+        [[nodiscard]] inline bool run_divide(const T* in, T* out, std::size_t n, T k)
+        {
+            const kernels<T>* ks = kernels_for<T>(n);
+            return ks != nullptr && ks->divide != nullptr && ks->divide(in, out, n, k);
+        }
+
+        template <typename T>
+        [[nodiscard]] inline bool run_sum(const T* data, std::size_t n, T& total)
+        {
+            const kernels<T>* ks = kernels_for<T>(n);
+            return ks != nullptr && ks->sum != nullptr && ks->sum(data, n, total);
+        }
+
+        template <typename T>
+        [[nodiscard]] inline bool run_minmax(const T* data, std::size_t n, T& lo, T& hi)
+        {
+            const kernels<T>* ks = kernels_for<T>(n);
+            return ks != nullptr && ks->minmax != nullptr && ks->minmax(data, n, lo, hi);
+        }
+
+        template <typename T>
+        [[nodiscard]] inline bool run_count_greater(const T* data, std::size_t n, T threshold, std::size_t& count)
+        {
+            const kernels<T>* ks = kernels_for<T>(n);
+            return ks != nullptr && ks->count_greater != nullptr && ks->count_greater(data, n, threshold, count);
+        }
+
+        template <typename T>
+        [[nodiscard]] inline bool run_distance(const T* ax, const T* ay, const T* az,
+                                               const T* bx, const T* by, const T* bz, T k, T* out, std::size_t n)
+        {
+            const kernels<T>* ks = kernels_for<T>(n);
+            return ks != nullptr && ks->distance != nullptr && ks->distance(ax, ay, az, bx, by, bz, k, out, n);
+        }
+
+        template <typename T>
+        [[nodiscard]] inline bool run_distance_interleaved(const T* a, const T* b, T k, T* out, std::size_t n)
+        {
+            const kernels<T>* ks = kernels_for<T>(n);
+            return ks != nullptr && ks->distance_interleaved != nullptr && ks->distance_interleaved(a, b, k, out, n);
+        }
+    }
+
+    /** Installs `b` for all following bulk calls, null uninstalls; returns previous backend **/
+    inline const backend* install(const backend* b) noexcept { return detail::installed().exchange(b, std::memory_order_acq_rel); }
+
+    [[nodiscard]] inline const backend* installed() noexcept { return detail::installed().load(std::memory_order_acquire); }
+
+    /** Sets number of values from which bulk calls are offered to the backend **/
+    inline void set_threshold(std::size_t n) noexcept { detail::min_size().store(n, std::memory_order_relaxed); }
+
+    [[nodiscard]] inline std::size_t threshold() noexcept { return detail::min_size().load(std::memory_order_relaxed); }
+}
@@ -0,0 +1,251 @@
+/*********************************************************************************
+ *
+ *  MIT License
+ *
+ *  Copyright (c) 2017 Nenad Zikic
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ *********************************************************************************/
+
+
+#pragma once
+
+#include "length.hpp"
+#include "accumulator.hpp"
+#include "bulk.hpp"
+#include "simd.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <numeric>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(__cpp_lib_execution)
+#include <execution>
+#endif
+
+
+// Parallel overloads of bulk conversion and reduction APIs.
+//
+// First argument selects how chunks are run, either:
+//  - C++17 execution policy, e.g. `std::execution::par_unseq`, or
+//  - user thread pool, any object with `pool.parallel_for(count, task)` member
+//    invoking `task(i)` for every `i` in [0, count) and returning when all are done.
+//
+// Work is split into fixed, cache sized chunks that don't depend on the number of
+// threads. Each chunk is reduced by the same kernel as the serial call, and only
+// the per chunk partial results are combined in fixed pairwise order, so reductions
+// give bitwise identical results on every run on the same instruction set.
+
+namespace length
+{
+
+    namespace detail
+    {
+        /** Bytes of values processed by a single parallel task **/
+        inline constexpr std::size_t parallel_chunk_bytes = 128 * 1024;
+
+        template <typename Rep>
+        inline constexpr std::size_t parallel_chunk_size = std::max<std::size_t>(1, parallel_chunk_bytes / sizeof(Rep));
+
+        template <typename Pool, typename = void>
+        struct is_thread_pool : std::false_type {};
+
+        template <typename Pool>
+        struct is_thread_pool<Pool, std::void_t<decltype(std::declval<Pool&>().parallel_for(std::size_t{}, std::declval<void (*)(std::size_t)>()))>>
+            : std::true_type {};
+
+        template <typename Executor>
+        inline constexpr bool is_executor_v =
+#if defined(__cpp_lib_execution)
+            std::is_execution_policy_v<std::decay_t<Executor>> ||
+#endif
+            is_thread_pool<std::remove_reference_t<Executor>>::value;
+
+        template <typename Executor>
+        using enable_if_executor_t = std::enable_if_t<is_executor_v<Executor>, int>;
+
+        /** Runs `task(i)` for every chunk index `i` in [0, count) with `executor` **/
+        template <typename Executor, typename Task>
+        void parallel_for(Executor&& executor, std::size_t count, Task task)
+        {
+#if defined(__cpp_lib_execution)
+            if constexpr (std::is_execution_policy_v<std::decay_t<Executor>>)
+            {
+                std::vector<std::size_t> chunks(count);
+                std::iota(chunks.begin(), chunks.end(), std::size_t{0});
+                std::for_each(std::forward<Executor>(executor), chunks.begin(), chunks.end(), task);
+            }
+            else
+#endif
+            {
+                executor.parallel_for(count, task);
+            }
+        }
+
+        template <typename Rep>
+        [[nodiscard]] constexpr std::size_t chunk_count(std::size_t n)
+        {
+            return (n + parallel_chunk_size<Rep> - 1) / parallel_chunk_size<Rep>;
+        }
+
+        /** Pairwise sum of partial results in fixed order **/
+        template <typename Rep>
+        [[nodiscard]] Rep pairwise_sum(const Rep* partials, std::size_t n)
+        {
+            if (n == 0) return Rep{};
+            if (n == 1) return partials[0];
+            const std::size_t half = n / 2;
+            return pairwise_sum(partials, half) + pairwise_sum(partials + half, n - half);
+        }
+    }
+
+    /** Parallel `convert_n`, same results as the sequential one
+     *
+     * @example usage
+     *          1. convert_n<inch, metre>(std::execution::par_unseq, cad.data(), cad.size(), metres.data());
+     */
+    template <typename FromUnit, typename ToUnit, typename Executor, typename Rep, detail::enable_if_executor_t<Executor> = 0>
+    Length<ToUnit, Rep>* convert_n(Executor&& executor, const Length<FromUnit, Rep>* in, std::size_t n, Length<ToUnit, Rep>* out)
+    {
+        constexpr std::size_t chunk = detail::parallel_chunk_size<Rep>;
+        detail::parallel_for(std::forward<Executor>(executor), detail::chunk_count<Rep>(n), [=](std::size_t c)
+        {
+            const std::size_t first = c * chunk;
+            convert_n<FromUnit, ToUnit>(in + first, std::min(chunk, n - first), out + first);
+        });
+        return out + n;
+    }
+
+    /** Parallel in place `convert_in_place` **/
+    template <typename FromUnit, typename ToUnit, typename Executor, typename Rep, detail::enable_if_executor_t<Executor> = 0>
+    Length<ToUnit, Rep>* convert_in_place(Executor&& executor, Length<FromUnit, Rep>* data, std::size_t n)
+    {
+        Length<ToUnit, Rep>* out = as_lengths<ToUnit>(as_values(data));
+        convert_n<FromUnit, ToUnit>(std::forward<Executor>(executor), data, n, out);
+        return out;
+    }
+
+    /** Parallel compensated `accumulate`, chunk accumulators are merged in fixed order so result is deterministic
+     *
+     * @example usage
+     *          1. Length<metre> total = accumulate(std::execution::par_unseq, segments.data(), segments.size()).total();
+     */
+    template <typename ToUnit = void, typename Executor, typename Unit, typename Rep, detail::enable_if_executor_t<Executor> = 0>
+    [[nodiscard]] auto accumulate(Executor&& executor, const Length<Unit, Rep>* data, std::size_t n)
+    {
+        using accumulator = LengthAccumulator<std::conditional_t<std::is_void_v<ToUnit>, Unit, ToUnit>, Rep>;
+        constexpr std::size_t chunk = detail::parallel_chunk_size<Rep>;
+        const std::size_t chunks = detail::chunk_count<Rep>(n);
+
+        std::vector<accumulator> partials(chunks);
+        detail::parallel_for(std::forward<Executor>(executor), chunks, [=, p = partials.data()](std::size_t c)
+        {
+            const std::size_t first = c * chunk;
+            p[c].add(data + first, std::min(chunk, n - first));
+        });
+
+        accumulator total;
+        for (const accumulator& partial : partials)
+        {
+            total.merge(partial);
+        }
+        return total;
+    }
+
+    namespace simd
+    {
+        /** Parallel `sum`, deterministic for given data regardless of the number of threads
+         *
+         * Each chunk is a plain SIMD `sum` with its rounding, only chunk sums are added pairwise;
+         * `accumulate` gives a compensated total instead.
+         */
+        template <typename Executor, typename Unit, typename Rep, length::detail::enable_if_executor_t<Executor> = 0>
+        [[nodiscard]] Length<Unit, Rep> sum(Executor&& executor, const Length<Unit, Rep>* data, std::size_t n)
+        {
+            constexpr std::size_t chunk = length::detail::parallel_chunk_size<Rep>;
+            const std::size_t chunks = length::detail::chunk_count<Rep>(n);
+
+            std::vector<Rep> partials(chunks);
+            length::detail::parallel_for(std::forward<Executor>(executor), chunks, [=, p = partials.data()](std::size_t c)
+            {
+                const std::size_t first = c * chunk;
+                p[c] = detail::sum(as_values(data + first), std::min(chunk, n - first));
+            });
+            return Length<Unit, Rep>{length::detail::pairwise_sum(partials.data(), chunks)};
+        }
+
+        /** Parallel `scale` **/
+        template <typename Executor, typename Unit, typename Rep, length::detail::enable_if_executor_t<Executor> = 0>
+        Length<Unit, Rep>* scale(Executor&& executor, const Length<Unit, Rep>* in, std::size_t n, const length::detail::type_identity_t<Rep>& k, Length<Unit, Rep>* out)
+        {
+            constexpr std::size_t chunk = length::detail::parallel_chunk_size<Rep>;
+            length::detail::parallel_for(std::forward<Executor>(executor), length::detail::chunk_count<Rep>(n), [=](std::size_t c)
+            {
+                const std::size_t first = c * chunk;
+                scale(in + first, std::min(chunk, n - first), k, out + first);
+            });
+            return out + n;
+        }
+
+        /** Parallel `minmax` **/
+        template <typename Executor, typename Unit, typename Rep, length::detail::enable_if_executor_t<Executor> = 0>
+        [[nodiscard]] std::pair<Length<Unit, Rep>, Length<Unit, Rep>> minmax(Executor&& executor, const Length<Unit, Rep>* data, std::size_t n)
+        {
+            constexpr std::size_t chunk = length::detail::parallel_chunk_size<Rep>;
+            const std::size_t chunks = length::detail::chunk_count<Rep>(n);
+
+            std::vector<std::pair<Rep, Rep>> partials(chunks);
+            length::detail::parallel_for(std::forward<Executor>(executor), chunks, [=, p = partials.data()](std::size_t c)
+            {
+                const std::size_t first = c * chunk;
+                detail::minmax(as_values(data + first), std::min(chunk, n - first), p[c].first, p[c].second);
+            });
+
+            Rep lo = detail::highest<Rep>();
+            Rep hi = detail::lowest<Rep>();
+            for (const auto& [plo, phi] : partials)
+            {
+                lo = plo < lo ? plo : lo;
+                hi = phi > hi ? phi : hi;
+            }
+            return {Length<Unit, Rep>{lo}, Length<Unit, Rep>{hi}};
+        }
+
+        /** Parallel `count_greater` **/
+        template <typename Executor, typename Unit, typename Rep, typename Unit2, typename Rep2, length::detail::enable_if_executor_t<Executor> = 0>
+        [[nodiscard]] std::size_t count_greater(Executor&& executor, const Length<Unit, Rep>* data, std::size_t n, const Length<Unit2, Rep2>& threshold)
+        {
+            constexpr std::size_t chunk = length::detail::parallel_chunk_size<Rep>;
+            const std::size_t chunks = length::detail::chunk_count<Rep>(n);
+            const Rep t = detail::threshold_in<Unit, Rep>(threshold);
+
+            std::vector<std::size_t> partials(chunks);
+            length::detail::parallel_for(std::forward<Executor>(executor), chunks, [=, p = partials.data()](std::size_t c)
+            {
+                const std::size_t first = c * chunk;
+                p[c] = detail::count_greater(as_values(data + first), std::min(chunk, n - first), t);
+            });
+            return std::accumulate(partials.begin(), partials.end(), std::size_t{0});
+        }
+    }
+}
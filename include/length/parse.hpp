@@ -0,0 +1,269 @@
+/*********************************************************************************
+ *
+ *  MIT License
+ *
+ *  Copyright (c) 2017 Nenad Zikic
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ *********************************************************************************/
+
+
+#pragma once
+
+#include "length.hpp"
+#include "dynamic_length.hpp"
+
+#include <charconv>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <string_view>
+#include <system_error>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define LENGTH_PARSE_SSE2 1
+#endif
+
+
+// Allocation free, locale independent parsing of lengths written as text,
+// e.g. "12.5 mm", "3ft" or "0.25 m". Number is read with `std::from_chars`,
+// optionally followed by spaces and then one of the unit symbols.
+
+namespace length
+{
+
+    /** Lengths in any of the built-in units, unit is known only at runtime **/
+    using any_length = std::variant<Length<metre>, Length<centimetre>, Length<millimetre>, Length<inch>, Length<foot>,
+                                    Length<micrometre>, Length<nanometre>, Length<yard>, Length<mile>, Length<nautical_mile>>;
+
+    /** Result of parsing, same meaning as `std::from_chars_result` **/
+    struct parse_result
+    {
+            const char* ptr;
+            std::errc   ec;
+    };
+
+    /** Result of bulk parsing, `count` lengths were written **/
+    struct parse_n_result
+    {
+            const char* ptr;
+            std::size_t count;
+            std::errc   ec;
+    };
+
+    namespace detail
+    {
+        using parse_units = dynamic_units;
+
+        [[nodiscard]] constexpr bool is_blank(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+        [[nodiscard]] constexpr bool is_alpha(char c) { return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z'); }
+
+        [[nodiscard]] constexpr const char* skip_blanks(const char* first, const char* last)
+        {
+            while (first != last && is_blank(*first)) ++first;
+            return first;
+        }
+
+        /** Index in `parse_units` of the longest symbol at `first`, or `npos` **/
+        template <std::size_t... I>
+        [[nodiscard]] constexpr std::size_t match_symbol(const char* first, const char* last, std::index_sequence<I...>)
+        {
+            const std::string_view text(first, static_cast<std::size_t>(last - first));
+            constexpr std::string_view symbols[] = {std::tuple_element_t<I, parse_units>::symbol...};
+
+            std::size_t match = static_cast<std::size_t>(-1);
+            std::size_t length = 0;
+            for (std::size_t i = 0; i < sizeof...(I); ++i)
+            {
+                const std::string_view symbol = symbols[i];
+                if (symbol.size() <= length || text.substr(0, symbol.size()) != symbol)
+                {
+                    continue;
+                }
+                if (text.size() == symbol.size() || !is_alpha(text[symbol.size()]))
+                {
+                    match  = i;
+                    length = symbol.size();
+                }
+            }
+            return match;
+        }
+
+        /** Calls `f(Unit{})` for unit at `index` of `parse_units` **/
+        template <typename F, std::size_t... I>
+        constexpr void visit_unit(std::size_t index, F&& f, std::index_sequence<I...>)
+        {
+            ((index == I ? (f(std::tuple_element_t<I, parse_units>{}), true) : false) || ...);
+        }
+
+        /** Parses "<number>[blanks]<symbol>" calling `f(value, Unit{})` on success **/
+        template <typename F>
+        parse_result parse_with(const char* first, const char* last, F&& f)
+        {
+            double value = 0.0;
+            const char* p = skip_blanks(first, last);
+            if (p != last && *p == '+')
+            {
+                // one sign only, `from_chars` would still take '-' of "+-5 m"
+                if (++p != last && (*p == '-' || *p == '+'))
+                {
+                    return {first, std::errc::invalid_argument};
+                }
+            }
+
+            const std::from_chars_result number = std::from_chars(p, last, value, std::chars_format::general);
+            if (number.ec != std::errc{})
+            {
+                return {first, number.ec};
+            }
+
+            constexpr auto units = std::make_index_sequence<std::tuple_size_v<parse_units>>{};
+            p = skip_blanks(number.ptr, last);
+            const std::size_t unit = match_symbol(p, last, units);
+            if (unit == static_cast<std::size_t>(-1))
+            {
+                return {first, std::errc::invalid_argument};
+            }
+
+            visit_unit(unit, [&](auto u)
+            {
+                using U = decltype(u);
+                p += U::symbol.size();
+                f(value, u);
+            }, units);
+            return {p, std::errc{}};
+        }
+
+        template <typename Rep>
+        [[nodiscard]] Rep parsed_value(double value)
+        {
+            if constexpr (std::is_integral_v<Rep>) return static_cast<Rep>(std::llround(value));
+            else                                   return static_cast<Rep>(value);
+        }
+
+        /** First of `delimiter` or '\n' in [first, last), or `last` **/
+        [[nodiscard]] inline const char* find_separator(const char* first, const char* last, char delimiter)
+        {
+#if defined(LENGTH_PARSE_SSE2)
+            const __m128i vdelim = _mm_set1_epi8(delimiter);
+            const __m128i vline  = _mm_set1_epi8('\n');
+            while (last - first >= 16)
+            {
+                const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first));
+                const int mask = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(chunk, vdelim), _mm_cmpeq_epi8(chunk, vline)));
+                if (mask != 0)
+                {
+#if defined(_MSC_VER) && !defined(__clang__)
+                    unsigned long index = 0;
+                    _BitScanForward(&index, static_cast<unsigned long>(mask));
+                    return first + index;
+#else
+                    return first + __builtin_ctz(static_cast<unsigned>(mask));
+#endif
+                }
+                first += 16;
+            }
+#endif
+            while (first != last && *first != delimiter && *first != '\n') ++first;
+            return first;
+        }
+    }
+
+    /** Parses length written as "<number>[spaces]<symbol>" and converts it to `Unit`
+     *
+     * Symbols of all built-in units are recognised. Integral `Rep` is rounded to nearest.
+     *
+     * @return - `ptr` past the symbol and `std::errc{}` on success; `ptr == first` and
+     *           `invalid_argument` for missing number or unknown unit, `result_out_of_range`
+     *           if the number doesn't fit in a double.
+     *
+     * @example usage
+     *          1. Length<metre> len; parse(text.data(), text.data() + text.size(), len); // "12.5 mm" -> 0.0125_m
+     */
+    template <typename Unit, typename Rep>
+    parse_result parse(const char* first, const char* last, Length<Unit, Rep>& out)
+    {
+        return detail::parse_with(first, last, [&](double value, auto unit)
+        {
+            using U = decltype(unit);
+            out = Length<Unit, Rep>{detail::parsed_value<Rep>(convert<U, Unit>(Length<U>{value}).value())};
+        });
+    }
+
+    /** Parses length keeping the unit it was written in **/
+    inline parse_result parse(const char* first, const char* last, any_length& out)
+    {
+        return detail::parse_with(first, last, [&](double value, auto unit)
+        {
+            out = Length<decltype(unit)>{value};
+        });
+    }
+
+    template <typename Unit, typename Rep>
+    parse_result parse(std::string_view text, Length<Unit, Rep>& out) { return parse(text.data(), text.data() + text.size(), out); }
+
+    /** Parses length into runtime unit length keeping the unit it was written in **/
+    inline parse_result parse(const char* first, const char* last, DynamicLength& out)
+    {
+        return detail::parse_with(first, last, [&](double value, auto unit)
+        {
+            out = DynamicLength{value, unit_id_of<decltype(unit)>};
+        });
+    }
+
+    inline parse_result parse(std::string_view text, any_length& out) { return parse(text.data(), text.data() + text.size(), out); }
+
+    inline parse_result parse(std::string_view text, DynamicLength& out) { return parse(text.data(), text.data() + text.size(), out); }
+
+    /** Parses up to `capacity` lengths separated by `delimiter` or new lines into `out`
+     *
+     * Blank fields are skipped. Parsing stops at the first invalid field, `ptr` then
+     * points to its beginning and `ec` tells why.
+     *
+     * @example usage
+     *          1. auto [ptr, n, ec] = parse_n(csv.data(), csv.data() + csv.size(), ',', lens.data(), lens.size());
+     */
+    template <typename Unit, typename Rep>
+    parse_n_result parse_n(const char* first, const char* last, char delimiter, Length<Unit, Rep>* out, std::size_t capacity)
+    {
+        std::size_t count = 0;
+        while (first != last && count < capacity)
+        {
+            const char* end   = detail::find_separator(first, last, delimiter);
+            const char* field = detail::skip_blanks(first, end);
+            if (field != end)
+            {
+                const parse_result r = parse(field, end, out[count]);
+                if (r.ec != std::errc{} || detail::skip_blanks(r.ptr, end) != end)
+                {
+                    return {field, count, r.ec != std::errc{} ? r.ec : std::errc::invalid_argument};
+                }
+                ++count;
+            }
+            first = (end == last) ? last : end + 1;
+        }
+        return {first, count, std::errc{}};
+    }
+}
@@ -0,0 +1,541 @@
+/*********************************************************************************
+ *
+ *  MIT License
+ *
+ *  Copyright (c) 2017 Nenad Zikic
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ *********************************************************************************/
+
+
+#pragma once
+
+#include "length.hpp"
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <numeric>
+#include <system_error>
+#include <type_traits>
+
+
+// Compact binary streams of lengths. Stream starts with fixed 40 byte header
+// storing the unit (as ratio to metre) once, followed by values in one of:
+//
+//  - `encoding::raw`       - little endian `Rep` values,
+//  - `encoding::quantised` - values as integer multiples of `quantum`, zigzag varint coded,
+//  - `encoding::delta`     - differences of consecutive quantised values, zigzag varint coded,
+//                            a few bytes per value for slowly varying tracks.
+//
+// Header layout, all fields little endian:
+//
+//      offset  size  field
+//           0     4  magic "LENS"
+//           4     1  format version (1)
+//           5     1  encoding
+//           6     1  rep code (1 float, 2 double, 3 int32, 4 int64)
+//           7     1  reserved, 0
+//           8     8  unit ratio numerator
+//          16     8  unit ratio denominator
+//          24     8  value count, `unknown_count` while streaming
+//          32     8  quantum as IEEE-754 double, 1 for integral reps
+//
+// Encoding and decoding are allocation free and chunked: every call consumes
+// as much as fits into the given buffers and carries state over to the next
+// call, so data can be streamed through small buffers straight into bulk APIs.
+
+namespace length
+{
+
+    enum class encoding : std::uint8_t
+    {
+        raw       = 0,
+        quantised = 1,
+        delta     = 2,
+    };
+
+    /** Value count of streams written before their length is known **/
+    inline constexpr std::uint64_t unknown_count = ~std::uint64_t{0};
+
+    /** Stream header as read by `LengthDecoder` **/
+    struct stream_header
+    {
+            encoding      enc;
+            std::uint8_t  rep;
+            std::intmax_t num;
+            std::intmax_t den;
+            std::uint64_t count;
+            double        quantum;
+    };
+
+    /** Result of encoding, `ptr` is one past the last written byte, `count` number of encoded lengths;
+     *  `ec` is `value_too_large` when output buffer filled up before all lengths were encoded */
+    struct encode_result
+    {
+            char*       ptr;
+            std::size_t count;
+            std::errc   ec;
+    };
+
+    /** Result of decoding, `ptr` is one past the last consumed byte, `count` number of decoded lengths;
+     *  bytes of incomplete trailing value are left unconsumed, `ec` is `value_too_large` (with `ptr` at
+     *  the value) when a stored integer converted to an integral `Rep` doesn't fit it */
+    struct decode_result
+    {
+            const char* ptr;
+            std::size_t count;
+            std::errc   ec;
+    };
+
+    namespace detail
+    {
+        inline constexpr char          stream_magic[4]    = {'L', 'E', 'N', 'S'};
+        inline constexpr std::uint8_t  stream_version     = 1;
+        inline constexpr std::size_t   stream_header_size = 40;
+        inline constexpr std::size_t   max_varint_size    = 10;
+
+        template <typename Rep>
+        constexpr std::uint8_t rep_code()
+        {
+            if constexpr (std::is_same_v<Rep, float>)                                           return 1;
+            else if constexpr (std::is_same_v<Rep, double>)                                     return 2;
+            else if constexpr (std::is_integral_v<Rep> && sizeof(Rep) <= 4)                    return 3;
+            else if constexpr (std::is_integral_v<Rep> && sizeof(Rep) == 8)                    return 4;
+            else static_assert (sizeof(Rep) == 0, "Lengths of this `Rep` can't be serialized");
+        }
+
+        constexpr std::size_t rep_size(std::uint8_t code) { return (code == 1 || code == 3) ? 4 : 8; }
+
+        inline void store_le(std::uint64_t v, std::size_t bytes, char* p)
+        {
+            for (std::size_t i = 0; i < bytes; ++i)
+            {
+                p[i] = static_cast<char>(static_cast<unsigned char>(v >> (8 * i)));
+            }
+        }
+
+        [[nodiscard]] inline std::uint64_t load_le(std::size_t bytes, const char* p)
+        {
+            std::uint64_t v = 0;
+            for (std::size_t i = 0; i < bytes; ++i)
+            {
+                v |= std::uint64_t{static_cast<unsigned char>(p[i])} << (8 * i);
+            }
+            return v;
+        }
+
+        /** Bit pattern of `value` stored as rep with `code` **/
+        template <typename Rep>
+        [[nodiscard]] std::uint64_t rep_bits(Rep value)
+        {
+            if constexpr (std::is_floating_point_v<Rep>)
+            {
+                std::conditional_t<sizeof(Rep) == 4, std::uint32_t, std::uint64_t> bits;
+                std::memcpy(&bits, &value, sizeof bits);
+                return bits;
+            }
+            else
+            {
+                return static_cast<std::uint64_t>(static_cast<std::int64_t>(value));
+            }
+        }
+
+        /** Whether values stored with `code` are floating point **/
+        constexpr bool is_floating_code(std::uint8_t code) { return code == 1 || code == 2; }
+
+        [[nodiscard]] inline double floating_from_bits(std::uint64_t bits, std::uint8_t code)
+        {
+            if (code == 1)
+            {
+                float f;
+                const auto b = static_cast<std::uint32_t>(bits);
+                std::memcpy(&f, &b, sizeof f);
+                return f;
+            }
+            double d;
+            std::memcpy(&d, &bits, sizeof d);
+            return d;
+        }
+
+        [[nodiscard]] inline std::int64_t integer_from_bits(std::uint64_t bits, std::uint8_t code)
+        {
+            return code == 3 ? std::int64_t{static_cast<std::int32_t>(static_cast<std::uint32_t>(bits))} : static_cast<std::int64_t>(bits);
+        }
+
+        [[nodiscard]] constexpr std::uint64_t zigzag(std::int64_t v)
+        {
+            return (static_cast<std::uint64_t>(v) << 1) ^ static_cast<std::uint64_t>(v >> 63);
+        }
+
+        [[nodiscard]] constexpr std::int64_t unzigzag(std::uint64_t v)
+        {
+            return static_cast<std::int64_t>(v >> 1) ^ -static_cast<std::int64_t>(v & 1);
+        }
+
+        /** `a - b` and `a + b` wrapping around on overflow, as deltas of any two values fit 64 bits modulo 2^64 **/
+        [[nodiscard]] constexpr std::int64_t wrapping_sub(std::int64_t a, std::int64_t b)
+        {
+            return static_cast<std::int64_t>(static_cast<std::uint64_t>(a) - static_cast<std::uint64_t>(b));
+        }
+
+        [[nodiscard]] constexpr std::int64_t wrapping_add(std::int64_t a, std::int64_t b)
+        {
+            return static_cast<std::int64_t>(static_cast<std::uint64_t>(a) + static_cast<std::uint64_t>(b));
+        }
+
+        /** Product of `a` and positive `b`, false if it overflows **/
+        [[nodiscard]] constexpr bool checked_multiply(std::intmax_t a, std::intmax_t b, std::intmax_t& product)
+        {
+            if (a > INTMAX_MAX / b || a < INTMAX_MIN / b)
+            {
+                return false;
+            }
+            product = a * b;
+            return true;
+        }
+
+        [[nodiscard]] constexpr std::size_t varint_size(std::uint64_t v)
+        {
+            std::size_t size = 1;
+            for (; v >= 0x80; v >>= 7)
+            {
+                ++size;
+            }
+            return size;
+        }
+
+        inline char* write_varint(std::uint64_t v, char* p)
+        {
+            for (; v >= 0x80; v >>= 7)
+            {
+                *p++ = static_cast<char>(static_cast<unsigned char>(v | 0x80));
+            }
+            *p++ = static_cast<char>(static_cast<unsigned char>(v));
+            return p;
+        }
+
+        /** Reads varint from [first, last), returns nullptr if it is incomplete or doesn't fit 64 bits **/
+        inline const char* read_varint(const char* first, const char* last, std::uint64_t& v)
+        {
+            v = 0;
+            for (std::size_t shift = 0; first != last && shift < 64; shift += 7)
+            {
+                const auto byte = static_cast<unsigned char>(*first++);
+                if (shift == 63 && byte > 1)
+                {
+                    return nullptr;     // 10th byte holds the top bit only
+                }
+                v |= std::uint64_t{byte & 0x7Fu} << shift;
+                if ((byte & 0x80u) == 0)
+                {
+                    return first;
+                }
+            }
+            return nullptr;
+        }
+
+        /** Integer multiple of `quantum` nearest to `value` **/
+        template <typename Rep>
+        [[nodiscard]] std::int64_t quantise(Rep value, double quantum)
+        {
+            if constexpr (std::is_floating_point_v<Rep>)
+            {
+                return static_cast<std::int64_t>(std::llround(static_cast<double>(value) / quantum));
+            }
+            else
+            {
+                return static_cast<std::int64_t>(value);
+            }
+        }
+    }
+
+    /** Chunked encoder of `Length<Unit, Rep>` streams
+     *
+     * @example usage
+     *          1. LengthEncoder<millimetre> enc{encoding::delta, 0.001}; // micrometre resolution
+     *             char* p = enc.write_header(buf, buf + size).ptr;
+     *             p = enc.encode(track.data(), track.size(), p, buf + size).ptr;
+     */
+    template <typename Unit, typename Rep = double>
+    class LengthEncoder
+    {
+            encoding     m_encoding;
+            double       m_quantum;
+            std::int64_t m_previous = 0;
+
+        public:
+            /** `quantum` is resolution of quantised encodings in units `Unit`, ignored by integral reps **/
+            explicit LengthEncoder(encoding enc = encoding::raw, double quantum = 1.0)
+                : m_encoding{enc}, m_quantum{std::is_integral_v<Rep> ? 1.0 : quantum} {}
+
+            /** Upper bound of bytes needed for header and `n` lengths **/
+            [[nodiscard]] static constexpr std::size_t max_encoded_size(std::size_t n)
+            {
+                return detail::stream_header_size + n * detail::max_varint_size;
+            }
+
+            /** Writes stream header; `count` may be left unknown when streaming **/
+            encode_result write_header(char* first, char* last, std::uint64_t count = unknown_count) const
+            {
+                if (static_cast<std::size_t>(last - first) < detail::stream_header_size)
+                {
+                    return {first, 0, std::errc::value_too_large};
+                }
+                std::uint64_t quantum_bits;
+                std::memcpy(&quantum_bits, &m_quantum, sizeof quantum_bits);
+
+                std::memcpy(first, detail::stream_magic, sizeof detail::stream_magic);
+                first[4] = static_cast<char>(detail::stream_version);
+                first[5] = static_cast<char>(m_encoding);
+                first[6] = static_cast<char>(detail::rep_code<Rep>());
+                first[7] = 0;
+                detail::store_le(static_cast<std::uint64_t>(Unit::ratio::num), 8, first + 8);
+                detail::store_le(static_cast<std::uint64_t>(Unit::ratio::den), 8, first + 16);
+                detail::store_le(count, 8, first + 24);
+                detail::store_le(quantum_bits, 8, first + 32);
+                return {first + detail::stream_header_size, 0, std::errc{}};
+            }
+
+            /** Encodes `n` lengths starting at `in` into [first, last), stopping when output is full **/
+            encode_result encode(const Length<Unit, Rep>* in, std::size_t n, char* first, char* last)
+            {
+                const Rep* values = as_values(in);
+                char* p = first;
+                std::size_t i = 0;
+                if (m_encoding == encoding::raw)
+                {
+                    constexpr std::size_t size = detail::rep_size(detail::rep_code<Rep>());
+                    for (; i < n && static_cast<std::size_t>(last - p) >= size; ++i, p += size)
+                    {
+                        detail::store_le(detail::rep_bits(values[i]), size, p);
+                    }
+                }
+                else
+                {
+                    for (; i < n; ++i)
+                    {
+                        const std::int64_t  q    = detail::quantise(values[i], m_quantum);
+                        const std::uint64_t code = detail::zigzag(m_encoding == encoding::delta ? detail::wrapping_sub(q, m_previous) : q);
+                        if (static_cast<std::size_t>(last - p) < detail::varint_size(code))
+                        {
+                            break;
+                        }
+                        p = detail::write_varint(code, p);
+                        m_previous = q;
+                    }
+                }
+                return {p, i, i == n ? std::errc{} : std::errc::value_too_large};
+            }
+    };
+
+    /** Chunked decoder of `Length<Unit, Rep>` streams
+     *
+     * Stream may be written in any unit and rep, values are converted to `Unit` and `Rep`.
+     *
+     * @example usage
+     *          1. LengthDecoder<metre> dec;
+     *             const char* p = dec.read_header(buf, end).ptr;
+     *             while (!dec.done()) { auto [next, n, ec] = dec.decode(p, end, chunk, chunk_size); ...; p = next; }
+     */
+    template <typename Unit, typename Rep = double>
+    class LengthDecoder
+    {
+            stream_header m_header{};
+            std::intmax_t m_num = 1;       // ratio converting stored values to `Unit`
+            std::intmax_t m_den = 1;
+            double        m_ratio = 1.0;   // the same ratio and with quantum applied, as doubles
+            double        m_scale = 1.0;
+            std::int64_t  m_previous = 0;
+            std::uint64_t m_remaining = 0;
+
+            /** Length value of stored integer, exact for integral reps whenever the ratio allows;
+             *  false if it doesn't fit integral `Rep` (or overflows `intmax_t` on the way)
+             */
+            [[nodiscard]] bool from_integer(std::int64_t q, Rep& value) const
+            {
+                if constexpr (std::is_floating_point_v<Rep>)
+                {
+                    value = static_cast<Rep>(static_cast<double>(q) * m_scale);
+                    return true;
+                }
+                else
+                {
+                    std::intmax_t v;
+                    if (m_header.quantum == 1.0)
+                    {
+                        if (!detail::checked_multiply(q, m_num, v))
+                        {
+                            return false;
+                        }
+                        v /= m_den;
+                    }
+                    else
+                    {
+                        const double scaled = std::round(static_cast<double>(q) * m_scale);
+                        if (!(scaled >= -0x1p63 && scaled < 0x1p63))
+                        {
+                            return false;
+                        }
+                        v = static_cast<std::intmax_t>(scaled);
+                    }
+                    constexpr std::intmax_t lo = static_cast<std::intmax_t>(std::numeric_limits<Rep>::lowest());
+                    constexpr std::intmax_t hi = std::is_signed_v<Rep> || sizeof(Rep) < sizeof(std::intmax_t)
+                                               ? static_cast<std::intmax_t>(std::numeric_limits<Rep>::max()) : INTMAX_MAX;
+                    if (v < lo || v > hi)
+                    {
+                        return false;
+                    }
+                    value = static_cast<Rep>(v);
+                    return true;
+                }
+            }
+
+            decode_result consumed(const char* p, std::size_t count, std::errc ec)
+            {
+                if (m_remaining != unknown_count)
+                {
+                    m_remaining -= count;
+                }
+                return {p, count, ec};
+            }
+
+            /** Length value of stored floating point value, rounded to nearest for integral reps **/
+            [[nodiscard]] Rep from_floating(double v) const
+            {
+                if constexpr (std::is_floating_point_v<Rep>)
+                {
+                    return static_cast<Rep>(v * m_ratio);
+                }
+                else
+                {
+                    return static_cast<Rep>(std::llround(v * m_ratio));
+                }
+            }
+
+        public:
+            /** Reads and validates stream header
+             *
+             * @return - `ptr` past the header on success; `resource_unavailable_try_again` if
+             *           [first, last) is shorter than header, `invalid_argument` if it is not a valid header
+             *           or the ratio of its unit to `Unit` overflows `std::intmax_t`
+             */
+            decode_result read_header(const char* first, const char* last)
+            {
+                if (static_cast<std::size_t>(last - first) < detail::stream_header_size)
+                {
+                    return {first, 0, std::errc::resource_unavailable_try_again};
+                }
+                const auto enc = static_cast<std::uint8_t>(first[5]);
+                const auto rep = static_cast<std::uint8_t>(first[6]);
+                const auto num = static_cast<std::intmax_t>(detail::load_le(8, first + 8));
+                const auto den = static_cast<std::intmax_t>(detail::load_le(8, first + 16));
+                if (std::memcmp(first, detail::stream_magic, sizeof detail::stream_magic) != 0 ||
+                    static_cast<std::uint8_t>(first[4]) != detail::stream_version ||
+                    enc > static_cast<std::uint8_t>(encoding::delta) || rep < 1 || rep > 4 || num <= 0 || den <= 0)
+                {
+                    return {first, 0, std::errc::invalid_argument};
+                }
+
+                // stored unit num/den over `Unit`, cross reduced first so only ratios that don't fit overflow
+                const std::intmax_t gn = std::gcd(num, Unit::ratio::num);
+                const std::intmax_t gd = std::gcd(den, Unit::ratio::den);
+                std::intmax_t n;
+                std::intmax_t d;
+                if (!detail::checked_multiply(num / gn, Unit::ratio::den / gd, n) || !detail::checked_multiply(den / gd, Unit::ratio::num / gn, d))
+                {
+                    return {first, 0, std::errc::invalid_argument};
+                }
+
+                const std::uint64_t quantum_bits = detail::load_le(8, first + 32);
+                m_header = stream_header{static_cast<encoding>(enc), rep, num, den, detail::load_le(8, first + 24), 0.0};
+                std::memcpy(&m_header.quantum, &quantum_bits, sizeof m_header.quantum);
+
+                const std::intmax_t g = std::gcd(n, d);
+                m_num       = n / g;
+                m_den       = d / g;
+                m_ratio     = static_cast<double>(m_num) / static_cast<double>(m_den);
+                m_scale     = m_header.quantum * m_ratio;
+                m_previous  = 0;
+                m_remaining = m_header.count;
+                return {first + detail::stream_header_size, 0, std::errc{}};
+            }
+
+            [[nodiscard]] const stream_header& header() const { return m_header; }
+
+            /** Whether all values of stream with known count were decoded **/
+            [[nodiscard]] bool done() const { return m_remaining == 0; }
+
+            /** Decodes up to `capacity` lengths from [first, last) into `out`
+             *
+             * Values split across chunk boundary stay unconsumed, pass them again
+             * followed by the next chunk.
+             */
+            decode_result decode(const char* first, const char* last, Length<Unit, Rep>* out, std::size_t capacity)
+            {
+                Rep* values = as_values(out);
+                const std::uint64_t wanted = std::min<std::uint64_t>(capacity, m_remaining);
+                const char* p = first;
+                std::size_t i = 0;
+                if (m_header.enc == encoding::raw)
+                {
+                    const std::size_t size = detail::rep_size(m_header.rep);
+                    for (; i < wanted && static_cast<std::size_t>(last - p) >= size; ++i, p += size)
+                    {
+                        const std::uint64_t bits = detail::load_le(size, p);
+                        if (detail::is_floating_code(m_header.rep))
+                        {
+                            values[i] = from_floating(detail::floating_from_bits(bits, m_header.rep));
+                        }
+                        else if (!from_integer(detail::integer_from_bits(bits, m_header.rep), values[i]))
+                        {
+                            return consumed(p, i, std::errc::value_too_large);
+                        }
+                    }
+                }
+                else
+                {
+                    for (; i < wanted; ++i)
+                    {
+                        std::uint64_t code;
+                        const char* next = detail::read_varint(p, last, code);
+                        if (next == nullptr)
+                        {
+                            if (static_cast<std::size_t>(last - p) >= detail::max_varint_size)
+                            {
+                                return {p, i, std::errc::invalid_argument};
+                            }
+                            break;
+                        }
+                        const std::int64_t q = m_header.enc == encoding::delta ? detail::wrapping_add(m_previous, detail::unzigzag(code)) : detail::unzigzag(code);
+                        if (!from_integer(q, values[i]))
+                        {
+                            return consumed(p, i, std::errc::value_too_large);
+                        }
+                        m_previous = q;
+                        p = next;
+                    }
+                }
+                return consumed(p, i, std::errc{});
+            }
+    };
+}
@@ -0,0 +1,416 @@
+/*********************************************************************************
+ *
+ *  MIT License
+ *
+ *  Copyright (c) 2017 Nenad Zikic
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ *********************************************************************************/
+
+
+#pragma once
+
+#include "length.hpp"
+#include "detail/simd_isa.hpp"
+
+#if defined(LENGTH_OFFLOAD)
+#include "offload.hpp"
+#endif
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <type_traits>
+#include <utility>
+
+#if defined(LENGTH_SIMD_X86) && defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+
+namespace length::simd
+{
+
+    /** Instruction sets bulk kernels can be compiled for **/
+    enum class isa
+    {
+        scalar,
+        sse2,
+        avx2,
+        avx512,
+        neon
+    };
+
+    [[nodiscard]] constexpr const char* to_string(isa i) noexcept
+    {
+        switch (i)
+        {
+            case isa::sse2:   return "sse2";
+            case isa::avx2:   return "avx2";
+            case isa::avx512: return "avx512";
+            case isa::neon:   return "neon";
+            default:          return "scalar";
+        }
+    }
+
+    /** Widest instruction set supported by both the CPU and the OS running the program **/
+    [[nodiscard]] inline isa detect_isa() noexcept
+    {
+#if defined(LENGTH_SIMD_X86) && (defined(__GNUC__) || defined(__clang__))
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512f")) return isa::avx512;
+        if (__builtin_cpu_supports("avx2"))    return isa::avx2;
+        if (__builtin_cpu_supports("sse2"))    return isa::sse2;
+        return isa::scalar;
+#elif defined(LENGTH_SIMD_X86) && defined(_MSC_VER)
+        int regs[4] = {};
+        __cpuid(regs, 0);
+        const int max_leaf = regs[0];
+
+        __cpuid(regs, 1);
+        const bool sse2    = (regs[3] & (1 << 26)) != 0;
+        const bool osxsave = (regs[2] & (1 << 27)) != 0;
+        const unsigned long long xcr0 = osxsave ? _xgetbv(0) : 0;
+        const bool os_avx    = (xcr0 & 0x06) == 0x06;
+        const bool os_avx512 = (xcr0 & 0xE6) == 0xE6;
+
+        if (max_leaf >= 7)
+        {
+            __cpuidex(regs, 7, 0);
+            if (os_avx512 && (regs[1] & (1 << 16)) != 0) return isa::avx512;
+            if (os_avx    && (regs[1] & (1 << 5))  != 0) return isa::avx2;
+        }
+        return sse2 ? isa::sse2 : isa::scalar;
+#elif defined(LENGTH_SIMD_NEON)
+        return isa::neon;
+#else
+        return isa::scalar;
+#endif
+    }
+
+    /** Instruction set bulk kernels dispatch to, detected once per program **/
+    [[nodiscard]] inline isa active_isa() noexcept
+    {
+        static const isa selected = detect_isa();
+        return selected;
+    }
+
+    namespace detail
+    {
+        template <typename T>
+        inline constexpr bool is_vectorised_v = std::is_same_v<T, double> || std::is_same_v<T, float>;
+
+        // dispatchers forwarding raw value buffers to the kernel of the active ISA
+
+        template <typename T>
+        inline void multiply(const T* in, T* out, std::size_t n, T k)
+        {
+            if constexpr (is_vectorised_v<T>)
+            {
+#if defined(LENGTH_OFFLOAD)
+                if (::length::offload::detail::run_multiply(in, out, n, k)) return;
+#endif
+                switch (active_isa())
+                {
+#if defined(LENGTH_SIMD_X86)
+                    case isa::avx512: return avx512::multiply(in, out, n, k);
+                    case isa::avx2:   return avx2::multiply(in, out, n, k);
+                    case isa::sse2:   return sse2::multiply(in, out, n, k);
+#elif defined(LENGTH_SIMD_NEON)
+                    case isa::neon:   return neon::multiply(in, out, n, k);
+#endif
+                    default: break;
+                }
+            }
+            scalar::multiply(in, out, n, k);
+        }
+
+        template <typename T>
+        inline void add_scaled(const T* a, const T* b, T k, T* out, std::size_t n)
+        {
+            if constexpr (is_vectorised_v<T>)
+            {
+#if defined(LENGTH_OFFLOAD)
+                if (::length::offload::detail::run_add_scaled(a, b, k, out, n)) return;
+#endif
+                switch (active_isa())
+                {
+#if defined(LENGTH_SIMD_X86)
+                    case isa::avx512: return avx512::add_scaled(a, b, k, out, n);
+                    case isa::avx2:   return avx2::add_scaled(a, b, k, out, n);
+                    case isa::sse2:   return sse2::add_scaled(a, b, k, out, n);
+#elif defined(LENGTH_SIMD_NEON)
+                    case isa::neon:   return neon::add_scaled(a, b, k, out, n);
+#endif
+                    default: break;
+                }
+            }
+            scalar::add_scaled(a, b, k, out, n);
+        }
+
+        template <typename T>
+        inline void divide(const T* in, T* out, std::size_t n, T k)
+        {
+            if constexpr (is_vectorised_v<T>)
+            {
+#if defined(LENGTH_OFFLOAD)
+                if (::length::offload::detail::run_divide(in, out, n, k)) return;
+#endif
+                switch (active_isa())
+                {
+#if defined(LENGTH_SIMD_X86)
+                    case isa::avx512: return avx512::divide(in, out, n, k);
+                    case isa::avx2:   return avx2::divide(in, out, n, k);
+                    case isa::sse2:   return sse2::divide(in, out, n, k);
+#elif defined(LENGTH_SIMD_NEON)
+                    case isa::neon:   return neon::divide(in, out, n, k);
+#endif
+                    default: break;
+                }
+            }
+            scalar::divide(in, out, n, k);
+        }
+
+        template <typename T>
+        [[nodiscard]] inline T sum(const T* data, std::size_t n)
+        {
+            if constexpr (is_vectorised_v<T>)
+            {
+#if defined(LENGTH_OFFLOAD)
+                if (T total{}; ::length::offload::detail::run_sum(data, n, total)) return total;
+#endif
+                switch (active_isa())
+                {
+#if defined(LENGTH_SIMD_X86)
+                    case isa::avx512: return avx512::sum(data, n);
+                    case isa::avx2:   return avx2::sum(data, n);
+                    case isa::sse2:   return sse2::sum(data, n);
+#elif defined(LENGTH_SIMD_NEON)
+                    case isa::neon:   return neon::sum(data, n);
+#endif
+                    default: break;
+                }
+            }
+            return scalar::sum(data, n);
+        }
+
+        template <typename T>
+        inline void compensated_sum(const T* data, std::size_t n, T k, T& total, T& error)
+        {
+            if constexpr (is_vectorised_v<T>)
+            {
+                switch (active_isa())
+                {
+#if defined(LENGTH_SIMD_X86)
+                    case isa::avx512: return avx512::compensated_sum(data, n, k, total, error);
+                    case isa::avx2:   return avx2::compensated_sum(data, n, k, total, error);
+                    case isa::sse2:   return sse2::compensated_sum(data, n, k, total, error);
+#elif defined(LENGTH_SIMD_NEON)
+                    case isa::neon:   return neon::compensated_sum(data, n, k, total, error);
+#endif
+                    default: break;
+                }
+            }
+            scalar::compensated_sum(data, n, k, total, error);
+        }
+
+        template <typename T>
+        inline void minmax(const T* data, std::size_t n, T& lo, T& hi)
+        {
+            if constexpr (is_vectorised_v<T>)
+            {
+#if defined(LENGTH_OFFLOAD)
+                if (::length::offload::detail::run_minmax(data, n, lo, hi)) return;
+#endif
+                switch (active_isa())
+                {
+#if defined(LENGTH_SIMD_X86)
+                    case isa::avx512: return avx512::minmax(data, n, lo, hi);
+                    case isa::avx2:   return avx2::minmax(data, n, lo, hi);
+                    case isa::sse2:   return sse2::minmax(data, n, lo, hi);
+#elif defined(LENGTH_SIMD_NEON)
+                    case isa::neon:   return neon::minmax(data, n, lo, hi);
+#endif
+                    default: break;
+                }
+            }
+            scalar::minmax(data, n, lo, hi);
+        }
+
+        template <typename T>
+        [[nodiscard]] inline std::size_t count_greater(const T* data, std::size_t n, T threshold)
+        {
+            if constexpr (is_vectorised_v<T>)
+            {
+#if defined(LENGTH_OFFLOAD)
+                if (std::size_t count = 0; ::length::offload::detail::run_count_greater(data, n, threshold, count)) return count;
+#endif
+                switch (active_isa())
+                {
+#if defined(LENGTH_SIMD_X86)
+                    case isa::avx512: return avx512::count_greater(data, n, threshold);
+                    case isa::avx2:   return avx2::count_greater(data, n, threshold);
+                    case isa::sse2:   return sse2::count_greater(data, n, threshold);
+#elif defined(LENGTH_SIMD_NEON)
+                    case isa::neon:   return neon::count_greater(data, n, threshold);
+#endif
+                    default: break;
+                }
+            }
+            return scalar::count_greater(data, n, threshold);
+        }
+
+        template <typename T>
+        inline void distance(const T* ax, const T* ay, const T* az, const T* bx, const T* by, const T* bz, T k, T* out, std::size_t n)
+        {
+            if constexpr (is_vectorised_v<T>)
+            {
+#if defined(LENGTH_OFFLOAD)
+                if (::length::offload::detail::run_distance(ax, ay, az, bx, by, bz, k, out, n)) return;
+#endif
+                switch (active_isa())
+                {
+#if defined(LENGTH_SIMD_X86)
+                    case isa::avx512: return avx512::distance(ax, ay, az, bx, by, bz, k, out, n);
+                    case isa::avx2:   return avx2::distance(ax, ay, az, bx, by, bz, k, out, n);
+                    case isa::sse2:   return sse2::distance(ax, ay, az, bx, by, bz, k, out, n);
+#elif defined(LENGTH_SIMD_NEON)
+                    case isa::neon:   return neon::distance(ax, ay, az, bx, by, bz, k, out, n);
+#endif
+                    default: break;
+                }
+            }
+            scalar::distance(ax, ay, az, bx, by, bz, k, out, n);
+        }
+
+        /** `threshold` expressed in `Unit` and `Rep` such that `e > threshold` iff `e.value() > result`,
+         *  integral thresholds are floor divided like sorted search keys, rounding towards -infinity,
+         *  and keys narrowed to a floating point `Rep` are rounded down to it
+         */
+        template <typename Unit, typename Rep, typename Unit2, typename Rep2>
+        [[nodiscard]] inline Rep threshold_in(const Length<Unit2, Rep2>& threshold)
+        {
+            using CR = length::detail::common_rep_t<Rep, Rep2>;
+            if constexpr (std::is_integral_v<Rep> && std::is_floating_point_v<CR>)
+            {
+                return static_cast<Rep>(std::floor(convert<Unit2, Unit>(length::detail::rep_cast<CR>(threshold)).value()));
+            }
+            else if constexpr (std::is_floating_point_v<Rep> && !std::is_same_v<Rep, CR>)
+            {
+                // `operator>` compares in `CR`, nearest `Rep` above the exact key would drop elements equal to it
+                const CR key = convert<Unit2, Unit>(length::detail::rep_cast<CR>(threshold)).value();
+                if (!(key <= static_cast<CR>(std::numeric_limits<Rep>::max())))
+                {
+                    return std::isnan(key) ? std::numeric_limits<Rep>::quiet_NaN()
+                                           : std::isinf(key) ? std::numeric_limits<Rep>::infinity() : std::numeric_limits<Rep>::max();
+                }
+                if (key < static_cast<CR>(std::numeric_limits<Rep>::lowest()))
+                {
+                    return -std::numeric_limits<Rep>::infinity();
+                }
+                const Rep nearest = static_cast<Rep>(key);
+                return static_cast<CR>(nearest) > key ? std::nextafter(nearest, -std::numeric_limits<Rep>::infinity()) : nearest;
+            }
+            else
+            {
+                return static_cast<Rep>(length::detail::search_key<Unit, Rep, length::detail::key_rounding::down>(threshold));
+            }
+        }
+    }
+
+    /** Sum of `n` lengths starting at `data`, same as folding them with `operator+`
+     *  (up to floating point rounding, values are accumulated in several lanes)
+     *
+     * @example usage
+     *          1. Length<metre> total = simd::sum(segments.data(), segments.size());
+     */
+    template <typename Unit, typename Rep>
+    [[nodiscard]] inline Length<Unit, Rep> sum(const Length<Unit, Rep>* data, std::size_t n)
+    {
+        return Length<Unit, Rep>{detail::sum(as_values(data), n)};
+    }
+
+    /** Multiplies `n` lengths starting at `in` by `k` into `out`, same as `operator*`;
+     *  `in` and `out` may be the same buffer
+     *
+     * @return - pointer one past the last written length
+     */
+    template <typename Unit, typename Rep>
+    inline Length<Unit, Rep>* scale(const Length<Unit, Rep>* in, std::size_t n, const length::detail::type_identity_t<Rep>& k, Length<Unit, Rep>* out)
+    {
+        detail::multiply(as_values(in), as_values(out), n, k);
+        return out + n;
+    }
+
+    /** Shortest and longest of `n` lengths starting at `data`
+     *
+     * @return - {min, max}; for empty range it is {+inf, -inf} (or max/lowest value of integral `Rep`)
+     */
+    template <typename Unit, typename Rep>
+    [[nodiscard]] inline std::pair<Length<Unit, Rep>, Length<Unit, Rep>> minmax(const Length<Unit, Rep>* data, std::size_t n)
+    {
+        Rep lo{};
+        Rep hi{};
+        detail::minmax(as_values(data), n, lo, hi);
+        return {Length<Unit, Rep>{lo}, Length<Unit, Rep>{hi}};
+    }
+
+    /** Number of `n` lengths starting at `data` longer than `threshold`,
+     *  which is converted to `Unit` only once
+     *
+     * @example usage
+     *          1. std::size_t n = simd::count_greater(depths_mm.data(), depths_mm.size(), 3_in);
+     */
+    template <typename Unit, typename Rep, typename Unit2, typename Rep2>
+    [[nodiscard]] inline std::size_t count_greater(const Length<Unit, Rep>* data, std::size_t n, const Length<Unit2, Rep2>& threshold)
+    {
+        return detail::count_greater(as_values(data), n, detail::threshold_in<Unit, Rep>(threshold));
+    }
+
+#if defined(__cpp_lib_span)
+    template <typename Unit, typename Rep, std::size_t Extent>
+    [[nodiscard]] inline Length<Unit, Rep> sum(std::span<const Length<Unit, Rep>, Extent> data)
+    {
+        return sum(data.data(), data.size());
+    }
+
+    template <typename Unit, typename Rep, std::size_t Extent1, std::size_t Extent2>
+    inline std::span<Length<Unit, Rep>> scale(std::span<const Length<Unit, Rep>, Extent1> in, const length::detail::type_identity_t<Rep>& k,
+                                              std::span<Length<Unit, Rep>, Extent2> out)
+    {
+        const std::size_t n = std::min(in.size(), out.size());
+        scale(in.data(), n, k, out.data());
+        return out.first(n);
+    }
+
+    template <typename Unit, typename Rep, std::size_t Extent>
+    [[nodiscard]] inline std::pair<Length<Unit, Rep>, Length<Unit, Rep>> minmax(std::span<const Length<Unit, Rep>, Extent> data)
+    {
+        return minmax(data.data(), data.size());
+    }
+
+    template <typename Unit, typename Rep, std::size_t Extent, typename Unit2, typename Rep2>
+    [[nodiscard]] inline std::size_t count_greater(std::span<const Length<Unit, Rep>, Extent> data, const Length<Unit2, Rep2>& threshold)
+    {
+        return count_greater(data.data(), data.size(), threshold);
+    }
+#endif
+}
@@ -0,0 +1,334 @@
+/*********************************************************************************
+ *
+ *  MIT License
+ *
+ *  Copyright (c) 2017 Nenad Zikic
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ *********************************************************************************/
+
+
+#pragma once
+
+#include "length.hpp"
+#include "bulk.hpp"
+#include "length_array.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+
+
+// Streaming unit conversion for unbounded feeds.
+//
+// Producer pushes single lengths or runs of them, which are staged into fixed size,
+// cache resident blocks inside a bounded ring. Full block is converted with the
+// bulk kernels in place and handed to the consumer through lock-free single
+// producer / single consumer indices, so there is no allocation or copy after
+// construction. Partial blocks leave early after a sample count or a latency
+// deadline, trading throughput for latency.
+
+namespace length
+{
+
+    namespace detail
+    {
+        /** Bytes of values in a single stream block, fits in L1 with room to spare **/
+        inline constexpr std::size_t stream_block_bytes = 16 * 1024;
+
+        template <typename Rep>
+        inline constexpr std::size_t stream_block_size = std::max<std::size_t>(1, stream_block_bytes / sizeof(Rep));
+
+        /** Separates producer and consumer indices so they don't share a cache line **/
+        inline constexpr std::size_t stream_index_alignment = 64;
+    }
+
+    /** When `LengthStream` hands a partially filled block downstream
+     *
+     * @param samples - block is published once it holds that many lengths, 0 or anything
+     *                  above the block size means full blocks only
+     * @param latency - block is published once its oldest length is that old, zero means no
+     *                  deadline. It is checked by `push` every few lengths, as often as the
+     *                  producer's recent rate needs to meet it, and by `poll`; producer that
+     *                  stops pushing has to call `poll` for the last block to leave in time
+     */
+    struct flush_policy
+    {
+        std::size_t               samples = 0;
+        std::chrono::microseconds latency{0};
+    };
+
+    /** Bounded single producer / single consumer stream converting `FromUnit` lengths to `ToUnit`
+     *
+     * Producer side (one thread): `push`, `poll`, `flush`.
+     * Consumer side (one thread): `consume`, `pull`.
+     * `push` returns false instead of blocking when all blocks are waiting on the consumer.
+     *
+     * @example usage
+     *          1. LengthStream<foot, metre> lidar{16, {0, std::chrono::microseconds{500}}};
+     *             lidar.push(Length<foot>{sample});                           // sensor thread
+     *             lidar.consume([](LengthArrayView<metre> block) { ... });    // ingest thread
+     */
+    template <typename FromUnit, typename ToUnit, typename Rep = double, std::size_t BlockSize = detail::stream_block_size<Rep>>
+    class LengthStream
+    {
+            static_assert (BlockSize > 0, "`LengthStream` block size must be positive");
+            static_assert (std::is_trivially_copyable_v<Rep>, "`LengthStream` `Rep` must be trivially copyable");
+
+            using clock = std::chrono::steady_clock;
+
+            struct alignas(detail::array_alignment) block
+            {
+                Rep         values[BlockSize];
+                std::size_t size;
+            };
+
+            /** Most pushed lengths between clock reads while a latency deadline is set **/
+            static constexpr std::size_t max_deadline_check_interval = 64;
+
+            std::unique_ptr<block[]> m_blocks;
+            std::size_t              m_capacity;
+            std::size_t              m_flush_samples;
+            clock::duration          m_latency;
+
+            // producer
+            alignas(detail::stream_index_alignment) std::atomic<std::size_t> m_tail{0};
+            std::size_t       m_head_cache = 0;
+            std::size_t       m_fill       = 0;
+            std::size_t       m_unchecked  = 0;
+            std::size_t       m_check_interval = 1;
+            clock::time_point m_block_start;
+            clock::time_point m_last_check;
+
+            // consumer
+            alignas(detail::stream_index_alignment) std::atomic<std::size_t> m_head{0};
+            std::size_t m_tail_cache  = 0;
+            std::size_t m_read_offset = 0;
+
+            [[nodiscard]] bool has_latency() const { return m_latency != clock::duration::zero(); }
+
+            [[nodiscard]] block& staging() { return m_blocks[m_tail.load(std::memory_order_relaxed) % m_capacity]; }
+
+            /** Makes sure staging block is owned by the producer, false if the ring is full **/
+            bool acquire()
+            {
+                if (m_fill != 0)
+                {
+                    return true;
+                }
+                const std::size_t tail = m_tail.load(std::memory_order_relaxed);
+                if (tail - m_head_cache == m_capacity)
+                {
+                    m_head_cache = m_head.load(std::memory_order_acquire);
+                    if (tail - m_head_cache == m_capacity)
+                    {
+                        return false;
+                    }
+                }
+                if (has_latency())
+                {
+                    m_block_start = clock::now();
+                }
+                return true;
+            }
+
+            [[nodiscard]] bool deadline_passed(clock::time_point now) const { return now - m_block_start >= m_latency; }
+
+            void publish()
+            {
+                block& b = staging();
+                b.size   = m_fill;
+                convert_in_place<FromUnit, ToUnit>(as_lengths<FromUnit>(b.values), m_fill);
+                m_fill = 0;
+                m_tail.store(m_tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+            }
+
+            /** Lengths to push before next clock read, about as many as arrived in 1/8 of the latency
+             *  at the rate since the previous read (across blocks), so slow producers check every push
+             *  and fast ones rarely read the clock
+             */
+            void adapt_check_interval(clock::duration elapsed)
+            {
+                const double per_eighth = elapsed > clock::duration::zero()
+                    ? static_cast<double>(m_unchecked) * static_cast<double>(m_latency.count()) / (8.0 * static_cast<double>(elapsed.count()))
+                    : static_cast<double>(max_deadline_check_interval);
+                m_check_interval = static_cast<std::size_t>(std::clamp(per_eighth, 1.0, static_cast<double>(max_deadline_check_interval)));
+            }
+
+            /** Publishes staging block if it reached sample count or, now and then, its deadline **/
+            void maybe_publish(std::size_t pushed)
+            {
+                if (m_fill >= m_flush_samples)
+                {
+                    publish();
+                }
+                else if (has_latency() && (m_unchecked += pushed) >= m_check_interval)
+                {
+                    const clock::time_point now = clock::now();
+                    adapt_check_interval(now - m_last_check);
+                    m_last_check = now;
+                    m_unchecked  = 0;
+                    if (deadline_passed(now))
+                    {
+                        publish();
+                    }
+                }
+            }
+
+        public:
+            using from_unit  = FromUnit;
+            using to_unit    = ToUnit;
+            using rep        = Rep;
+            using input_type = Length<FromUnit, Rep>;
+            using value_type = Length<ToUnit, Rep>;
+            using size_type  = std::size_t;
+
+            static constexpr size_type block_size = BlockSize;
+
+            /** Stream of `blocks` blocks of `BlockSize` lengths, all allocated up front **/
+            explicit LengthStream(size_type blocks = 8, flush_policy policy = {})
+                : m_blocks{new block[std::max<size_type>(1, blocks)]},
+                  m_capacity{std::max<size_type>(1, blocks)},
+                  m_flush_samples{policy.samples == 0 ? BlockSize : std::min(policy.samples, BlockSize)},
+                  m_latency{std::chrono::duration_cast<clock::duration>(policy.latency)}
+            {
+            }
+
+            LengthStream(const LengthStream&) = delete;
+            LengthStream& operator=(const LengthStream&) = delete;
+
+            [[nodiscard]] size_type capacity() const { return m_capacity; }
+
+            // producer side
+
+            /** Stages single length, false if the ring is full and `length` was not taken **/
+            bool push(input_type length)
+            {
+                if (!acquire())
+                {
+                    return false;
+                }
+                staging().values[m_fill++] = length.value();
+                maybe_publish(1);
+                return true;
+            }
+
+            /** Stages up to `n` lengths from `in`
+             *
+             * @return - number of lengths taken, less than `n` only when the ring filled up
+             */
+            size_type push(const input_type* in, size_type n)
+            {
+                size_type taken = 0;
+                while (taken < n && acquire())
+                {
+                    const size_type count = std::min(n - taken, m_flush_samples - m_fill);
+                    std::copy_n(as_values(in + taken), count, staging().values + m_fill);
+                    m_fill += count;
+                    taken  += count;
+                    maybe_publish(count);
+                }
+                return taken;
+            }
+
+            /** Publishes staged lengths whose deadline has passed, for producers going idle on a timer
+             *
+             * @return - true if block was published
+             */
+            bool poll()
+            {
+                if (m_fill != 0 && has_latency() && deadline_passed(clock::now()))
+                {
+                    publish();
+                    return true;
+                }
+                return false;
+            }
+
+            /** Publishes staged lengths regardless of the policy, e.g. at end of stream **/
+            void flush()
+            {
+                if (m_fill != 0)
+                {
+                    publish();
+                }
+            }
+
+            // consumer side
+
+            /** Passes oldest published block to `f` as `LengthArrayView<ToUnit, Rep>` and releases it
+             *
+             * View is valid only during the call.
+             * @return - false if there was no published block
+             */
+            template <typename F>
+            bool consume(F&& f)
+            {
+                const std::size_t head = m_head.load(std::memory_order_relaxed);
+                if (head == m_tail_cache)
+                {
+                    m_tail_cache = m_tail.load(std::memory_order_acquire);
+                    if (head == m_tail_cache)
+                    {
+                        return false;
+                    }
+                }
+                const block& b = m_blocks[head % m_capacity];
+                f(LengthArrayView<ToUnit, Rep>{as_lengths<ToUnit>(b.values) + m_read_offset, b.size - m_read_offset});
+                m_read_offset = 0;
+                m_head.store(head + 1, std::memory_order_release);
+                return true;
+            }
+
+            /** Copies up to `capacity` converted lengths into `out`, across block boundaries
+             *
+             * @return - pointer one past the last written length
+             */
+            value_type* pull(value_type* out, size_type capacity)
+            {
+                while (capacity != 0)
+                {
+                    const std::size_t head = m_head.load(std::memory_order_relaxed);
+                    if (head == m_tail_cache)
+                    {
+                        m_tail_cache = m_tail.load(std::memory_order_acquire);
+                        if (head == m_tail_cache)
+                        {
+                            break;
+                        }
+                    }
+                    const block&    b     = m_blocks[head % m_capacity];
+                    const size_type count = std::min(capacity, b.size - m_read_offset);
+                    out = std::copy_n(as_lengths<ToUnit>(b.values) + m_read_offset, count, out);
+                    capacity      -= count;
+                    m_read_offset += count;
+                    if (m_read_offset == b.size)
+                    {
+                        m_read_offset = 0;
+                        m_head.store(head + 1, std::memory_order_release);
+                    }
+                }
+                return out;
+            }
+    };
+}
@@ -0,0 +1,335 @@
+/*********************************************************************************
+ *
+ *  MIT License
+ *
+ *  Copyright (c) 2017 Nenad Zikic
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ *********************************************************************************/
+
+
+#pragma once
+
+#include "length.hpp"
+#include "dimension.hpp"
+#include "simd.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+
+
+// Three dimensional displacements (`Vec3`) and positions (`Point3`) of lengths.
+//
+// Both are packed triples of `Length`, i.e. exactly 3 * sizeof(Rep) bytes with
+// no padding, so arrays of them are plain interleaved x/y/z values that bulk
+// kernels process directly.
+
+namespace length
+{
+
+    /** Displacement with `x`, `y` and `z` components measured in `Unit` **/
+    template <typename Unit, typename Rep = double>
+    struct Vec3
+    {
+            using unit = Unit;
+            using rep  = Rep;
+
+            Length<Unit, Rep> x;
+            Length<Unit, Rep> y;
+            Length<Unit, Rep> z;
+    };
+
+    /** Position with `x`, `y` and `z` coordinates measured in `Unit`;
+     *  points differ by `Vec3` and can be moved by one, but not added together
+     */
+    template <typename Unit, typename Rep = double>
+    struct Point3
+    {
+            using unit = Unit;
+            using rep  = Rep;
+
+            Length<Unit, Rep> x;
+            Length<Unit, Rep> y;
+            Length<Unit, Rep> z;
+    };
+
+    /** Read only columns of points stored as separate x/y/z arrays (struct of arrays) of `Unit` **/
+    template <typename Unit, typename Rep = double>
+    struct Point3Columns
+    {
+            const Rep* x;
+            const Rep* y;
+            const Rep* z;
+    };
+
+    template <typename FromUnit, typename ToUnit, typename Rep>
+    [[nodiscard]] constexpr Vec3<ToUnit, Rep> convert(const Vec3<FromUnit, Rep>& from)
+    {
+        return {convert<FromUnit, ToUnit>(from.x), convert<FromUnit, ToUnit>(from.y), convert<FromUnit, ToUnit>(from.z)};
+    }
+
+    template <typename FromUnit, typename ToUnit, typename Rep>
+    [[nodiscard]] constexpr Point3<ToUnit, Rep> convert(const Point3<FromUnit, Rep>& from)
+    {
+        return {convert<FromUnit, ToUnit>(from.x), convert<FromUnit, ToUnit>(from.y), convert<FromUnit, ToUnit>(from.z)};
+    }
+
+    // comparison
+
+    template <typename Unit1, typename Rep1, typename Unit2, typename Rep2>
+    [[nodiscard]] constexpr bool operator==(const Vec3<Unit1, Rep1>& lhs, const Vec3<Unit2, Rep2>& rhs)
+    {
+        return lhs.x == rhs.x && lhs.y == rhs.y && lhs.z == rhs.z;
+    }
+
+    template <typename Unit1, typename Rep1, typename Unit2, typename Rep2>
+    [[nodiscard]] constexpr bool operator==(const Point3<Unit1, Rep1>& lhs, const Point3<Unit2, Rep2>& rhs)
+    {
+        return lhs.x == rhs.x && lhs.y == rhs.y && lhs.z == rhs.z;
+    }
+
+    // arithmetic, results are in units of lhs (common unit with `LENGTH_COMMON_UNIT_ARITHMETIC`) like `Length` operators
+
+    namespace detail
+    {
+        template <typename Unit1, typename Rep1, typename Unit2, typename Rep2>
+        using additive_unit_t = typename additive_result_t<Unit1, Rep1, Unit2, Rep2>::unit;
+    }
+
+    template <typename Unit1, typename Rep1, typename Unit2, typename Rep2>
+    [[nodiscard]] constexpr Vec3<detail::additive_unit_t<Unit1, Rep1, Unit2, Rep2>, detail::common_rep_t<Rep1, Rep2>> operator+ (const Vec3<Unit1, Rep1>& lhs, const Vec3<Unit2, Rep2>& rhs)
+    {
+        return {lhs.x + rhs.x, lhs.y + rhs.y, lhs.z + rhs.z};
+    }
+
+    template <typename Unit1, typename Rep1, typename Unit2, typename Rep2>
+    [[nodiscard]] constexpr Vec3<detail::additive_unit_t<Unit1, Rep1, Unit2, Rep2>, detail::common_rep_t<Rep1, Rep2>> operator- (const Vec3<Unit1, Rep1>& lhs, const Vec3<Unit2, Rep2>& rhs)
+    {
+        return {lhs.x - rhs.x, lhs.y - rhs.y, lhs.z - rhs.z};
+    }
+
+    template <typename Unit1, typename Rep1, typename Unit2, typename Rep2>
+    [[nodiscard]] constexpr Vec3<detail::additive_unit_t<Unit1, Rep1, Unit2, Rep2>, detail::common_rep_t<Rep1, Rep2>> operator- (const Point3<Unit1, Rep1>& lhs, const Point3<Unit2, Rep2>& rhs)
+    {
+        return {lhs.x - rhs.x, lhs.y - rhs.y, lhs.z - rhs.z};
+    }
+
+    template <typename Unit1, typename Rep1, typename Unit2, typename Rep2>
+    [[nodiscard]] constexpr Point3<detail::additive_unit_t<Unit1, Rep1, Unit2, Rep2>, detail::common_rep_t<Rep1, Rep2>> operator+ (const Point3<Unit1, Rep1>& lhs, const Vec3<Unit2, Rep2>& rhs)
+    {
+        return {lhs.x + rhs.x, lhs.y + rhs.y, lhs.z + rhs.z};
+    }
+
+    template <typename Unit1, typename Rep1, typename Unit2, typename Rep2>
+    [[nodiscard]] constexpr Point3<detail::additive_unit_t<Unit1, Rep1, Unit2, Rep2>, detail::common_rep_t<Rep1, Rep2>> operator- (const Point3<Unit1, Rep1>& lhs, const Vec3<Unit2, Rep2>& rhs)
+    {
+        return {lhs.x - rhs.x, lhs.y - rhs.y, lhs.z - rhs.z};
+    }
+
+    template <typename Unit, typename Rep, LENGTH_SCALAR_PARAM(Rep, K)>
+    [[nodiscard]] constexpr Vec3<Unit, detail::common_rep_t<Rep, K>> operator* (const K& k, const Vec3<Unit, Rep>& v)
+    {
+        return {k * v.x, k * v.y, k * v.z};
+    }
+
+    template <typename Unit, typename Rep, LENGTH_SCALAR_PARAM(Rep, K)>
+    [[nodiscard]] constexpr Vec3<Unit, detail::common_rep_t<Rep, K>> operator* (const Vec3<Unit, Rep>& v, const K& k)
+    {
+        return {v.x * k, v.y * k, v.z * k};
+    }
+
+    template <typename Unit, typename Rep, LENGTH_SCALAR_PARAM(Rep, K)>
+    [[nodiscard]] constexpr Vec3<Unit, detail::common_rep_t<Rep, K>> operator/ (const Vec3<Unit, Rep>& v, const K& k)
+    {
+        return {v.x / k, v.y / k, v.z / k};
+    }
+
+    /** Dot product as `Area` in units of lhs
+     *
+     * @example usage
+     *          1. Area<metre> a = dot(Vec3<metre>{1_m, 2_m, 0_m}, Vec3<centimetre>{100_cm, 50_cm, 7_cm}); // 2 m^2
+     */
+    template <typename Unit1, typename Rep1, typename Unit2, typename Rep2>
+    [[nodiscard]] constexpr Area<Unit1, detail::common_rep_t<Rep1, Rep2>> dot(const Vec3<Unit1, Rep1>& lhs, const Vec3<Unit2, Rep2>& rhs)
+    {
+        return lhs.x * rhs.x + lhs.y * rhs.y + lhs.z * rhs.z;
+    }
+
+    /** Euclidean length of `v`, computed with `std::hypot` so it neither overflows nor underflows **/
+    template <typename Unit, typename Rep>
+    [[nodiscard]] inline Length<Unit, Rep> norm(const Vec3<Unit, Rep>& v)
+    {
+        return Length<Unit, Rep>{static_cast<Rep>(std::hypot(v.x.value(), v.y.value(), v.z.value()))};
+    }
+
+    /** Euclidean distance between points, in units of `lhs - rhs` **/
+    template <typename Unit1, typename Rep1, typename Unit2, typename Rep2>
+    [[nodiscard]] inline Length<detail::additive_unit_t<Unit1, Rep1, Unit2, Rep2>, detail::common_rep_t<Rep1, Rep2>> distance(const Point3<Unit1, Rep1>& lhs, const Point3<Unit2, Rep2>& rhs)
+    {
+        return norm(lhs - rhs);
+    }
+
+    // bulk operations over arrays of points and vectors
+
+    namespace detail
+    {
+        /** Points deinterleaved per block by `distance_n`, sized so both point sets stay in L1 **/
+        inline constexpr std::size_t distance_block = 256;
+
+        template <typename FromUnit, typename ToUnit, typename Rep>
+        void convert_values_n(const Rep* src, std::size_t n, Rep* dst)
+        {
+            using r = conversion_ratio<FromUnit, ToUnit>;
+
+            if constexpr (r::num == 1 && r::den == 1)
+            {
+                if (src != dst)
+                {
+                    std::copy_n(src, n, dst);
+                }
+            }
+            else if constexpr (std::is_floating_point_v<Rep>)
+            {
+                simd::detail::multiply(src, dst, n, conversion_factor<Rep, r>);
+            }
+            else
+            {
+                for (std::size_t i = 0; i < n; ++i)
+                {
+                    dst[i] = rescale<r>(src[i]);
+                }
+            }
+        }
+    }
+
+    /** Converts `n` vectors of `FromUnit` starting at `in` into `ToUnit` vectors at `out`,
+     *  as one vectorised pass over the 3 * n interleaved components
+     *
+     * @return - pointer one past the last written vector
+     */
+    template <typename FromUnit, typename ToUnit, typename Rep>
+    Vec3<ToUnit, Rep>* convert_n(const Vec3<FromUnit, Rep>* in, std::size_t n, Vec3<ToUnit, Rep>* out)
+    {
+        if (n == 0)
+        {
+            return out;   // `in` and `out` may be null, `&in->x` isn't formed
+        }
+        detail::convert_values_n<FromUnit, ToUnit>(as_values(&in->x), 3 * n, as_values(&out->x));
+        return out + n;
+    }
+
+    /** Converts `n` points of `FromUnit` starting at `in` into `ToUnit` points at `out` **/
+    template <typename FromUnit, typename ToUnit, typename Rep>
+    Point3<ToUnit, Rep>* convert_n(const Point3<FromUnit, Rep>* in, std::size_t n, Point3<ToUnit, Rep>* out)
+    {
+        if (n == 0)
+        {
+            return out;   // `in` and `out` may be null, `&in->x` isn't formed
+        }
+        detail::convert_values_n<FromUnit, ToUnit>(as_values(&in->x), 3 * n, as_values(&out->x));
+        return out + n;
+    }
+
+    /** Distances between `n` pairs of points stored as x/y/z columns, in units of `a`
+     *
+     * Struct of arrays feeds the vectorised kernel directly, rescaling of `b`
+     * into units of `a` is fused into it.
+     *
+     * @return - pointer one past the last written distance
+     *
+     * @example usage
+     *          1. distance_n(Point3Columns<millimetre>{xs, ys, zs}, Point3Columns<millimetre>{rxs, rys, rzs}, n, out);
+     */
+    template <typename Unit1, typename Unit2, typename Rep>
+    Length<Unit1, Rep>* distance_n(const Point3Columns<Unit1, Rep>& a, const Point3Columns<Unit2, Rep>& b,
+                                   std::size_t n, Length<Unit1, Rep>* out)
+    {
+        const Rep k = detail::conversion_factor<Rep, detail::conversion_ratio<Unit2, Unit1>>;
+        if constexpr (std::is_floating_point_v<Rep>)
+        {
+            simd::detail::distance(a.x, a.y, a.z, b.x, b.y, b.z, k, as_values(out), n);
+        }
+        else
+        {
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                out[i] = distance(Point3<Unit1, Rep>{Length<Unit1, Rep>{a.x[i]}, Length<Unit1, Rep>{a.y[i]}, Length<Unit1, Rep>{a.z[i]}},
+                                  convert<Unit2, Unit1>(Point3<Unit2, Rep>{Length<Unit2, Rep>{b.x[i]}, Length<Unit2, Rep>{b.y[i]}, Length<Unit2, Rep>{b.z[i]}}));
+            }
+        }
+        return out + n;
+    }
+
+    /** Distances between `n` pairs of interleaved points `a[i]` and `b[i]`, in units of `a`
+     *
+     * Points are deinterleaved into x/y/z columns a small block at a time,
+     * so the array of structs input still runs through the vectorised kernel.
+     * With `LENGTH_OFFLOAD` the whole range is offered to the backend first,
+     * blocks alone would never reach its threshold.
+     *
+     * @return - pointer one past the last written distance
+     */
+    template <typename Unit1, typename Unit2, typename Rep>
+    Length<Unit1, Rep>* distance_n(const Point3<Unit1, Rep>* a, const Point3<Unit2, Rep>* b, std::size_t n, Length<Unit1, Rep>* out)
+    {
+        if (n == 0)
+        {
+            return out;   // `a` and `b` may be null, `&a->x` isn't formed
+        }
+#if defined(LENGTH_OFFLOAD)
+        if constexpr (simd::detail::is_vectorised_v<Rep>)
+        {
+            const Rep k = detail::conversion_factor<Rep, detail::conversion_ratio<Unit2, Unit1>>;
+            if (::length::offload::detail::run_distance_interleaved(as_values(&a->x), as_values(&b->x), k, as_values(out), n))
+            {
+                return out + n;
+            }
+        }
+#endif
+        constexpr std::size_t block = detail::distance_block;
+        Rep columns[6][block];
+        for (std::size_t i = 0; i < n; i += block)
+        {
+            const std::size_t m = std::min(block, n - i);
+            for (std::size_t j = 0; j < m; ++j)
+            {
+                columns[0][j] = a[i + j].x.value();
+                columns[1][j] = a[i + j].y.value();
+                columns[2][j] = a[i + j].z.value();
+                columns[3][j] = b[i + j].x.value();
+                columns[4][j] = b[i + j].y.value();
+                columns[5][j] = b[i + j].z.value();
+            }
+            distance_n(Point3Columns<Unit1, Rep>{columns[0], columns[1], columns[2]},
+                       Point3Columns<Unit2, Rep>{columns[3], columns[4], columns[5]}, m, out + i);
+        }
+        return out + n;
+    }
+
+    //////////////////
+    // layout
+    //////////////////
+
+    static_assert (sizeof(Vec3<metre>) == 3 * sizeof(double) && sizeof(Point3<millimetre, float>) == 3 * sizeof(float));
+    static_assert (std::is_standard_layout_v<Point3<metre>> && std::is_trivially_copyable_v<Point3<metre>>);
+    static_assert (std::is_trivially_destructible_v<Vec3<metre>> && std::is_aggregate_v<Vec3<metre>>);
+
+}
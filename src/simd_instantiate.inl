@@ -0,0 +1,51 @@
+/*********************************************************************************
+ *
+ *  MIT License
+ *
+ *  Copyright (c) 2017 Nenad Zikic
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ *********************************************************************************/
+
+
+
+// Explicit instantiations of one instruction set's kernels for `length_simd` library.
+// Included by `simd_<isa>.cpp` after it defines `LENGTH_SIMD_LIBRARY_ISA` as name
+// of the ISA namespace in `simd_isa.hpp`.
+
+namespace length::simd::detail::LENGTH_SIMD_LIBRARY_ISA
+{
+
+#define LENGTH_SIMD_INSTANTIATE(T)                                                                          \
+    template void        multiply<T>(const T*, T*, std::size_t, T);                                        \
+    template void        add_scaled<T>(const T*, const T*, T, T*, std::size_t);                            \
+    template void        divide<T>(const T*, T*, std::size_t, T);                                          \
+    template T           sum<T>(const T*, std::size_t);                                                    \
+    template void        compensated_sum<T>(const T*, std::size_t, T, T&, T&);                             \
+    template void        minmax<T>(const T*, std::size_t, T&, T&);                                         \
+    template std::size_t count_greater<T>(const T*, std::size_t, T);                                       \
+    template void        distance<T>(const T*, const T*, const T*, const T*, const T*, const T*, T, T*, std::size_t);
+
+    LENGTH_SIMD_INSTANTIATE(double)
+    LENGTH_SIMD_INSTANTIATE(float)
+
+#undef LENGTH_SIMD_INSTANTIATE
+
+}
@@ -0,0 +1,149 @@
+#
+# Checks disassembly of codegen object files, run by ctest as
+#
+#   cmake -DOBJDUMP=<objdump> -DOBJECT=<object file> -DMODE=<mode> -P check_codegen.cmake
+#
+# Modes:
+#   fold - every `fold_*` function meets the expectation named by its suffix, see fold.cpp
+#   same - every `raw_*` function has the same instructions, up to register allocation and
+#          order, and the same code size as its `length_*` counterpart, see zero_overhead.cpp
+#
+
+foreach (var OBJDUMP OBJECT MODE)
+    if (NOT DEFINED ${var})
+        message (FATAL_ERROR "check_codegen: ${var} is not set")
+    endif ()
+endforeach ()
+
+execute_process (
+    COMMAND ${OBJDUMP} -d --no-show-raw-insn ${OBJECT}
+    OUTPUT_VARIABLE disassembly
+    RESULT_VARIABLE result
+)
+if (NOT result EQUAL 0)
+    message (FATAL_ERROR "check_codegen: ${OBJDUMP} failed on ${OBJECT}")
+endif ()
+
+# instructions of every function, one per line, without addresses, comments and symbol operands
+string (REPLACE "\n" ";" lines "${disassembly}")
+set (functions)
+set (function)
+foreach (line IN LISTS lines)
+    if (line MATCHES "^[0-9a-f]+ <([A-Za-z_0-9]+)>:$")
+        set (function ${CMAKE_MATCH_1})
+        list (APPEND functions ${function})
+        set (code_${function})
+    elseif (function AND line MATCHES "^ +[0-9a-f]+:\t(.*)$")
+        string (REGEX REPLACE "[ \t]*(#.*|<[^>]*>)$" "" instruction "${CMAKE_MATCH_1}")
+        string (REGEX REPLACE "[ \t]+" " " instruction "${instruction}")
+        string (STRIP "${instruction}" instruction)
+        if (NOT instruction MATCHES "^(endbr64|nop|data16|xchg %ax,%ax|cs nopw)")
+            list (APPEND code_${function} "${instruction}")
+        endif ()
+    endif ()
+endforeach ()
+
+function (fail function message)
+    list (JOIN code_${function} "\n    " code)
+    message (SEND_ERROR "${function}: ${message}\n    ${code}")
+endfunction ()
+
+# number of instructions of `function` matching `regex`
+function (count_instructions function regex out)
+    set (n 0)
+    foreach (instruction IN LISTS code_${function})
+        if (instruction MATCHES "${regex}")
+            math (EXPR n "${n} + 1")
+        endif ()
+    endforeach ()
+    set (${out} ${n} PARENT_SCOPE)
+endfunction ()
+
+# sorted mnemonics of instructions of `function`
+function (mnemonics function out)
+    set (names)
+    foreach (instruction IN LISTS code_${function})
+        string (REGEX REPLACE " .*$" "" name "${instruction}")
+        list (APPEND names ${name})
+    endforeach ()
+    list (SORT names)
+    set (${out} "${names}" PARENT_SCOPE)
+endfunction ()
+
+if (MODE STREQUAL "fold")
+    set (checked 0)
+    foreach (function IN LISTS functions)
+        if (NOT function MATCHES "^fold_")
+            continue ()
+        endif ()
+        math (EXPR checked "${checked} + 1")
+
+        count_instructions (${function} "^(v?[a-z]*div|call)" divides)
+        count_instructions (${function} "^v?[a-z]*mul" multiplies)
+        count_instructions (${function} "^v[a-z]*mulp[sd] .*%ymm[0-9]+$" vector_multiplies)
+        list (LENGTH code_${function} instructions)
+
+        if (divides GREATER 0)
+            fail (${function} "divides or calls")
+        elseif (function MATCHES "_none$" AND NOT instructions EQUAL 1)
+            fail (${function} "expected return only")
+        elseif (function MATCHES "_one_multiply$" AND NOT multiplies EQUAL 1)
+            fail (${function} "expected exactly one multiply, found ${multiplies}")
+        elseif (function MATCHES "_vector_multiply$" AND NOT vector_multiplies EQUAL 1)
+            fail (${function} "expected exactly one full width vector multiply, found ${vector_multiplies}")
+        endif ()
+    endforeach ()
+
+    if (checked EQUAL 0)
+        message (FATAL_ERROR "check_codegen: no fold_* functions in ${OBJECT}")
+    endif ()
+    message (STATUS "check_codegen: ${checked} fold_* functions checked")
+elseif (MODE STREQUAL "same")
+    # code size of every function from its own section, objects are built with -ffunction-sections
+    execute_process (
+        COMMAND ${OBJDUMP} -h ${OBJECT}
+        OUTPUT_VARIABLE headers
+        RESULT_VARIABLE result
+    )
+    if (NOT result EQUAL 0)
+        message (FATAL_ERROR "check_codegen: ${OBJDUMP} -h failed on ${OBJECT}")
+    endif ()
+    string (REPLACE "\n" ";" lines "${headers}")
+    foreach (line IN LISTS lines)
+        if (line MATCHES "^ *[0-9]+ \\.text\\.([A-Za-z_0-9]+) +([0-9a-f]+) ")
+            set (size_${CMAKE_MATCH_1} ${CMAKE_MATCH_2})
+        endif ()
+    endforeach ()
+
+    set (checked 0)
+    foreach (function IN LISTS functions)
+        if (NOT function MATCHES "^raw_(.*)$")
+            continue ()
+        endif ()
+        set (counterpart length_${CMAKE_MATCH_1})
+        math (EXPR checked "${checked} + 1")
+
+        list (FIND functions ${counterpart} found)
+        if (found EQUAL -1)
+            fail (${function} "no ${counterpart} to compare with")
+            continue ()
+        endif ()
+
+        # register allocation and scheduling may differ, the sorted mnemonics may not
+        mnemonics (${function} raw)
+        mnemonics (${counterpart} wrapped)
+        if (NOT raw STREQUAL wrapped)
+            list (JOIN code_${counterpart} "\n    " code)
+            fail (${function} "instructions differ from ${counterpart}\n  ${counterpart}:\n    ${code}\n  ${function}:")
+        elseif (NOT DEFINED size_${function} OR NOT size_${function} STREQUAL size_${counterpart})
+            fail (${function} "code size 0x${size_${function}} differs from 0x${size_${counterpart}} of ${counterpart}")
+        endif ()
+    endforeach ()
+
+    if (checked EQUAL 0)
+        message (FATAL_ERROR "check_codegen: no raw_* functions in ${OBJECT}")
+    endif ()
+    message (STATUS "check_codegen: ${checked} raw_* functions compared with length_*")
+else ()
+    message (FATAL_ERROR "check_codegen: unknown mode ${MODE}")
+endif ()
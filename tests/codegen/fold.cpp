@@ -0,0 +1,87 @@
+/*********************************************************************************
+ *
+ *  MIT License
+ *
+ *  Copyright (c) 2017 Nenad Zikic
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ *********************************************************************************/
+
+
+// Conversion folding, checked on disassembly by check_codegen.cmake (mode `fold`).
+//
+// Every `fold_*` function is compiled only, never run. Suffix of its name is the
+// expectation checked against its instructions, none of them may divide or call:
+//
+//  - `_none`            - no instructions apart from return,
+//  - `_one_multiply`    - exactly one multiply,
+//  - `_no_divide`       - multiplies or shifts only,
+//  - `_vector_multiply` - vectorised loop, exactly one full width multiply per vector.
+
+#include <length/length.hpp>
+
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__clang__)
+#define LENGTH_CODEGEN_SINGLE_VECTOR _Pragma("clang loop interleave_count(1) unroll(disable)")
+#else
+#define LENGTH_CODEGEN_SINGLE_VECTOR
+#endif
+
+using namespace length;
+
+extern "C"
+{
+    double fold_identity_none(double v)
+    {
+        return convert<metre, metre>(Length<metre>{v}).value();
+    }
+
+    double fold_inch_to_foot_one_multiply(double v)
+    {
+        return convert<inch, foot>(Length<inch>{v}).value();
+    }
+
+    float fold_millimetre_to_mile_one_multiply(float v)
+    {
+        return convert<millimetre, mile>(Length<millimetre, float>{v}).value();
+    }
+
+    std::int64_t fold_foot_to_inch_no_divide(std::int64_t v)
+    {
+        return convert<foot, inch>(Length<foot, std::int64_t>{v}).value();
+    }
+
+    std::int32_t fold_metre_to_micrometre_no_divide(std::int32_t v)
+    {
+        return convert<metre, micrometre>(Length<metre, std::int32_t>{v}).value();
+    }
+
+    __attribute__((target("avx2")))
+    void fold_inch_to_foot_vector_multiply(const Length<inch>* in, Length<foot>* out, std::size_t n)
+    {
+        LENGTH_CODEGEN_SINGLE_VECTOR
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            out[i] = convert<inch, foot>(in[i]);
+        }
+    }
+}
@@ -0,0 +1,149 @@
+/*********************************************************************************
+ *
+ *  MIT License
+ *
+ *  Copyright (c) 2017 Nenad Zikic
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ *********************************************************************************/
+
+
+
+// Zero overhead, checked on disassembly by check_codegen.cmake (mode `same`).
+//
+// Every reference kernel is written twice, once on raw `double` as `raw_*` and
+// once on lengths as `length_*`. Both are compiled only, never run, and have to
+// compile to the same instructions and the same code size.
+
+#include <length/length.hpp>
+#include <length/vec3.hpp>
+
+#include <cstddef>
+
+using namespace length;
+
+struct raw_vec3
+{
+    double x;
+    double y;
+    double z;
+};
+
+extern "C"
+{
+    double raw_sum(const double* in, std::size_t n)
+    {
+        double total = 0.0;
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            total += in[i];
+        }
+        return total;
+    }
+
+    double length_sum(const Length<metre>* in, std::size_t n)
+    {
+        Length<metre> total{0.0};
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            total += in[i];
+        }
+        return total.value();
+    }
+
+    double raw_mixed_add(double m, double cm)
+    {
+        return m + cm * 0.01;
+    }
+
+    double length_mixed_add(double m, double cm)
+    {
+        return (Length<metre>{m} + Length<centimetre>{cm}).value();
+    }
+
+    void raw_scale(const double* in, double* out, double k, std::size_t n)
+    {
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            out[i] = in[i] * k;
+        }
+    }
+
+    void length_scale(const Length<metre>* in, Length<metre>* out, double k, std::size_t n)
+    {
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            out[i] = in[i] * k;
+        }
+    }
+
+    void raw_inch_to_millimetre(const double* in, double* out, std::size_t n)
+    {
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            out[i] = in[i] * 25.4;
+        }
+    }
+
+    void length_inch_to_millimetre(const Length<inch>* in, Length<millimetre>* out, std::size_t n)
+    {
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            out[i] = convert<inch, millimetre>(in[i]);
+        }
+    }
+
+    std::size_t raw_count_less(const double* in, double threshold, std::size_t n)
+    {
+        std::size_t count = 0;
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            count += in[i] < threshold;
+        }
+        return count;
+    }
+
+    std::size_t length_count_less(const Length<metre>* in, double threshold, std::size_t n)
+    {
+        const Length<metre> limit{threshold};
+        std::size_t count = 0;
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            count += in[i] < limit;
+        }
+        return count;
+    }
+
+    void raw_vec3_add(const raw_vec3* a, const raw_vec3* b, raw_vec3* out, std::size_t n)
+    {
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            out[i] = {a[i].x + b[i].x, a[i].y + b[i].y, a[i].z + b[i].z};
+        }
+    }
+
+    void length_vec3_add(const Vec3<metre>* a, const Vec3<metre>* b, Vec3<metre>* out, std::size_t n)
+    {
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            out[i] = a[i] + b[i];
+        }
+    }
+}
@@ -0,0 +1,52 @@
+/*********************************************************************************
+ *
+ *  MIT License
+ *
+ *  Copyright (c) 2017 Nenad Zikic
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ *********************************************************************************/
+
+
+// Compile-time self tests of accumulator.hpp: compensated `LengthAccumulator` sums in constant expressions.
+
+#include <length/accumulator.hpp>
+
+
+namespace length
+{
+    static_assert ([]
+    {
+        LengthAccumulator<metre> acc;
+        acc += 1_m;
+        acc += Length<metre>{1e100};
+        acc += Length<metre>{-1e100};
+        return acc.total() == 1_m;
+    }());
+
+    static_assert ([]
+    {
+        LengthAccumulator<millimetre> a{1_mm};
+        LengthAccumulator<metre>      b{1_m};
+        a += b;
+        a += 1_in;
+        return a.total() == Length<millimetre>{1026.4};
+    }());
+}
@@ -0,0 +1,42 @@
+/*********************************************************************************
+ *
+ *  MIT License
+ *
+ *  Copyright (c) 2017 Nenad Zikic
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ *********************************************************************************/
+
+
+// Compile-time self tests of algorithm.hpp: search keys of sorted range algorithms, rounded towards the searched side.
+
+#include <length/algorithm.hpp>
+
+#include <cstdint>
+
+
+namespace length
+{
+    static_assert (detail::search_key<millimetre, std::int64_t, detail::key_rounding::up>(Length<inch, std::int64_t>{1}) == 26);
+    static_assert (detail::search_key<millimetre, std::int64_t, detail::key_rounding::down>(Length<inch, std::int64_t>{1}) == 25);
+    static_assert (detail::search_key<millimetre, std::int64_t, detail::key_rounding::up>(Length<inch, std::int64_t>{-1}) == -25);
+    static_assert (detail::search_key<millimetre, std::int64_t, detail::key_rounding::down>(Length<inch, std::int64_t>{-1}) == -26);
+    static_assert (detail::search_key<inch, std::int64_t, detail::key_rounding::up>(Length<foot, std::int64_t>{2}) == 24);
+}
@@ -0,0 +1,56 @@
+/*********************************************************************************
+ *
+ *  MIT License
+ *
+ *  Copyright (c) 2017 Nenad Zikic
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ *********************************************************************************/
+
+
+// Compile-time self tests of dimension.hpp: `Area` and `Volume` result types, arithmetic and conversions.
+
+#include <length/dimension.hpp>
+
+#include <cstdint>
+#include <type_traits>
+
+
+namespace length
+{
+    static_assert (std::is_same_v<decltype(2_m * 3_m), Area<metre>>);
+    static_assert (std::is_same_v<decltype(2_m * 3_m * 4_cm), Volume<metre>>);
+    static_assert (std::is_same_v<decltype(Volume<metre>{1} / Area<foot>{1}), Length<metre>>);
+    static_assert (std::is_same_v<decltype(Area<metre>{1} / Area<foot>{1}), double>);
+    static_assert (2_m * 50_cm == Area<metre>{1});
+    static_assert (Area<foot>{2} * 6_in == Volume<foot>{1});
+    static_assert (Volume<metre>{6} / Area<metre>{2} == 3_m);
+    static_assert (Area<metre>{6} / 3_m == 2_m);
+    static_assert (Area<inch>{288} / Area<foot>{1} == 2.0);
+
+    static_assert (convert<foot, inch>(Area<foot>{1}) == Area<inch>{144});
+    static_assert (convert<metre, centimetre>(Volume<metre>{1}).value() == 1000000);
+    static_assert (convert<foot, inch>(Area<foot, std::int64_t>{3}).value() == 432);
+    static_assert (convert<mile, nanometre>(Volume<mile>{1}).value() > 0);
+    static_assert (Area<metre, std::int64_t>{1} == Area<centimetre, std::int64_t>{10000});
+    static_assert (Area<metre>{1} + Area<centimetre>{5000} == Area<metre>{1.5});
+    static_assert (3 * Area<metre>{2} - Area<metre>{1} * 2 == Area<metre>{4} / 1);
+    static_assert ((Area<metre>{1} += Area<centimetre>{10000}) == Area<metre>{2});
+}
@@ -0,0 +1,52 @@
+/*********************************************************************************
+ *
+ *  MIT License
+ *
+ *  Copyright (c) 2017 Nenad Zikic
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ *********************************************************************************/
+
+
+// Compile-time self tests of dynamic_length.hpp: `DynamicLength` and runtime unit ids.
+
+#include <length/dynamic_length.hpp>
+
+
+namespace length
+{
+    static_assert (conversion_factor(unit_id::foot, unit_id::inch) == 12.0);
+    static_assert (conversion_factor(unit_id::metre, unit_id::millimetre) == 1000.0);
+    static_assert (conversion_factor(unit_id::inch, unit_id::inch) == 1.0);
+    static_assert (unit_id_of<foot> == unit_id::foot);
+    static_assert (symbol(unit_id::centimetre) == "cm");
+    static_assert (unit_id_of<nautical_mile> == unit_id::nautical_mile);
+    static_assert (conversion_factor(unit_id::mile, unit_id::yard) == 1760.0);
+    static_assert (to_unit_id(4) == unit_id::foot && to_unit_id(unit_count - 1) == unit_id::nautical_mile);
+    static_assert (!to_unit_id(unit_count) && !to_unit_id(0xFF));
+
+    static_assert (DynamicLength{3_ft}.unit() == unit_id::foot);
+    static_assert (DynamicLength{1_ft}.as<inch>() == 12_in);
+    static_assert (DynamicLength{250, unit_id::centimetre}.to(unit_id::metre).value() == 2.5);
+    static_assert (DynamicLength{1_m} == DynamicLength{100_cm});
+    static_assert (DynamicLength{1_ft} + 12_in == DynamicLength{2_ft});
+    static_assert (DynamicLength{2_ft} - 12_in == 1_ft);
+    static_assert (2 * DynamicLength{5_mm} / 10.0 == 1_mm);
+}
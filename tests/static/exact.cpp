@@ -0,0 +1,50 @@
+/*********************************************************************************
+ *
+ *  MIT License
+ *
+ *  Copyright (c) 2017 Nenad Zikic
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ *********************************************************************************/
+
+
+// Compile-time self tests of exact.hpp: exact tick representation of lengths.
+
+#include <length/exact.hpp>
+
+#include <cstdint>
+
+
+namespace length
+{
+    static_assert (is_exact_unit_v<millimetre> && is_exact_unit_v<inch> && is_exact_unit_v<mile> && is_exact_unit_v<nautical_mile>);
+    static_assert (!is_exact_unit_v<micrometre> && !is_exact_unit_v<nanometre>);
+
+    static_assert (to_exact(Length<inch, std::int32_t>{1}).value() == 64516);
+    static_assert (to_exact(Length<millimetre, std::int64_t>{1}).value() == 2540);
+    static_assert (to_exact(Length<mile, std::int64_t>{1}).value() == 4087733760);
+    static_assert (to_exact(0.1_m) + to_exact(0.2_m) == to_exact(0.3_m));
+    static_assert (to_exact(Length<inch>{-1.5}).value() == -96774);
+    static_assert (to_exact(1_ft) == Length<inch, std::int64_t>{12});
+    static_assert (to_exact(10_in) == Length<millimetre, std::int64_t>{254});
+    static_assert (to_exact(1_m) == Length<millimetre, std::int64_t>{1000});
+    static_assert (from_exact<millimetre, std::int64_t>(to_exact(1_in)).value() == 25);
+    static_assert (from_exact<foot>(to_exact(Length<inch, std::int32_t>{6})) == 0.5_ft);
+}
@@ -0,0 +1,150 @@
+/*********************************************************************************
+ *
+ *  MIT License
+ *
+ *  Copyright (c) 2017 Nenad Zikic
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ *********************************************************************************/
+
+
+// Compile-time self tests of length.hpp: `Length` literals, conversions, arithmetic, comparison and common types.
+
+#include <length/length.hpp>
+
+#include <cstdint>
+#include <limits>
+#include <ratio>
+#include <type_traits>
+
+
+namespace length
+{
+    // literals
+    static_assert (1_m == 100_cm);
+    static_assert (1_m == 100_cm);
+    // static_assert (1_m == 200_cm);
+    static_assert (12_in == 1_ft);
+    static_assert (1_ft == 12_in);
+    static_assert (250_cm == 2.5_m);
+
+    // direct object instantiation
+    static_assert (Length<metre>{2.5} == Length<centimetre>{250});
+    static_assert (Length<foot>{3} == Length<inch>{36_in});
+    static_assert (Length<millimetre>{2} == Length<centimetre>{0.2});
+    static_assert (2_m == convert<centimetre, millimetre>(200_cm));
+    static_assert (Length<millimetre>{2} == convert<centimetre, metre>(Length<centimetre>{0.2}));
+    static_assert (1_m == Length<inch>{1 / 0.0254});
+
+    // operations
+    static_assert ( 4 * 1_m == 50_cm * 8.0);
+    static_assert ( 2_mm * 10 == 0.5 * 4_cm);
+    static_assert ( 2_mm * 10 == 4_cm / 2);
+    static_assert ( 200_mm + 3_m / 6 == 2 * 10_cm + 50_cm / 1.0);
+    static_assert ( 2_m / 2 == 1_in / 0.0254);
+    static_assert ( ((2* 5_m + 10_m) / 200_cm * 1_m).value() == 10.0);
+
+    // representations
+    static_assert (Length<millimetre, float>{2.5f} == 2.5_mm);
+    static_assert (Length<centimetre, std::int32_t>{25} == 0.25_m);
+    static_assert (std::is_same_v<decltype(Length<millimetre, float>{1} + Length<millimetre, float>{2}), Length<millimetre, float>>);
+    static_assert (std::is_same_v<decltype(Length<millimetre, float>{1} + 2_mm), Length<millimetre, double>>);
+    static_assert (std::is_same_v<decltype(Length<millimetre, std::int32_t>{1} * 2), Length<millimetre, std::int32_t>>);
+    static_assert (std::is_same_v<decltype(Length<millimetre, std::int32_t>{1} / 2.0), Length<millimetre, double>>);
+    static_assert (Length<millimetre, std::int64_t>{3} * 2 == Length<millimetre, std::int32_t>{6});
+    static_assert (Length<metre, std::int64_t>{3} + Length<centimetre, std::int64_t>{200} == 5_m);
+    static_assert (Length<inch, std::int32_t>{1} / Length<millimetre, std::int32_t>{25} == 1); // not 1 / (25 mm truncated to 0 in)
+    static_assert (Length<foot, std::int32_t>{1} / Length<inch, std::int32_t>{5} == 2);
+    static_assert (Length<millimetre, std::int64_t>{508} / Length<inch, std::int64_t>{1} == 20);
+
+    // int32 lengths at their limits are scaled to the common unit (25400000 nm per inch) in intmax_t, not wrapped in int32
+    constexpr Length<inch, std::int32_t> test_max_in{std::numeric_limits<std::int32_t>::max()};
+    constexpr Length<inch, std::int32_t> test_min_in{std::numeric_limits<std::int32_t>::min()};
+    static_assert (test_max_in > Length<nanometre, std::int32_t>{std::numeric_limits<std::int32_t>::max()});
+    static_assert (test_min_in < Length<nanometre, std::int32_t>{std::numeric_limits<std::int32_t>::min()});
+    static_assert (Length<nanometre, std::int32_t>{std::numeric_limits<std::int32_t>::max()} < Length<inch, std::int32_t>{85});
+    static_assert (Length<inch, std::int32_t>{1} == Length<nanometre, std::int32_t>{25400000});
+    static_assert (test_max_in / Length<nanometre, std::int32_t>{25400000} == std::numeric_limits<std::int32_t>::max());
+    static_assert (test_min_in / Length<nanometre, std::int32_t>{25400000} == std::numeric_limits<std::int32_t>::min());
+    static_assert (Length<nanometre, std::int32_t>{std::numeric_limits<std::int32_t>::max()} / Length<inch, std::int32_t>{1} == 84);
+
+    // lvalues and compound assignment
+    constexpr Length<metre> test_lvalue_m{2};
+    constexpr Length<centimetre> test_lvalue_cm{50};
+    static_assert (test_lvalue_m + test_lvalue_cm == 2.5_m);
+    static_assert (test_lvalue_m - test_lvalue_cm == 150_cm);
+    static_assert (test_lvalue_m * 2 == 4_m);
+    static_assert (test_lvalue_m / test_lvalue_cm == 4.0);
+    static_assert ((Length<metre>{1} += 50_cm) == 1.5_m);
+    static_assert ((Length<metre>{1} -= 50_cm) == 0.5_m);
+    static_assert ((Length<foot>{1} *= 3) == 36_in);
+    static_assert ((Length<inch, std::int32_t>{6} /= 2) == 3_in);
+
+    // units
+    struct test_league : length_unit<std::ratio<4828>> {};
+    struct test_not_a_unit { using ratio = std::ratio<1>; };
+    static_assert (is_length_unit_v<metre> && is_length_unit_v<nautical_mile> && is_length_unit_v<test_league>);
+    static_assert (!is_length_unit_v<test_not_a_unit> && !is_length_unit_v<double>);
+    static_assert (Length<test_league>{1} == 4828_m);
+    static_assert (1_mi == 1760_yd);
+    static_assert (3_ft == 1_yd);
+    static_assert (1_nmi == 1852_m);
+    static_assert (1000_nm == 1_um);
+    static_assert (convert<nautical_mile, nanometre>(Length<nautical_mile, std::int64_t>{1}).value() == 1852000000000);
+    static_assert (convert<mile, inch>(Length<mile, std::int64_t>{1}).value() == 63360);
+    static_assert (convert<micrometre, inch>(Length<micrometre, std::int64_t>{25400}).value() == 1);
+
+#if defined(__cpp_concepts)
+    // concepts
+    static_assert (LengthUnit<inch> && LengthUnit<test_league> && !LengthUnit<test_not_a_unit>);
+    static_assert (LengthType<Length<foot, float>> && !LengthType<double> && !LengthType<foot>);
+    static_assert (ScalarFor<int, double> && !ScalarFor<Length<metre>, double>);
+    template <typename L> concept test_adds_scalar = requires (L len) { len + 1.0; };
+    static_assert (!test_adds_scalar<Length<metre>>);
+#endif
+
+    // conversions
+    static_assert (convert<foot, inch>(Length<foot, std::int32_t>{2}).value() == 24);
+    static_assert (convert<inch, foot>(Length<inch, std::int32_t>{25}).value() == 2);
+    static_assert (convert<inch, millimetre>(Length<inch, std::int64_t>{10}).value() == 254);
+    static_assert (Length<inch, std::int64_t>{5} == Length<millimetre, std::int64_t>{127});
+    static_assert (!(Length<inch, std::int32_t>{1} == Length<millimetre, std::int32_t>{25}));
+    static_assert (convert<metre, metre>(Length<metre>{0.1}).value() == 0.1);
+
+    // ordering
+    static_assert (1_in < 3_cm && 3_cm > 1_in && 1_ft >= 12_in && 12_in <= 1_ft && 1_m != 1_yd);
+    static_assert (!(1_mm < 1_mm) && 1_nmi > 1_mi);
+    static_assert (Length<foot, std::int32_t>{1} > Length<inch, std::int32_t>{11});
+    static_assert (Length<inch, std::int32_t>{1} > Length<millimetre, std::int32_t>{25});
+    static_assert (Length<millimetre, std::int64_t>{25} < Length<inch, std::int64_t>{1}); // 1 in is 25.4 mm, not truncated to 25
+
+    // common type and implicit lossless conversions
+    static_assert (std::is_same_v<std::common_type_t<Length<inch>, Length<foot, float>>, Length<inch>>);
+    static_assert (std::is_same_v<std::common_type_t<Length<millimetre>, Length<metre>>, Length<millimetre>>);
+    static_assert (std::common_type_t<Length<inch>, Length<millimetre>>::unit::ratio::den == 5000);
+    static_assert (std::is_convertible_v<Length<inch>, Length<metre>> && std::is_convertible_v<Length<foot, int>, Length<inch, int>>);
+    static_assert (!std::is_convertible_v<Length<inch, int>, Length<foot, int>> && !std::is_convertible_v<Length<metre>, Length<metre, int>>);
+    static_assert (Length<inch, std::int32_t>{Length<foot, std::int32_t>{2}}.value() == 24);
+    static_assert ([] { Length<millimetre> total = 1_m + 1_cm; return total; }() == 1010_mm);
+#if defined(__cpp_lib_three_way_comparison)
+    static_assert ((1_m <=> 100_cm) == 0 && (1_in <=> 1_cm) > 0);
+    static_assert (std::is_same_v<decltype(Length<inch, int>{1} <=> Length<foot, int>{1}), std::strong_ordering>);
+#endif
+}
@@ -0,0 +1,43 @@
+/*********************************************************************************
+ *
+ *  MIT License
+ *
+ *  Copyright (c) 2017 Nenad Zikic
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ *********************************************************************************/
+
+
+// Compile-time self tests of parse.hpp: unit symbol matching of the parser, longest symbol first.
+
+#include <length/parse.hpp>
+
+#include <cstddef>
+#include <utility>
+
+
+namespace length
+{
+    static_assert (detail::match_symbol("mm", "mm" + 2, std::make_index_sequence<unit_count>{}) == 2);
+    static_assert (detail::match_symbol("m,", "m," + 2, std::make_index_sequence<unit_count>{}) == 0);
+    static_assert (detail::match_symbol("mx", "mx" + 2, std::make_index_sequence<unit_count>{}) == static_cast<std::size_t>(-1));
+    static_assert (detail::match_symbol("nmi", "nmi" + 3, std::make_index_sequence<unit_count>{}) == static_cast<std::size_t>(unit_id::nautical_mile));
+    static_assert (detail::match_symbol("nm ", "nm " + 3, std::make_index_sequence<unit_count>{}) == static_cast<std::size_t>(unit_id::nanometre));
+}
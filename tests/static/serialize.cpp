@@ -0,0 +1,43 @@
+/*********************************************************************************
+ *
+ *  MIT License
+ *
+ *  Copyright (c) 2017 Nenad Zikic
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ *********************************************************************************/
+
+
+// Compile-time self tests of serialize.hpp: zigzag, wrapping and varint helpers of the binary format.
+
+#include <length/serialize.hpp>
+
+#include <cstdint>
+
+
+namespace length
+{
+    static_assert (detail::zigzag(0) == 0 && detail::zigzag(-1) == 1 && detail::zigzag(1) == 2 && detail::zigzag(-2) == 3);
+    static_assert (detail::unzigzag(detail::zigzag(-123456789)) == -123456789);
+    static_assert (detail::unzigzag(detail::zigzag(INT64_MIN)) == INT64_MIN && detail::unzigzag(detail::zigzag(INT64_MAX)) == INT64_MAX);
+    static_assert (detail::wrapping_sub(INT64_MIN, INT64_MAX) == 1 && detail::wrapping_add(INT64_MAX, 1) == INT64_MIN);
+    static_assert (detail::varint_size(127) == 1 && detail::varint_size(128) == 2 && detail::varint_size(~std::uint64_t{0}) == 10);
+    static_assert (detail::rep_code<double>() == 2 && detail::rep_code<std::int32_t>() == 3);
+}
@@ -0,0 +1,47 @@
+/*********************************************************************************
+ *
+ *  MIT License
+ *
+ *  Copyright (c) 2017 Nenad Zikic
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ *********************************************************************************/
+
+
+// Compile-time self tests of vec3.hpp: `Vec3` and `Point3` arithmetic and conversions.
+
+#include <length/vec3.hpp>
+
+
+namespace length
+{
+    constexpr Point3<metre> test_origin{0_m, 0_m, 0_m};
+    constexpr Point3<metre> test_point{1_m, 2_m, 2_m};
+    constexpr Vec3<centimetre> test_offset{100_cm, 50_cm, 0_cm};
+
+    static_assert (test_point - test_origin == Vec3<metre>{1_m, 2_m, 2_m});
+    static_assert (test_origin + test_offset == Point3<metre>{1_m, 0.5_m, 0_m});
+    static_assert (test_point - test_offset == Point3<metre>{0_m, 1.5_m, 2_m});
+    static_assert (2 * test_offset == Vec3<metre>{2_m, 1_m, 0_m});
+    static_assert (test_offset / 2 + test_offset * 1.0 == Vec3<centimetre>{150_cm, 75_cm, 0_cm});
+    static_assert (dot(test_point - test_origin, test_offset) == Area<metre>{2});
+    static_assert (convert<centimetre, metre>(test_offset) == Vec3<metre>{1_m, 0.5_m, 0_m});
+    static_assert (convert<metre, millimetre>(test_point).z == 2000_mm);
+}
@@ -0,0 +1,155 @@
+/*********************************************************************************
+ *
+ *  MIT License
+ *
+ *  Copyright (c) 2017 Nenad Zikic
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ *********************************************************************************/
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <type_traits>
+#include <vector>
+
+
+// Minimal self registering test runner, no framework needed. Every `LENGTH_TEST`
+// is run by `test_main.cpp`, failed `LENGTH_CHECK`s are reported with file and
+// line and make the executable exit non-zero, so ctest reports it as failed.
+//
+// Property tests draw their inputs from `random_values`, seeded so failures
+// reproduce on every run.
+
+namespace length::test
+{
+
+    struct test_case
+    {
+            const char* name;
+            void      (*run)();
+    };
+
+    inline std::vector<test_case>& registry()
+    {
+        static std::vector<test_case> cases;
+        return cases;
+    }
+
+    inline std::size_t& failures()
+    {
+        static std::size_t count = 0;
+        return count;
+    }
+
+    struct registrar
+    {
+            registrar(const char* name, void (*run)()) { registry().push_back({name, run}); }
+    };
+
+    inline bool check(bool ok, const char* expression, const char* file, int line)
+    {
+        if (!ok)
+        {
+            ++failures();
+            std::fprintf(stderr, "%s:%d: check failed: %s\n", file, line, expression);
+        }
+        return ok;
+    }
+
+    /** Runs all registered tests, or only these whose name contains `argv[1]` **/
+    inline int run_all(int argc, char** argv)
+    {
+        const char* filter = argc > 1 ? argv[1] : "";
+        std::size_t run = 0;
+        for (const test_case& t : registry())
+        {
+            if (std::strstr(t.name, filter) == nullptr)
+            {
+                continue;
+            }
+            const std::size_t before = failures();
+            t.run();
+            ++run;
+            std::printf("%s %s\n", failures() == before ? "[  ok  ]" : "[ FAIL ]", t.name);
+        }
+        std::printf("%zu tests, %zu failed checks\n", run, failures());
+        return failures() == 0 && run > 0 ? 0 : 1;
+    }
+
+    /** `n` uniformly distributed values from [lo, hi), the same on every run **/
+    template <typename Rep = double>
+    std::vector<Rep> random_values(std::size_t n, double lo = -1000.0, double hi = 1000.0, unsigned seed = 42)
+    {
+        std::mt19937_64 engine{seed};
+        std::vector<Rep> values(n);
+        if constexpr (std::is_integral_v<Rep>)
+        {
+            std::uniform_int_distribution<long long> dist{static_cast<long long>(lo), static_cast<long long>(hi)};
+            for (Rep& v : values)
+            {
+                v = static_cast<Rep>(dist(engine));
+            }
+        }
+        else
+        {
+            std::uniform_real_distribution<double> dist{lo, hi};
+            for (Rep& v : values)
+            {
+                v = static_cast<Rep>(dist(engine));
+            }
+        }
+        return values;
+    }
+
+    /** Whether `a` and `b` agree to `ulps` units in the last place of the larger one, or both are tiny **/
+    template <typename T>
+    bool close(T a, T b, T ulps = T{4})
+    {
+        const T scale = std::max(std::abs(a), std::abs(b));
+        return std::abs(a - b) <= ulps * std::numeric_limits<T>::epsilon() * std::max(scale, T{1});
+    }
+
+    /** Calls `f` with a value of every type in `Types` **/
+    template <typename... Types, typename F>
+    void for_each_type(F&& f)
+    {
+        (f(Types{}), ...);
+    }
+
+    template <typename T>
+    struct type_tag
+    {
+            using type = T;
+    };
+}
+
+#define LENGTH_TEST(name)                                                                     \
+    static void name();                                                                       \
+    static const ::length::test::registrar name##_registrar{#name, name};                     \
+    static void name()
+
+#define LENGTH_CHECK(...) ::length::test::check(static_cast<bool>(__VA_ARGS__), #__VA_ARGS__, __FILE__, __LINE__)
@@ -0,0 +1,392 @@
+/*********************************************************************************
+ *
+ *  MIT License
+ *
+ *  Copyright (c) 2017 Nenad Zikic
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ *********************************************************************************/
+
+
+// Containers and algorithms over runs of lengths: `LengthArray` arithmetic and
+// allocation, arena, compensated accumulation, lazy expressions, mixed unit
+// searches and the SPSC stream.
+
+#include "test_common.hpp"
+
+#include <length/accumulator.hpp>
+#include <length/algorithm.hpp>
+#include <length/arena.hpp>
+#include <length/expression.hpp>
+#include <length/length_array.hpp>
+#include <length/stream.hpp>
+
+#include <cstdint>
+#include <stdexcept>
+#include <thread>
+
+// scalar references are compared exactly with kernels, which never fuse multiply-add
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC optimize("fp-contract=off")
+#endif
+
+
+namespace
+{
+    using namespace length;
+    using length::test::random_values;
+
+    template <typename Unit, typename Rep = double, typename Allocator = std::allocator<Rep>>
+    LengthArray<Unit, Rep, Allocator> array_of(const std::vector<Rep>& values, const Allocator& allocator = Allocator{})
+    {
+        return LengthArray<Unit, Rep, Allocator>{LengthArrayView<Unit, Rep>{as_lengths<Unit>(values.data()), values.size()}, allocator};
+    }
+
+    bool is_aligned(const void* p) { return reinterpret_cast<std::uintptr_t>(p) % detail::array_alignment == 0; }
+
+    LENGTH_TEST(array_arithmetic_matches_scalar)
+    {
+        for (const std::size_t n : {0, 1, 7, 8, 9, 1000, 1001})
+        {
+            const auto a = random_values(n, -1000, 1000, 1);
+            const auto b = random_values(n, -1000, 1000, 2);
+            const LengthArray<millimetre> mm = array_of<millimetre>(a);
+            const LengthArray<inch>       in = array_of<inch>(b);
+            LENGTH_CHECK(mm.size() == n && (n == 0 || is_aligned(mm.data())));
+
+            const auto sum  = mm + in;
+            const auto diff = mm - in;
+            const LengthArray<millimetre> scaled = 2.5 * mm / 4.0;
+            // integer scalars convert to the `double` rep, like `Length` operators
+            LengthArray<millimetre> doubled = 2 * mm * 3 / 2 * 2;
+            doubled /= 3;
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                LENGTH_CHECK(sum[i] == mm[i] + in[i]);
+                LENGTH_CHECK(diff[i] == mm[i] - in[i]);
+                LENGTH_CHECK(test::close(scaled[i].value(), a[i] * 2.5 / 4.0));
+                LENGTH_CHECK(test::close(doubled[i].value(), a[i] * 2.0));
+            }
+
+            const LengthArray<metre> copied = mm.convert_to<metre>();
+            LengthArray<millimetre> moved_from = mm;
+            const double* buffer = moved_from.values();
+            const LengthArray<metre> moved = std::move(moved_from).convert_to<metre>();
+            LENGTH_CHECK(moved.size() == n && (n == 0 || moved.values() == buffer) && moved_from.empty());
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                LENGTH_CHECK(copied[i] == convert<millimetre, metre>(mm[i]) && moved[i] == copied[i]);
+            }
+        }
+
+        // integral arrays stay exact
+        const auto ints = random_values<std::int64_t>(1000, -1'000'000, 1'000'000);
+        LengthArray<foot, std::int64_t> ft = array_of<foot>(ints);
+        ft += array_of<foot>(ints);
+        ft /= std::int64_t{2};
+        ft *= std::int64_t{3};
+        LENGTH_CHECK(std::equal(ft.begin(), ft.end(), ints.begin(), [](auto l, auto v) { return l.value() == 3 * v; }));
+    }
+
+    LENGTH_TEST(array_size_mismatch_throws)
+    {
+        LengthArray<metre> a(10, 1_m);
+        const LengthArray<centimetre> b(9, 1_cm);
+        for (const bool subtract : {false, true})
+        {
+            bool thrown = false;
+            try
+            {
+                if (subtract) a -= b;
+                else          a += b;
+            }
+            catch (const std::length_error&)
+            {
+                thrown = true;
+            }
+            LENGTH_CHECK(thrown);
+            LENGTH_CHECK(std::all_of(a.begin(), a.end(), [](auto l) { return l == 1_m; }));
+        }
+
+        bool thrown = false;
+        try
+        {
+            [[maybe_unused]] const auto sum = a + LengthArray<foot, double>(11);
+        }
+        catch (const std::length_error&)
+        {
+            thrown = true;
+        }
+        LENGTH_CHECK(thrown);
+    }
+
+    LENGTH_TEST(array_grows_aligned)
+    {
+        LengthArray<metre, float> a;
+        for (int i = 0; i < 1000; ++i)
+        {
+            a.push_back(Length<metre, float>{static_cast<float>(i)});
+            LENGTH_CHECK(is_aligned(a.data()) && a.capacity() >= a.size() && a.capacity() % (64 / sizeof(float)) == 0);
+        }
+        LENGTH_CHECK(a[999].value() == 999.0f);
+        a.resize(1500, Length<metre, float>{-1});
+        LENGTH_CHECK(a.size() == 1500 && a[999].value() == 999.0f && a[1499].value() == -1.0f);
+        a.resize(10);
+        LENGTH_CHECK(a.size() == 10 && a[9].value() == 9.0f);
+
+        LengthArray<metre, float> b{Length<metre, float>{1}, Length<metre, float>{2}};
+        swap(a, b);
+        LENGTH_CHECK(a.size() == 2 && b.size() == 10);
+        b = a;
+        LENGTH_CHECK(b.size() == 2 && b[1].value() == 2.0f && b.data() != a.data());
+    }
+
+#if defined(__cpp_lib_memory_resource)
+    LENGTH_TEST(arena_serves_aligned_blocks)
+    {
+        pmr::AlignedArena arena{1024};
+        std::vector<const void*> blocks;
+        for (std::size_t bytes : {1, 8, 63, 64, 65, 1000, 5000, 100000})
+        {
+            void* p = arena.allocate(bytes, alignof(double));
+            LENGTH_CHECK(is_aligned(p));
+            std::memset(p, 0xA5, bytes);
+            blocks.push_back(p);
+        }
+        // no two blocks share a cache line
+        std::sort(blocks.begin(), blocks.end());
+        LENGTH_CHECK(std::adjacent_find(blocks.begin(), blocks.end()) == blocks.end());
+
+        arena.reset();
+        void* first = arena.allocate(64, 8);
+        arena.reset();
+        LENGTH_CHECK(arena.allocate(64, 8) == first);
+
+        alignas(64) std::byte buffer[4096];
+        pmr::AlignedArena stack{buffer, sizeof buffer};
+        void* p = stack.allocate(100, 8);
+        LENGTH_CHECK(p >= static_cast<void*>(buffer) && p < static_cast<void*>(buffer + sizeof buffer));
+        void* big = stack.allocate(10000, 8);
+        LENGTH_CHECK(is_aligned(big) && (big < static_cast<void*>(buffer) || big >= static_cast<void*>(buffer + sizeof buffer)));
+        stack.release();
+        LENGTH_CHECK(stack.allocate(100, 8) == p);
+    }
+
+    LENGTH_TEST(pmr_arrays_use_arena)
+    {
+        pmr::AlignedArena arena{64 * 1024};
+        const auto values = random_values(1000);
+        pmr::LengthArray<millimetre> a(values.size(), {}, &arena);
+        std::copy(values.begin(), values.end(), a.values());
+        const pmr::LengthArray<millimetre> b = a + a;
+        const auto c = expr::evaluate(expr::lazy(a) * 2.0, std::pmr::polymorphic_allocator<double>{&arena});
+        // copies fall back to the default resource like every pmr container, evaluation takes the arena explicitly
+        LENGTH_CHECK(b.get_allocator().resource() == std::pmr::get_default_resource() && c.get_allocator().resource() == &arena);
+        LENGTH_CHECK(is_aligned(a.data()) && is_aligned(b.data()) && is_aligned(c.data()));
+        for (std::size_t i = 0; i < values.size(); ++i)
+        {
+            LENGTH_CHECK(b[i].value() == 2 * values[i] && c[i].value() == 2 * values[i]);
+        }
+
+        // moving between arenas copies, arrays never own memory of another resource
+        pmr::AlignedArena other{64 * 1024};
+        pmr::LengthArray<millimetre> d(&other);
+        d = std::move(a);
+        LENGTH_CHECK(d.get_allocator().resource() == &other && d.size() == values.size() && a.empty());
+    }
+#endif
+
+    LENGTH_TEST(accumulator_is_compensated)
+    {
+        // terms cancelling to a tiny total lose everything in a naive double sum
+        std::vector<Length<metre>> terms;
+        long double exact = 0;
+        for (const double v : random_values(10000, 1e10, 1e12))
+        {
+            const double small = v * 1e-17;
+            terms.insert(terms.end(), {Length<metre>{v}, Length<metre>{small}, Length<metre>{-v}});
+            exact += static_cast<long double>(small);
+        }
+        LengthAccumulator<metre> one_by_one;
+        for (const auto& t : terms)
+        {
+            one_by_one += t;
+        }
+        const double bulk = accumulate(terms.data(), terms.size()).total().value();
+        LENGTH_CHECK(test::close(one_by_one.total().value(), static_cast<double>(exact), 1e3));
+        LENGTH_CHECK(test::close(bulk, static_cast<double>(exact), 1e3));
+
+        // unit converted and merged partial sums
+        const auto inches = random_values(1000);
+        std::vector<Length<inch>> in(as_lengths<inch>(inches.data()), as_lengths<inch>(inches.data()) + inches.size());
+        LengthAccumulator<inch> lo = accumulate(in.data(), 500);
+        LengthAccumulator<metre> total = accumulate<metre>(in.data() + 500, 500);
+        total += lo;
+        long double reference = 0;
+        for (const double v : inches) reference += static_cast<long double>(v) * 0.0254L;
+        LENGTH_CHECK(std::abs(total.total().value() - static_cast<double>(reference)) < 1e-12);
+    }
+
+    LENGTH_TEST(expressions_evaluate_in_one_pass)
+    {
+        const auto a = array_of<metre>(random_values(1000, -10, 10, 1));
+        const auto b = array_of<inch>(random_values(1000, -10, 10, 2));
+        const auto c = array_of<metre>(random_values(1000, -10, 10, 3));
+        const LengthArray<metre> r = expr::evaluate(expr::lazy(a) * 3.0 + expr::lazy(b) - expr::lazy(c) / 2.0 + 1_m);
+        const auto in_mm = expr::evaluate<millimetre>(expr::convert<millimetre>(expr::lazy(b)));
+        LENGTH_CHECK(r.size() == a.size() && in_mm.size() == b.size());
+        for (std::size_t i = 0; i < a.size(); ++i)
+        {
+            LENGTH_CHECK(test::close(r[i].value(), Length<metre>{a[i] * 3.0 + b[i] - c[i] / 2.0 + 1_m}.value(), 8.0));
+            LENGTH_CHECK(test::close(in_mm[i].value(), b[i].value() * 25.4));
+        }
+
+        const auto throws_length_error = [](auto&& build) {
+            try
+            {
+                [[maybe_unused]] const auto mismatched = build();
+            }
+            catch (const std::length_error&)
+            {
+                return true;
+            }
+            return false;
+        };
+        LENGTH_CHECK(throws_length_error([&] { return expr::lazy(a) + expr::lazy(a.data(), 999); }));
+
+        // empty operand isn't broadcast like a constant, on either side
+        const LengthArray<metre> empty;
+        LENGTH_CHECK(throws_length_error([&] { return expr::lazy(empty) + expr::lazy(b); }));
+        LENGTH_CHECK(throws_length_error([&] { return expr::lazy(b) - expr::lazy(empty); }));
+        LENGTH_CHECK(throws_length_error([&] { return expr::lazy(empty) * 2.0 + 1_m - expr::lazy(c); }));
+        LENGTH_CHECK(expr::evaluate(expr::lazy(empty) + 1_m + expr::lazy(empty)).empty());
+
+        // operand is also the destination
+        LengthArray<metre> d = a;
+        expr::assign(d, expr::lazy(d) + expr::lazy(d));
+        LENGTH_CHECK(std::equal(d.begin(), d.end(), a.begin(), [](auto x, auto y) { return x == y * 2.0; }));
+    }
+
+    template <typename Rep>
+    void check_searches()
+    {
+        std::vector<Rep> values = random_values<Rep>(2000, -5000, 5000);
+        std::sort(values.begin(), values.end());
+        const auto sorted = array_of<millimetre>(values);
+        for (const Rep k : random_values<Rep>(200, -200, 200, 7))
+        {
+            const Length<inch, Rep> key{k};
+            const auto first = lower_bound(sorted, key);
+            const auto last  = upper_bound(sorted, key);
+            const auto reference_first = std::find_if(sorted.begin(), sorted.end(), [&](auto e) { return !(e < key); });
+            const auto reference_last  = std::find_if(sorted.begin(), sorted.end(), [&](auto e) { return key < e; });
+            LENGTH_CHECK(first == reference_first && last == reference_last);
+            const auto [eq_first, eq_last] = equal_range(sorted, key);
+            LENGTH_CHECK(eq_first == first && eq_last == last);
+        }
+    }
+
+    LENGTH_TEST(mixed_unit_searches_match_comparisons)
+    {
+        check_searches<double>();
+        check_searches<std::int32_t>();
+        check_searches<std::int64_t>();
+
+        auto values = array_of<metre>(random_values(1001));
+        auto copy = values;
+        sort(values);
+        LENGTH_CHECK(std::is_sorted(values.begin(), values.end()));
+        nth_element(copy, 500);
+        LENGTH_CHECK(copy[500] == values[500]);
+    }
+
+    LENGTH_TEST(stream_converts_in_order)
+    {
+        constexpr std::size_t total = 200'000;
+        LengthStream<foot, metre, double, 1000> stream{4, {300, std::chrono::microseconds{200}}};
+        std::thread producer([&] {
+            std::vector<Length<foot>> run(37);
+            for (std::size_t sent = 0; sent < total;)
+            {
+                if (sent % 3 == 0)
+                {
+                    if (stream.push(Length<foot>{static_cast<double>(sent)}))
+                    {
+                        ++sent;
+                    }
+                }
+                else
+                {
+                    const std::size_t n = std::min(run.size(), total - sent);
+                    for (std::size_t i = 0; i < n; ++i)
+                    {
+                        run[i] = Length<foot>{static_cast<double>(sent + i)};
+                    }
+                    sent += stream.push(run.data(), n);
+                }
+                stream.poll();
+            }
+            stream.flush();
+        });
+
+        std::size_t received = 0;
+        std::size_t out_of_order = 0;
+        std::vector<Length<metre>> pulled(123);
+        while (received < total)
+        {
+            const bool got = (received % 2 == 0) ? stream.consume([&](LengthArrayView<metre> block) {
+                for (const auto l : block)
+                {
+                    out_of_order += l != convert<foot, metre>(Length<foot>{static_cast<double>(received++)});
+                }
+            }) : [&] {
+                const auto end = stream.pull(pulled.data(), pulled.size());
+                for (auto p = pulled.data(); p != end; ++p)
+                {
+                    out_of_order += *p != convert<foot, metre>(Length<foot>{static_cast<double>(received++)});
+                }
+                return end != pulled.data();
+            }();
+            if (!got)
+            {
+                std::this_thread::yield();
+            }
+        }
+        producer.join();
+        LENGTH_CHECK(received == total && out_of_order == 0);
+        LENGTH_CHECK(!stream.consume([](LengthArrayView<metre>) {}));
+    }
+
+    LENGTH_TEST(stream_deadline_holds_for_slow_producer)
+    {
+        // one length every 2 ms against 1 ms deadline, block leaves on a push without `poll`
+        LengthStream<foot, metre, double, 1000> stream{4, {0, std::chrono::microseconds{1000}}};
+        std::size_t pushed = 0;
+        bool published = false;
+        while (!published && pushed < 8)
+        {
+            LENGTH_CHECK(stream.push(Length<foot>{1}));
+            ++pushed;
+            std::this_thread::sleep_for(std::chrono::milliseconds{2});
+            published = stream.consume([](LengthArrayView<metre>) {});
+        }
+        LENGTH_CHECK(published && pushed <= 3);
+    }
+}
@@ -0,0 +1,159 @@
+/*********************************************************************************
+ *
+ *  MIT License
+ *
+ *  Copyright (c) 2017 Nenad Zikic
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ *********************************************************************************/
+
+
+// Areas, volumes and 3D vectors: products and conversions against scalar
+// reference, bulk conversions and distances over both point layouts.
+
+#include "test_common.hpp"
+
+#include <length/dimension.hpp>
+#include <length/vec3.hpp>
+
+#include <cstdint>
+
+
+namespace
+{
+    using namespace length;
+    using length::test::random_values;
+
+    LENGTH_TEST(powers_convert_by_powered_ratio)
+    {
+        for (const double v : random_values(1000))
+        {
+            const Area<foot>   a{v};
+            const Volume<inch> c{v};
+            LENGTH_CHECK(test::close(convert<foot, metre>(a).value(), v * 0.3048 * 0.3048));
+            LENGTH_CHECK(test::close(convert<inch, centimetre>(c).value(), v * 2.54 * 2.54 * 2.54));
+            LENGTH_CHECK(test::close((a + Area<inch>{v}).value(), v + v / 144));
+            LENGTH_CHECK(test::close((Length<metre>{v} * 50_cm).value(), v * 0.5));
+            LENGTH_CHECK(test::close((Area<foot>{v} * 6_in).value(), v * 0.5));
+            LENGTH_CHECK(test::close((Volume<metre>{v} / Area<centimetre>{1e4}).value(), v));
+        }
+
+        // integral powers are exact
+        for (const std::int64_t v : random_values<std::int64_t>(1000, -1'000'000, 1'000'000))
+        {
+            LENGTH_CHECK(convert<metre, millimetre>(Area<metre, std::int64_t>{v}).value() == v * 1'000'000);
+            LENGTH_CHECK(convert<foot, inch>(Volume<foot, std::int64_t>{v}).value() == v * 1728);
+        }
+
+        const auto values = random_values(1001);
+        std::vector<Area<inch>> in(values.size());
+        std::vector<Area<metre>> out(values.size());
+        std::transform(values.begin(), values.end(), in.begin(), [](double v) { return Area<inch>{v}; });
+        LENGTH_CHECK(convert_n<inch, metre>(in.data(), in.size(), out.data()) == out.data() + out.size());
+        for (std::size_t i = 0; i < in.size(); ++i)
+        {
+            LENGTH_CHECK(test::close(out[i].value(), convert<inch, metre>(in[i]).value()));
+        }
+    }
+
+    LENGTH_TEST(vectors_follow_lhs_units)
+    {
+        const Vec3<metre> a{1_m, 2_m, 0_m};
+        const Vec3<centimetre> b{100_cm, 50_cm, 25_cm};
+        LENGTH_CHECK(test::close(dot(a, b).value(), 2.0));
+        LENGTH_CHECK((a + b == Vec3<metre>{2_m, 2.5_m, 0.25_m}));
+        const Point3<millimetre, std::int64_t> p{Length<millimetre, std::int64_t>{254}, Length<millimetre, std::int64_t>{0}, Length<millimetre, std::int64_t>{-127}};
+        const Point3<inch, std::int64_t> q{Length<inch, std::int64_t>{5}, Length<inch, std::int64_t>{10}, Length<inch, std::int64_t>{-5}};
+        LENGTH_CHECK((p - q == Vec3<millimetre, std::int64_t>{Length<millimetre, std::int64_t>{127}, Length<millimetre, std::int64_t>{-254}, Length<millimetre, std::int64_t>{0}}));
+        LENGTH_CHECK(test::close(norm(Vec3<metre>{3_m, 4_m, 12_m}).value(), 13.0));
+        LENGTH_CHECK(test::close(Length<metre>{distance(Point3<metre>{1_m, 1_m, 1_m}, Point3<centimetre>{400_cm, 500_cm, 1300_cm})}.value(), 13.0));
+
+        const auto values = random_values(3 * 1001);
+        std::vector<Vec3<inch>> in(1001);
+        std::vector<Vec3<metre>> out(in.size());
+        std::copy(values.begin(), values.end(), as_values(&in[0].x));
+        LENGTH_CHECK(convert_n<inch, metre>(in.data(), in.size(), out.data()) == out.data() + out.size());
+        for (std::size_t i = 0; i < in.size(); ++i)
+        {
+            LENGTH_CHECK(out[i] == convert<inch, metre>(in[i]));
+        }
+
+        // empty ranges may come as null pointers
+        LENGTH_CHECK(convert_n<inch, metre>(static_cast<const Vec3<inch>*>(nullptr), 0, static_cast<Vec3<metre>*>(nullptr)) == nullptr);
+        LENGTH_CHECK(convert_n<inch, metre>(static_cast<const Point3<inch>*>(nullptr), 0, static_cast<Point3<metre>*>(nullptr)) == nullptr);
+        LENGTH_CHECK(distance_n(static_cast<const Point3<metre>*>(nullptr), static_cast<const Point3<inch>*>(nullptr), 0,
+                                static_cast<Length<metre>*>(nullptr)) == nullptr);
+    }
+
+    template <typename Rep>
+    void check_distances()
+    {
+        // sizes around the block of interleaved points
+        for (const std::size_t n : {0, 1, 255, 256, 257, 1000})
+        {
+            const auto values = random_values<Rep>(6 * n, -1000, 1000);
+            std::vector<Point3<millimetre, Rep>> a(n);
+            std::vector<Point3<inch, Rep>> b(n);
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                a[i] = {Length<millimetre, Rep>{values[6 * i]}, Length<millimetre, Rep>{values[6 * i + 1]}, Length<millimetre, Rep>{values[6 * i + 2]}};
+                b[i] = {Length<inch, Rep>{values[6 * i + 3]}, Length<inch, Rep>{values[6 * i + 4]}, Length<inch, Rep>{values[6 * i + 5]}};
+            }
+
+            std::vector<Rep> columns(6 * n);
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                columns[i]         = a[i].x.value();
+                columns[n + i]     = a[i].y.value();
+                columns[2 * n + i] = a[i].z.value();
+                columns[3 * n + i] = b[i].x.value();
+                columns[4 * n + i] = b[i].y.value();
+                columns[5 * n + i] = b[i].z.value();
+            }
+
+            std::vector<Length<millimetre, Rep>> aos(n);
+            std::vector<Length<millimetre, Rep>> soa(n);
+            LENGTH_CHECK(distance_n(a.data(), b.data(), n, aos.data()) == aos.data() + n);
+            LENGTH_CHECK(distance_n(Point3Columns<millimetre, Rep>{columns.data(), columns.data() + n, columns.data() + 2 * n},
+                                    Point3Columns<inch, Rep>{columns.data() + 3 * n, columns.data() + 4 * n, columns.data() + 5 * n},
+                                    n, soa.data()) == soa.data() + n);
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                const Rep expected = distance(a[i], convert<inch, millimetre>(b[i])).value();
+                if constexpr (std::is_floating_point_v<Rep>)
+                {
+                    LENGTH_CHECK(test::close(aos[i].value(), expected, Rep{16}));
+                    LENGTH_CHECK(test::close(soa[i].value(), expected, Rep{16}));
+                }
+                else
+                {
+                    LENGTH_CHECK(aos[i].value() == expected && soa[i].value() == expected);
+                }
+            }
+        }
+    }
+
+    LENGTH_TEST(bulk_distances_match_scalar)
+    {
+        check_distances<double>();
+        check_distances<float>();
+        check_distances<std::int64_t>();
+    }
+}
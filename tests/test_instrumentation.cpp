@@ -0,0 +1,127 @@
+/*********************************************************************************
+ *
+ *  MIT License
+ *
+ *  Copyright (c) 2017 Nenad Zikic
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ *********************************************************************************/
+
+
+// Instrumentation counters, built with `LENGTH_INSTRUMENTATION` defined for the
+// whole target so every translation unit agrees on the hooks.
+
+#include "test_common.hpp"
+
+#include <length/bulk.hpp>
+#include <length/instrumentation.hpp>
+#include <length/length.hpp>
+
+#include <cstdint>
+#include <sstream>
+#include <string>
+#include <string_view>
+
+#if !defined(LENGTH_INSTRUMENTATION)
+#error "instrumentation tests need LENGTH_INSTRUMENTATION"
+#endif
+
+
+namespace
+{
+    using namespace length;
+    namespace li = length::instrumentation;
+
+    /** Counts recorded for `kind` between units with symbols `from` and `to` **/
+    li::snapshot counted(li::event kind, std::string_view from, std::string_view to)
+    {
+        li::snapshot result{kind, {}, {}, 0, 0};
+        li::for_each([&](const li::snapshot& s) {
+            if (s.kind == kind && s.from.symbol == from && s.to.symbol == to)
+            {
+                result.calls  += s.calls;
+                result.values += s.values;
+            }
+        });
+        return result;
+    }
+
+    LENGTH_TEST(conversions_are_counted)
+    {
+        li::reset();
+        const volatile double v = 3;
+        for (int i = 0; i < 10; ++i)
+        {
+            [[maybe_unused]] const auto m = convert<inch, metre>(Length<inch>{v});
+        }
+        LENGTH_CHECK(counted(li::event::conversion, "in", "m").calls == 10);
+        LENGTH_CHECK(counted(li::event::conversion, "in", "m").values == 10);
+
+        std::vector<Length<foot>> in(1000);
+        std::vector<Length<millimetre>> out(in.size());
+        convert_n<foot, millimetre>(in.data(), in.size(), out.data());
+        LENGTH_CHECK(counted(li::event::conversion, "ft", "mm").calls == 1);
+        LENGTH_CHECK(counted(li::event::conversion, "ft", "mm").values == 1000);
+
+        // same units and constant evaluation are never counted
+        [[maybe_unused]] const auto same = convert<metre, metre>(Length<metre>{v});
+        constexpr auto folded = convert<yard, foot>(Length<yard>{1});
+        static_assert (folded.value() == 3);
+        LENGTH_CHECK(counted(li::event::conversion, "m", "m").calls == 0);
+        LENGTH_CHECK(counted(li::event::conversion, "yd", "ft").calls == 0);
+    }
+
+    LENGTH_TEST(mixed_operations_are_counted)
+    {
+        li::reset();
+        const volatile double v = 2;
+        Length<metre> m{v};
+        [[maybe_unused]] const auto sum = m + Length<centimetre>{v};
+        m -= Length<centimetre>{v};
+        [[maybe_unused]] const bool less = m < Length<foot>{v};
+        [[maybe_unused]] const bool same_unit = m < Length<metre>{v};
+        const Length<millimetre, std::int64_t> mm{static_cast<std::int64_t>(v)};
+        [[maybe_unused]] const auto ratio = mm / Length<inch, std::int64_t>{1};
+        [[maybe_unused]] const auto same_unit_ratio = m / Length<metre>{v} + mm / Length<millimetre, std::int64_t>{1};
+        LENGTH_CHECK(counted(li::event::mixed_arithmetic, "cm", "m").calls == 2);
+        LENGTH_CHECK(counted(li::event::mixed_arithmetic, "in", "mm").calls == 1);
+        LENGTH_CHECK(counted(li::event::mixed_arithmetic, "m", "m").calls + counted(li::event::mixed_arithmetic, "mm", "mm").calls == 0);
+        LENGTH_CHECK(counted(li::event::mixed_comparison, "ft", "m").calls + counted(li::event::mixed_comparison, "m", "ft").calls == 1);
+        LENGTH_CHECK(counted(li::event::mixed_comparison, "m", "m").calls == 0);
+
+        // each mixed-unit operation is one event, its rescale isn't counted as conversion too
+        LENGTH_CHECK(counted(li::event::conversion, "cm", "m").calls == 0);
+        LENGTH_CHECK(counted(li::event::conversion, "ft", "m").calls + counted(li::event::conversion, "m", "ft").calls == 0);
+        LENGTH_CHECK(counted(li::event::conversion, "in", "mm").calls + counted(li::event::conversion, "mm", "mm").calls == 0);
+        std::ostringstream os;
+        li::report(os);
+        LENGTH_CHECK(os.str().find("conversion") == std::string::npos);
+    }
+
+    LENGTH_TEST(report_lists_used_counters)
+    {
+        li::reset();
+        const volatile double v = 1;
+        [[maybe_unused]] const auto nm = convert<nautical_mile, metre>(Length<nautical_mile>{v});
+        std::ostringstream os;
+        li::report(os);
+        LENGTH_CHECK(os.str() == "conversion nmi -> m: 1 calls, 1 values\n");
+    }
+}
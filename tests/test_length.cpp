@@ -0,0 +1,359 @@
+/*********************************************************************************
+ *
+ *  MIT License
+ *
+ *  Copyright (c) 2017 Nenad Zikic
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ *********************************************************************************/
+
+
+// Runtime and property tests of `length.hpp`, `exact.hpp` and `dynamic_length.hpp`:
+// every operator over every pair of built-in units, checked against long double
+// references, and exactness of integral and tick lengths.
+
+#include "test_common.hpp"
+
+#include <length/dynamic_length.hpp>
+#include <length/exact.hpp>
+#include <length/length.hpp>
+
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <tuple>
+#include <type_traits>
+
+
+namespace
+{
+    using namespace length;
+    using length::test::close;
+    using length::test::random_values;
+
+    using units = std::tuple<metre, centimetre, millimetre, micrometre, nanometre, inch, foot, yard, mile, nautical_mile>;
+
+    constexpr std::size_t samples = 1000;
+
+    template <typename From, typename F>
+    void for_each_target_unit(F& f)
+    {
+        std::apply([&](auto... to) { (f(From{}, to), ...); }, units{});
+    }
+
+    /** Calls `f(From{}, To{})` for every ordered pair of built-in units **/
+    template <typename F>
+    void for_each_unit_pair(F&& f)
+    {
+        std::apply([&](auto... from) { (for_each_target_unit<decltype(from)>(f), ...); }, units{});
+    }
+
+    template <typename Unit>
+    long double metres_per_unit()
+    {
+        return static_cast<long double>(Unit::ratio::num) / static_cast<long double>(Unit::ratio::den);
+    }
+
+    template <typename Unit, typename Rep>
+    long double in_metres(const Length<Unit, Rep>& length)
+    {
+        return static_cast<long double>(length.value()) * metres_per_unit<Unit>();
+    }
+
+    /** Largest magnitude of integral values of `From` that still fit `int64_t` after scaling by `k` **/
+    constexpr std::int64_t integral_range(std::intmax_t k)
+    {
+        return std::min<std::int64_t>(1000, std::numeric_limits<std::int64_t>::max() / k);
+    }
+
+
+    LENGTH_TEST(conversion_matches_ratio)
+    {
+        const auto values = random_values(samples);
+        for_each_unit_pair([&](auto from, auto to) {
+            using From = decltype(from);
+            using To   = decltype(to);
+            const long double factor = metres_per_unit<From>() / metres_per_unit<To>();
+            for (const double v : values)
+            {
+                const Length<To> converted = convert<From, To>(Length<From>{v});
+                LENGTH_CHECK(close(converted.value(), static_cast<double>(v * factor)));
+                LENGTH_CHECK(close(convert<To, From>(converted).value(), v, 8.0));
+
+                const Length<To, float> narrow = convert<From, To>(Length<From, float>{static_cast<float>(v)});
+                LENGTH_CHECK(close(narrow.value(), static_cast<float>(static_cast<float>(v) * factor)));
+            }
+            LENGTH_CHECK(convert<From, To>(Length<From>{0}).value() == 0.0);
+        });
+    }
+
+    LENGTH_TEST(integral_conversion_is_exact)
+    {
+        for_each_unit_pair([&](auto from, auto to) {
+            using From = decltype(from);
+            using To   = decltype(to);
+            using r    = detail::conversion_ratio<From, To>;
+            const std::int64_t range = integral_range(r::num);
+            for (const std::int64_t v : random_values<std::int64_t>(samples, -range, range))
+            {
+                // integral conversion truncates towards zero, as integer division does
+                const Length<To, std::int64_t> converted = convert<From, To>(Length<From, std::int64_t>{v});
+                LENGTH_CHECK(converted.value() == v * r::num / r::den);
+                if constexpr (r::den == 1)
+                {
+                    LENGTH_CHECK(convert<To, From>(converted).value() == v);
+                }
+
+                const Length<To, std::int32_t> narrow = convert<From, To>(Length<From, std::int32_t>{static_cast<std::int32_t>(v)});
+                if (std::abs(v * r::num / r::den) <= std::numeric_limits<std::int32_t>::max())
+                {
+                    LENGTH_CHECK(narrow.value() == v * r::num / r::den);
+                }
+            }
+        });
+    }
+
+    LENGTH_TEST(mixed_comparison_is_exact)
+    {
+        for_each_unit_pair([&](auto from, auto to) {
+            using From = decltype(from);
+            using To   = decltype(to);
+            using CU   = detail::common_unit_t<From, To>;
+            constexpr std::intmax_t ka = detail::conversion_ratio<From, CU>::num;
+            constexpr std::intmax_t kb = detail::conversion_ratio<To, CU>::num;
+            const std::int64_t range_a = integral_range(ka);
+            const std::int64_t range_b = integral_range(kb);
+            const auto as = random_values<std::int64_t>(samples, -range_a, range_a, 1);
+            const auto bs = random_values<std::int64_t>(samples, -range_b, range_b, 2);
+            for (std::size_t i = 0; i < samples; ++i)
+            {
+                // values in common unit are whole numbers, so reference comparison is exact
+                const std::int64_t a = as[i] * ka;
+                const std::int64_t b = (i % 4 == 0 && as[i] * ka % kb == 0) ? a : bs[i] * kb;
+                const Length<From, std::int64_t> lhs{a / ka};
+                const Length<To, std::int64_t>   rhs{b / kb};
+                LENGTH_CHECK((lhs == rhs) == (a == b));
+                LENGTH_CHECK((lhs != rhs) == (a != b));
+                LENGTH_CHECK((lhs <  rhs) == (a <  b));
+                LENGTH_CHECK((lhs <= rhs) == (a <= b));
+                LENGTH_CHECK((lhs >  rhs) == (a >  b));
+                LENGTH_CHECK((lhs >= rhs) == (a >= b));
+#if defined(__cpp_lib_three_way_comparison)
+                LENGTH_CHECK((lhs <=> rhs) == (a <=> b));
+#endif
+            }
+        });
+    }
+
+    LENGTH_TEST(floating_comparison_matches_converted_values)
+    {
+        const auto values = random_values(samples);
+        for_each_unit_pair([&](auto from, auto to) {
+            using From = decltype(from);
+            using To   = decltype(to);
+            for (const double v : values)
+            {
+                const Length<From> lhs{v};
+                const Length<To>   rhs = convert<From, To>(lhs);
+                LENGTH_CHECK(!(lhs < rhs * 0.5 && lhs > rhs * 0.5));
+                LENGTH_CHECK((lhs < rhs * 2.0) == (v > 0));
+                LENGTH_CHECK((lhs > rhs * 2.0) == (v < 0));
+                LENGTH_CHECK((lhs == rhs) == !(lhs != rhs));
+                LENGTH_CHECK((lhs <= rhs) == !(lhs > rhs));
+            }
+        });
+    }
+
+    LENGTH_TEST(arithmetic_matches_reference)
+    {
+        const auto as = random_values(samples, -1000, 1000, 3);
+        const auto bs = random_values(samples, -1000, 1000, 4);
+        for_each_unit_pair([&](auto from, auto to) {
+            using From = decltype(from);
+            using To   = decltype(to);
+            for (std::size_t i = 0; i < samples; ++i)
+            {
+                const Length<From> a{as[i]};
+                const Length<To>   b{bs[i]};
+                const long double  ma = in_metres(a);
+                const long double  mb = in_metres(b);
+                const long double  tolerance = 8 * std::numeric_limits<double>::epsilon() * (std::abs(ma) + std::abs(mb));
+
+                LENGTH_CHECK(std::abs(in_metres(a + b) - (ma + mb)) <= tolerance);
+                LENGTH_CHECK(std::abs(in_metres(a - b) - (ma - mb)) <= tolerance);
+                LENGTH_CHECK(std::abs(static_cast<long double>(a / b) - ma / mb) <= 8 * std::numeric_limits<double>::epsilon() * std::abs(ma / mb));
+
+                Length<From> sum = a;
+                sum += b;
+                LENGTH_CHECK(std::abs(in_metres(sum) - (ma + mb)) <= tolerance);
+                sum -= b;
+                LENGTH_CHECK(std::abs(in_metres(sum) - ma) <= 2 * tolerance);
+
+                if constexpr (std::is_same_v<From, To>)
+                {
+                    LENGTH_CHECK((a + b).value() == as[i] + bs[i]);
+                    LENGTH_CHECK((a - b).value() == as[i] - bs[i]);
+                }
+            }
+        });
+
+        for (std::size_t i = 0; i < samples; ++i)
+        {
+            const Length<inch> a{as[i]};
+            const double k = bs[i];
+            LENGTH_CHECK((a * k).value() == as[i] * k);
+            LENGTH_CHECK((k * a).value() == as[i] * k);
+            LENGTH_CHECK((a / k).value() == as[i] / k);
+            Length<inch> scaled = a;
+            scaled *= k;
+            LENGTH_CHECK(scaled.value() == as[i] * k);
+            scaled /= k;
+            LENGTH_CHECK(close(scaled.value(), as[i]));
+        }
+    }
+
+    LENGTH_TEST(integral_arithmetic_is_exact)
+    {
+        const auto as = random_values<std::int64_t>(samples, -100000, 100000, 5);
+        const auto bs = random_values<std::int64_t>(samples, -100000, 100000, 6);
+        for (std::size_t i = 0; i < samples; ++i)
+        {
+            const Length<foot, std::int64_t> a{as[i]};
+            const Length<inch, std::int64_t> b{bs[i] * 12};
+            LENGTH_CHECK(a + b == Length<foot, std::int64_t>{as[i] + bs[i]});
+            LENGTH_CHECK(a - b == Length<foot, std::int64_t>{as[i] - bs[i]});
+            LENGTH_CHECK(b + a == Length<inch, std::int64_t>{(as[i] + bs[i]) * 12});
+            LENGTH_CHECK((a * 3).value() == as[i] * 3);
+            LENGTH_CHECK((a / 7).value() == as[i] / 7);
+
+            Length<inch, std::int64_t> c = b;
+            c += a;
+            LENGTH_CHECK(c.value() == (as[i] + bs[i]) * 12);
+            c -= a;
+            LENGTH_CHECK(c == b);
+        }
+    }
+
+    LENGTH_TEST(common_type_is_lossless)
+    {
+        for_each_unit_pair([&](auto from, auto to) {
+            using From = decltype(from);
+            using To   = decltype(to);
+            using C    = std::common_type_t<Length<From, std::int64_t>, Length<To, std::int64_t>>;
+            constexpr std::intmax_t k = detail::conversion_ratio<From, typename C::unit>::num;
+            static_assert (detail::conversion_ratio<From, typename C::unit>::den == 1);
+            const std::int64_t range = integral_range(k);
+            for (const std::int64_t v : random_values<std::int64_t>(100, -range, range))
+            {
+                const C common = Length<From, std::int64_t>{v};
+                LENGTH_CHECK(common.value() == v * k);
+                LENGTH_CHECK(common == Length<From, std::int64_t>{v});
+            }
+        });
+    }
+
+    LENGTH_TEST(views_alias_values)
+    {
+        std::vector<double> values = random_values(samples);
+        Length<metre>* lengths = as_lengths<metre>(values.data());
+        for (std::size_t i = 0; i < values.size(); ++i)
+        {
+            LENGTH_CHECK(lengths[i].value() == values[i]);
+        }
+        lengths[7] = 3_m;
+        LENGTH_CHECK(values[7] == 3.0);
+        LENGTH_CHECK(as_values(lengths) == values.data());
+        LENGTH_CHECK(detail::rep_cast<float>(Length<metre>{2.5}).value() == 2.5f);
+    }
+
+    LENGTH_TEST(exact_ticks_round_trip)
+    {
+        std::apply([](auto... unit) {
+            auto check = [](auto u) {
+                using Unit = decltype(u);
+                if constexpr (is_exact_unit_v<Unit>)
+                {
+                    constexpr std::intmax_t k = detail::conversion_ratio<Unit, tick>::num;
+                    const std::int64_t range = integral_range(k);
+                    const auto as = random_values<std::int64_t>(samples, -range, range, 7);
+                    const auto bs = random_values<std::int64_t>(samples, -range, range, 8);
+                    for (std::size_t i = 0; i < samples; ++i)
+                    {
+                        const Length<Unit, std::int64_t> a{as[i]};
+                        const Length<Unit, std::int64_t> b{bs[i]};
+                        LENGTH_CHECK(to_exact(a).value() == as[i] * k);
+                        LENGTH_CHECK((from_exact<Unit, std::int64_t>(to_exact(a)) == a));
+                        LENGTH_CHECK(to_exact(a) + to_exact(b) == to_exact(a + b));
+                        LENGTH_CHECK((to_exact(a) < to_exact(b)) == (as[i] < bs[i]));
+                        LENGTH_CHECK(to_exact(a) == a);
+                    }
+                }
+                // floating point lengths round to the nearest tick
+                for (const double v : random_values(samples))
+                {
+                    const Length<Unit> len{v};
+                    const Length<Unit> back = from_exact<Unit>(to_exact(len));
+                    LENGTH_CHECK(std::abs(in_metres(back) - in_metres(len)) <= 0.5L / 2540000 + 1e-15L * std::abs(in_metres(len)));
+                }
+            };
+            (check(unit), ...);
+        }, units{});
+
+        // decimal fractions sum exactly as ticks, unlike doubles
+        for (int i = 0; i < 1000; ++i)
+        {
+            const Length<millimetre> a{i * 0.1};
+            const Length<millimetre> b{(1000 - i) * 0.1};
+            LENGTH_CHECK(to_exact(a) + to_exact(b) == to_exact(100_mm));
+        }
+    }
+
+    LENGTH_TEST(dynamic_length_matches_static)
+    {
+        const auto values = random_values(100);
+        std::vector<double> converted(values.size());
+        for_each_unit_pair([&](auto from, auto to) {
+            using From = decltype(from);
+            using To   = decltype(to);
+            for (const double v : values)
+            {
+                const DynamicLength d{v, unit_id_of<From>};
+                LENGTH_CHECK(close(d.as<To>().value(), convert<From, To>(Length<From>{v}).value()));
+                LENGTH_CHECK(d.to(unit_id_of<To>).unit() == unit_id_of<To>);
+                LENGTH_CHECK(close(d.to(unit_id_of<To>).value(), convert<From, To>(Length<From>{v}).value()));
+            }
+            convert_n(values.data(), values.size(), unit_id_of<From>, unit_id_of<To>, converted.data());
+            for (std::size_t i = 0; i < values.size(); ++i)
+            {
+                LENGTH_CHECK(close(converted[i], convert<From, To>(Length<From>{values[i]}).value()));
+            }
+        });
+    }
+
+    LENGTH_TEST(unit_id_tags_are_validated)
+    {
+        for (unsigned tag = 0; tag <= 0xFF; ++tag)
+        {
+            const std::optional<unit_id> unit = to_unit_id(static_cast<std::uint8_t>(tag));
+            LENGTH_CHECK(unit.has_value() == (tag < unit_count));
+            LENGTH_CHECK(!unit || (static_cast<unsigned>(*unit) == tag && !symbol(*unit).empty()));
+        }
+    }
+}
@@ -0,0 +1,285 @@
+/*********************************************************************************
+ *
+ *  MIT License
+ *
+ *  Copyright (c) 2017 Nenad Zikic
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ *********************************************************************************/
+
+
+// Offload hooks, built with `LENGTH_OFFLOAD` defined for the whole target: a fake
+// host backend with a lowered threshold must be offered every bulk kernel, give
+// the same results as the CPU kernels, and fall back to them when it declines.
+
+#include "test_common.hpp"
+
+#include <length/bulk.hpp>
+#include <length/length_array.hpp>
+#include <length/offload.hpp>
+#include <length/simd.hpp>
+#include <length/vec3.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#if !defined(LENGTH_OFFLOAD)
+#error "offload tests need LENGTH_OFFLOAD"
+#endif
+
+
+namespace
+{
+    using namespace length;
+    using length::test::close;
+    using length::test::random_values;
+
+    enum class hook
+    {
+        multiply,
+        add_scaled,
+        divide,
+        sum,
+        minmax,
+        count_greater,
+        distance,
+        distance_interleaved,
+        count
+    };
+
+    std::size_t calls[static_cast<std::size_t>(hook::count)] = {};
+    bool        accept = true;
+
+    std::size_t& called(hook h) { return calls[static_cast<std::size_t>(h)]; }
+
+    /** Host "device" kernels counting their calls, accepting work only while `accept` is set **/
+    template <typename T>
+    struct fake
+    {
+            static bool multiply(const T* in, T* out, std::size_t n, T k)
+            {
+                ++called(hook::multiply);
+                if (!accept) return false;
+                for (std::size_t i = 0; i < n; ++i) out[i] = in[i] * k;
+                return true;
+            }
+
+            static bool add_scaled(const T* a, const T* b, T k, T* out, std::size_t n)
+            {
+                ++called(hook::add_scaled);
+                if (!accept) return false;
+                for (std::size_t i = 0; i < n; ++i) out[i] = a[i] + b[i] * k;
+                return true;
+            }
+
+            static bool divide(const T* in, T* out, std::size_t n, T k)
+            {
+                ++called(hook::divide);
+                if (!accept) return false;
+                for (std::size_t i = 0; i < n; ++i) out[i] = in[i] / k;
+                return true;
+            }
+
+            static bool sum(const T* data, std::size_t n, T& total)
+            {
+                ++called(hook::sum);
+                if (!accept) return false;
+                total = 0;
+                for (std::size_t i = 0; i < n; ++i) total += data[i];
+                return true;
+            }
+
+            static bool minmax(const T* data, std::size_t n, T& lo, T& hi)
+            {
+                ++called(hook::minmax);
+                if (!accept) return false;
+                const auto [l, h] = std::minmax_element(data, data + n);
+                lo = *l;
+                hi = *h;
+                return true;
+            }
+
+            static bool count_greater(const T* data, std::size_t n, T threshold, std::size_t& count)
+            {
+                ++called(hook::count_greater);
+                if (!accept) return false;
+                count = static_cast<std::size_t>(std::count_if(data, data + n, [&](T v) { return v > threshold; }));
+                return true;
+            }
+
+            static bool distance(const T* ax, const T* ay, const T* az, const T* bx, const T* by, const T* bz, T k, T* out, std::size_t n)
+            {
+                ++called(hook::distance);
+                if (!accept) return false;
+                for (std::size_t i = 0; i < n; ++i) out[i] = norm(ax[i] - bx[i] * k, ay[i] - by[i] * k, az[i] - bz[i] * k);
+                return true;
+            }
+
+            static bool distance_interleaved(const T* a, const T* b, T k, T* out, std::size_t n)
+            {
+                ++called(hook::distance_interleaved);
+                if (!accept) return false;
+                for (std::size_t i = 0; i < n; ++i)
+                {
+                    out[i] = norm(a[3 * i] - b[3 * i] * k, a[3 * i + 1] - b[3 * i + 1] * k, a[3 * i + 2] - b[3 * i + 2] * k);
+                }
+                return true;
+            }
+
+            static T norm(T dx, T dy, T dz) { return std::sqrt(dx * dx + dy * dy + dz * dz); }
+
+            static constexpr offload::kernels<T> table{multiply, sum, minmax, distance, distance_interleaved, add_scaled, divide, count_greater};
+    };
+
+    const offload::backend host{"host", fake<double>::table, fake<float>::table};
+
+    /** Results of every hooked bulk operation over the same inputs **/
+    template <typename T>
+    struct results
+    {
+            std::vector<Length<millimetre, T>> converted;
+            LengthArray<millimetre, T>         added;
+            LengthArray<millimetre, T>         divided;
+            Length<inch, T>                    total;
+            std::pair<Length<inch, T>, Length<inch, T>> range;
+            std::size_t                        greater = 0;
+            std::vector<Length<millimetre, T>> columns;
+            std::vector<Length<millimetre, T>> interleaved;
+    };
+
+    template <typename T>
+    results<T> run_all(std::size_t n)
+    {
+        const auto values = random_values<T>(2 * n, 0, 1000, 7);
+        const Length<inch, T>* in = as_lengths<inch>(values.data());
+        const Length<millimetre, T>* mm = as_lengths<millimetre>(values.data() + n);
+
+        std::vector<Point3<millimetre, T>> a(n);
+        std::vector<Point3<inch, T>> b(n);
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            a[i] = {mm[i], in[i], mm[i] * T{2}};
+            b[i] = {in[i], in[(i + 1) % n], in[(i + 2) % n]};
+        }
+        std::vector<T> xyz(6 * n);
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            xyz[i]         = a[i].x.value();
+            xyz[n + i]     = a[i].y.value();
+            xyz[2 * n + i] = a[i].z.value();
+            xyz[3 * n + i] = b[i].x.value();
+            xyz[4 * n + i] = b[i].y.value();
+            xyz[5 * n + i] = b[i].z.value();
+        }
+
+        results<T> r;
+        r.converted.resize(n);
+        convert_n<inch, millimetre>(in, n, r.converted.data());
+        const LengthArray<millimetre, T> lhs{LengthArrayView<millimetre, T>{mm, n}};
+        const LengthArray<inch, T> rhs{LengthArrayView<inch, T>{in, n}};
+        r.added   = lhs;
+        r.added  += rhs;
+        r.divided = lhs / T{3};
+        r.total   = simd::sum(in, n);
+        r.range   = simd::minmax(in, n);
+        r.greater = simd::count_greater(in, n, Length<inch, T>{T{100}});
+        r.columns.resize(n);
+        distance_n(Point3Columns<millimetre, T>{xyz.data(), xyz.data() + n, xyz.data() + 2 * n},
+                   Point3Columns<inch, T>{xyz.data() + 3 * n, xyz.data() + 4 * n, xyz.data() + 5 * n}, n, r.columns.data());
+        r.interleaved.resize(n);
+        distance_n(a.data(), b.data(), n, r.interleaved.data());
+        return r;
+    }
+
+    template <typename T>
+    bool same_results(const results<T>& x, const results<T>& y)
+    {
+        const std::size_t n = x.converted.size();
+        bool same = y.converted.size() == n && x.added.size() == n && y.added.size() == n && x.divided.size() == n && y.divided.size() == n
+                 && y.columns.size() == n && y.interleaved.size() == n
+                 && close(x.total.value(), y.total.value(), static_cast<T>(n)) && x.range == y.range && x.greater == y.greater;
+        for (std::size_t i = 0; same && i < n; ++i)
+        {
+            same = x.converted[i] == y.converted[i] && close(x.added[i].value(), y.added[i].value(), T{2}) && x.divided[i] == y.divided[i]
+                && close(x.columns[i].value(), y.columns[i].value(), T{8}) && close(x.interleaved[i].value(), y.interleaved[i].value(), T{8});
+        }
+        return same;
+    }
+
+    /** Runs `f` with the fake backend installed and offered work of at least `threshold` values, then restores defaults **/
+    template <typename F>
+    void with_backend(std::size_t threshold, bool accepting, F&& f)
+    {
+        std::fill(std::begin(calls), std::end(calls), std::size_t{0});
+        accept = accepting;
+        const std::size_t previous_threshold = offload::threshold();
+        offload::set_threshold(threshold);
+        const offload::backend* previous = offload::install(&host);
+        f();
+        offload::install(previous);
+        offload::set_threshold(previous_threshold);
+    }
+
+    template <typename T>
+    void check_backend()
+    {
+        constexpr std::size_t n = 1000;
+        const results<T> cpu = run_all<T>(n);
+
+        with_backend(64, true, [&] {
+            LENGTH_CHECK(offload::installed() == &host);
+            const results<T> offloaded = run_all<T>(n);
+            LENGTH_CHECK(same_results(cpu, offloaded));
+            for (const std::size_t c : calls) LENGTH_CHECK(c >= 1);
+            LENGTH_CHECK(called(hook::distance) == 1 && called(hook::distance_interleaved) == 1);
+        });
+
+        // declined work falls back to the CPU kernels, blocks of interleaved points included
+        with_backend(64, false, [&] {
+            LENGTH_CHECK(same_results(cpu, run_all<T>(n)));
+            for (const std::size_t c : calls) LENGTH_CHECK(c >= 1);
+            LENGTH_CHECK(called(hook::distance_interleaved) == 1);
+        });
+
+        // below the threshold the backend is never asked
+        with_backend(n + 1, true, [&] {
+            LENGTH_CHECK(same_results(cpu, run_all<T>(n)));
+            for (const std::size_t c : calls) LENGTH_CHECK(c == 0);
+        });
+    }
+
+    LENGTH_TEST(backend_runs_every_hook)
+    {
+        check_backend<double>();
+        check_backend<float>();
+    }
+
+    LENGTH_TEST(kernels_missing_from_backend_run_on_cpu)
+    {
+        static constexpr offload::backend empty{"empty", {}, {}};
+        const results<double> cpu = run_all<double>(1000);
+        offload::set_threshold(64);
+        const offload::backend* previous = offload::install(&empty);
+        LENGTH_CHECK(same_results(cpu, run_all<double>(1000)));
+        offload::install(previous);
+        offload::set_threshold(offload::default_threshold);
+    }
+}
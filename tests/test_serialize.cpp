@@ -0,0 +1,373 @@
+/*********************************************************************************
+ *
+ *  MIT License
+ *
+ *  Copyright (c) 2017 Nenad Zikic
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ *********************************************************************************/
+
+
+// Binary streams: encode/decode round-trips for every encoding and rep, through
+// chunks of any size, unit conversion on decode, header validation and memory
+// mapped raw files.
+
+#include "test_common.hpp"
+
+#include <length/mapped.hpp>
+#include <length/serialize.hpp>
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <system_error>
+
+
+namespace
+{
+    using namespace length;
+    using length::test::random_values;
+
+    template <typename Unit, typename Rep>
+    std::vector<Length<Unit, Rep>> lengths(const std::vector<Rep>& values)
+    {
+        return {as_lengths<Unit>(values.data()), as_lengths<Unit>(values.data()) + values.size()};
+    }
+
+    /** Encodes `in` writing into chunks of `chunk` bytes **/
+    template <typename Unit, typename Rep>
+    std::vector<char> encode(const std::vector<Length<Unit, Rep>>& in, encoding enc, double quantum, std::size_t chunk)
+    {
+        LengthEncoder<Unit, Rep> encoder{enc, quantum};
+        std::vector<char> out(LengthEncoder<Unit, Rep>::max_encoded_size(in.size()));
+        char* p = encoder.write_header(out.data(), out.data() + out.size(), in.size()).ptr;
+        char* available = p;
+        for (std::size_t done = 0; done < in.size();)
+        {
+            // a value that didn't fit stays in the window grown by the next chunk
+            available = std::min(available + chunk, out.data() + out.size());
+            const encode_result r = encoder.encode(in.data() + done, in.size() - done, p, available);
+            LENGTH_CHECK(r.ec == (done + r.count == in.size() ? std::errc{} : std::errc::value_too_large));
+            LENGTH_CHECK(r.count > 0 || available != out.data() + out.size());
+            if (r.count == 0 && available == out.data() + out.size())
+            {
+                break;
+            }
+            done += r.count;
+            p = r.ptr;
+        }
+        out.resize(static_cast<std::size_t>(p - out.data()));
+        return out;
+    }
+
+    /** Decodes `stream` feeding it in chunks of `chunk` bytes into output chunks of `capacity` lengths **/
+    template <typename Unit, typename Rep>
+    std::vector<Length<Unit, Rep>> decode(const std::vector<char>& stream, std::size_t chunk, std::size_t capacity)
+    {
+        LengthDecoder<Unit, Rep> decoder;
+        const char* const end = stream.data() + stream.size();
+        const decode_result header = decoder.read_header(stream.data(), end);
+        LENGTH_CHECK(header.ec == std::errc{});
+
+        std::vector<Length<Unit, Rep>> out;
+        std::vector<Length<Unit, Rep>> buffer(capacity);
+        const char* p = header.ptr;
+        const char* available = p;
+        while (!decoder.done())
+        {
+            available = std::min(available + chunk, end);
+            const decode_result r = decoder.decode(p, available, buffer.data(), buffer.size());
+            LENGTH_CHECK(r.ec == std::errc{});
+            out.insert(out.end(), buffer.begin(), buffer.begin() + static_cast<std::ptrdiff_t>(r.count));
+            p = r.ptr;
+            if (available == end && r.count == 0)
+            {
+                break;
+            }
+        }
+        LENGTH_CHECK(decoder.done());
+        LENGTH_CHECK(p == end);
+        return out;
+    }
+
+    template <typename Rep>
+    void check_round_trip()
+    {
+        const auto in = lengths<millimetre>(random_values<Rep>(2000));
+        for (const std::size_t chunk : {1, 3, 7, 64, 100000})
+        {
+            for (const std::size_t capacity : {1, 5, 4096})
+            {
+                const auto raw = decode<millimetre, Rep>(encode(in, encoding::raw, 1.0, chunk), chunk, capacity);
+                LENGTH_CHECK(raw.size() == in.size() && std::equal(raw.begin(), raw.end(), in.begin()));
+
+                const double quantum = std::is_integral_v<Rep> ? 1.0 : 0.001;
+                for (const encoding enc : {encoding::quantised, encoding::delta})
+                {
+                    const auto out = decode<millimetre, Rep>(encode(in, enc, quantum, chunk), chunk, capacity);
+                    LENGTH_CHECK(out.size() == in.size());
+                    for (std::size_t i = 0; i < std::min(out.size(), in.size()); ++i)
+                    {
+                        if constexpr (std::is_integral_v<Rep>)
+                        {
+                            LENGTH_CHECK(out[i] == in[i]);
+                        }
+                        else
+                        {
+                            // half a quantum off at most, plus rounding of decoded value to `Rep`
+                            const double error = std::abs(static_cast<double>(out[i].value()) - static_cast<double>(in[i].value()));
+                            LENGTH_CHECK(error <= quantum * (0.5 + 1e-6) + std::abs(in[i].value()) * std::numeric_limits<Rep>::epsilon());
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    LENGTH_TEST(encode_decode_round_trip)
+    {
+        check_round_trip<double>();
+        check_round_trip<float>();
+        check_round_trip<std::int32_t>();
+        check_round_trip<std::int64_t>();
+    }
+
+    LENGTH_TEST(delta_encoding_is_compact)
+    {
+        std::vector<Length<millimetre>> track(10000);
+        for (std::size_t i = 0; i < track.size(); ++i)
+        {
+            track[i] = Length<millimetre>{1e6 + 0.25 * static_cast<double>(i)};
+        }
+        const auto delta = encode(track, encoding::delta, 0.001, 1 << 20);
+        const auto raw   = encode(track, encoding::raw, 1.0, 1 << 20);
+        LENGTH_CHECK(delta.size() < raw.size() / 3);
+    }
+
+    LENGTH_TEST(delta_encoding_wraps_extreme_values)
+    {
+        const std::vector<Length<millimetre, std::int64_t>> in{
+            Length<millimetre, std::int64_t>{INT64_MIN}, Length<millimetre, std::int64_t>{INT64_MAX}, Length<millimetre, std::int64_t>{0},
+            Length<millimetre, std::int64_t>{INT64_MIN}, Length<millimetre, std::int64_t>{-1}, Length<millimetre, std::int64_t>{INT64_MAX}};
+        const auto out = decode<millimetre, std::int64_t>(encode(in, encoding::delta, 1.0, 1 << 20), 1 << 20, 4096);
+        LENGTH_CHECK(out == in);
+    }
+
+    LENGTH_TEST(decode_converts_units)
+    {
+        // integral streams convert exactly when the ratio allows
+        const auto mm = lengths<millimetre>(random_values<std::int64_t>(1000, -1'000'000, 1'000'000));
+        for (const encoding enc : {encoding::raw, encoding::quantised, encoding::delta})
+        {
+            const auto um = decode<micrometre, std::int64_t>(encode(mm, enc, 1.0, 1 << 20), 1 << 20, 4096);
+            LENGTH_CHECK(um.size() == mm.size());
+            for (std::size_t i = 0; i < std::min(um.size(), mm.size()); ++i)
+            {
+                LENGTH_CHECK(um[i].value() == mm[i].value() * 1000);
+            }
+        }
+
+        const auto in = lengths<inch>(random_values(1000));
+        const auto metres = decode<metre, double>(encode(in, encoding::raw, 1.0, 1 << 20), 1 << 20, 4096);
+        const auto floats = decode<foot, float>(encode(in, encoding::raw, 1.0, 1 << 20), 1 << 20, 4096);
+        LENGTH_CHECK(metres.size() == in.size() && floats.size() == in.size());
+        for (std::size_t i = 0; i < std::min(metres.size(), in.size()); ++i)
+        {
+            LENGTH_CHECK(test::close(metres[i].value(), convert<inch, metre>(in[i]).value()));
+            LENGTH_CHECK(test::close(floats[i].value(), static_cast<float>(in[i].value() / 12)));
+        }
+    }
+
+    LENGTH_TEST(decoded_values_out_of_range_are_reported)
+    {
+        // 9.3e9 m is 9.3e18 nm, its rescale overflows intmax_t; 3e6 m doesn't fit int32 millimetres
+        const std::vector<Length<metre, std::int64_t>> in{Length<metre, std::int64_t>{1}, Length<metre, std::int64_t>{9'300'000'000},
+                                                          Length<metre, std::int64_t>{3'000'000}, Length<metre, std::int64_t>{2}};
+        for (const encoding enc : {encoding::raw, encoding::quantised, encoding::delta})
+        {
+            const auto stream = encode(in, enc, 1.0, 1 << 20);
+            const char* const end = stream.data() + stream.size();
+
+            LengthDecoder<nanometre, std::int64_t> nm;
+            Length<nanometre, std::int64_t> nms[4];
+            const char* p = nm.read_header(stream.data(), end).ptr;
+            const decode_result first = nm.decode(p, end, nms, 4);
+            LENGTH_CHECK(first.ec == std::errc::value_too_large && first.count == 1 && nms[0].value() == 1'000'000'000);
+            LENGTH_CHECK(first.ptr > p && first.ptr < end && !nm.done());
+            // the value stays unconsumed and is reported again
+            LENGTH_CHECK(nm.decode(first.ptr, end, nms, 4).ec == std::errc::value_too_large);
+
+            LengthDecoder<millimetre, std::int32_t> mm;
+            Length<millimetre, std::int32_t> mms[4];
+            const decode_result second = mm.decode(mm.read_header(stream.data(), end).ptr, end, mms, 4);
+            LENGTH_CHECK(second.ec == std::errc::value_too_large && second.count == 1 && mms[0].value() == 1000);
+        }
+    }
+
+    LENGTH_TEST(streaming_with_unknown_count)
+    {
+        const auto in = lengths<foot>(random_values(100));
+        LengthEncoder<foot> encoder{encoding::delta, 1e-6};
+        std::vector<char> stream(LengthEncoder<foot>::max_encoded_size(in.size()));
+        char* p = encoder.write_header(stream.data(), stream.data() + stream.size()).ptr;
+        p = encoder.encode(in.data(), in.size(), p, stream.data() + stream.size()).ptr;
+
+        LengthDecoder<foot> decoder;
+        const decode_result header = decoder.read_header(stream.data(), p);
+        LENGTH_CHECK(decoder.header().count == unknown_count && !decoder.done());
+        std::vector<Length<foot>> out(in.size() + 1);
+        const decode_result r = decoder.decode(header.ptr, p, out.data(), out.size());
+        LENGTH_CHECK(r.ec == std::errc{} && r.count == in.size() && r.ptr == p);
+    }
+
+    LENGTH_TEST(invalid_streams_are_rejected)
+    {
+        const auto in = lengths<yard>(random_values(10));
+        const auto stream = encode(in, encoding::quantised, 0.5, 1 << 20);
+
+        LengthDecoder<yard> decoder;
+        LENGTH_CHECK(decoder.read_header(stream.data(), stream.data() + 39).ec == std::errc::resource_unavailable_try_again);
+
+        // every corrupted header field is reported
+        for (const auto& [offset, byte] : std::vector<std::pair<std::size_t, char>>{{0, 'X'}, {4, 2}, {5, 3}, {6, 0}, {6, 5}, {15, char(0x80)}})
+        {
+            std::vector<char> corrupted = stream;
+            corrupted[offset] = byte;
+            const decode_result r = decoder.read_header(corrupted.data(), corrupted.data() + corrupted.size());
+            LENGTH_CHECK(r.ec == std::errc::invalid_argument && r.ptr == corrupted.data());
+        }
+
+        // zero unit ratio denominator
+        std::vector<char> zero_den = stream;
+        LENGTH_CHECK(zero_den.size() >= 40);
+        for (std::size_t i = 16; i < 24; ++i)
+        {
+            zero_den[i] = 0;
+        }
+        const decode_result zero = decoder.read_header(zero_den.data(), zero_den.data() + zero_den.size());
+        LENGTH_CHECK(zero.ec == std::errc::invalid_argument && zero.ptr == zero_den.data());
+
+        // unit ratio overflowing intmax_t after cross reduction
+        std::vector<char> huge = stream;
+        for (std::size_t i = 0; i < 8; ++i)
+        {
+            huge[8 + i]  = char(i == 7 ? 0x7F : 0xFF);
+            huge[16 + i] = char(i == 0 ? 1 : 0);
+        }
+        LENGTH_CHECK(decoder.read_header(huge.data(), huge.data() + huge.size()).ec == std::errc::invalid_argument);
+
+        // 10th varint byte may only hold the top bit
+        for (const char last : {char(0x01), char(0x02)})
+        {
+            std::vector<char> ten(stream.begin(), stream.begin() + 40);
+            ten.insert(ten.end(), 9, char(0xFF));
+            ten.push_back(last);
+            Length<yard> value[1];
+            const decode_result h = decoder.read_header(ten.data(), ten.data() + ten.size());
+            const decode_result r = decoder.decode(h.ptr, ten.data() + ten.size(), value, 1);
+            LENGTH_CHECK(last == 0x01 ? r.ec == std::errc{} && r.count == 1 : r.ec == std::errc::invalid_argument && r.count == 0);
+        }
+
+        // unterminated varint
+        std::vector<char> overlong(stream.begin(), stream.begin() + 40);
+        overlong.insert(overlong.end(), 11, char(0xFF));
+        Length<yard> out[1];
+        const decode_result header = decoder.read_header(overlong.data(), overlong.data() + overlong.size());
+        LENGTH_CHECK(header.ec == std::errc{});
+        LENGTH_CHECK(decoder.decode(header.ptr, overlong.data() + overlong.size(), out, 1).ec == std::errc::invalid_argument);
+    }
+
+    /** Temporary file removed on destruction **/
+    struct temporary_file
+    {
+            std::filesystem::path path;
+
+            explicit temporary_file(const std::string& name)
+                : path{std::filesystem::temp_directory_path() / (name + "." + std::to_string(std::random_device{}()) + ".lens")} {}
+
+            ~temporary_file() { std::error_code ec; std::filesystem::remove(path, ec); }
+
+            void write(const std::vector<char>& bytes) const
+            {
+                std::ofstream{path, std::ios::binary}.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+            }
+    };
+
+    LENGTH_TEST(mapped_file_views_raw_stream)
+    {
+        const auto in = lengths<millimetre>(random_values(12345));
+        const temporary_file file{"length_test_mapped"};
+        file.write(encode(in, encoding::raw, 1.0, 1 << 20));
+
+        const MappedLengthFile<millimetre> mapped{file.path};
+        LENGTH_CHECK(mapped.is_mapped() && mapped.size() == in.size());
+        LENGTH_CHECK(std::equal(mapped.begin(), mapped.end(), in.begin(), in.end()));
+        LENGTH_CHECK(mapped.view().size() == in.size() && mapped.values()[7] == in[7].value());
+        LENGTH_CHECK(mapped.at<metre>(3) == convert<millimetre, metre>(in[3]));
+
+        std::vector<Length<metre>> metres(100);
+        LENGTH_CHECK(mapped.convert_to<metre>(50, metres.size(), metres.data()) == metres.data() + metres.size());
+        for (std::size_t i = 0; i < metres.size(); ++i)
+        {
+            LENGTH_CHECK(test::close(metres[i].value(), in[50 + i].value() / 1000));
+        }
+
+        MappedLengthFile<millimetre> moved = std::move(const_cast<MappedLengthFile<millimetre>&>(mapped));
+        LENGTH_CHECK(moved.size() == in.size() && !mapped.is_mapped());
+        moved.unmap();
+        LENGTH_CHECK(!moved.is_mapped() && moved.empty());
+    }
+
+    LENGTH_TEST(mapped_file_rejects_other_streams)
+    {
+        const auto in = lengths<millimetre>(random_values(100));
+        const temporary_file file{"length_test_mapped"};
+
+        MappedLengthFile<millimetre> mapped;
+        LENGTH_CHECK(mapped.map(file.path) && !mapped.is_mapped());
+
+        file.write(encode(in, encoding::delta, 0.01, 1 << 20));
+        LENGTH_CHECK(mapped.map(file.path) == std::errc::invalid_argument);
+        LENGTH_CHECK(MappedLengthFile<metre>{}.map(file.path) == std::errc::invalid_argument);
+
+        file.write(encode(in, encoding::raw, 1.0, 1 << 20));
+        LENGTH_CHECK(MappedLengthFile<metre>{}.map(file.path) == std::errc::invalid_argument);
+        LENGTH_CHECK(MappedLengthFile<millimetre, float>{}.map(file.path) == std::errc::invalid_argument);
+        LENGTH_CHECK(!mapped.map(file.path) && mapped.size() == in.size());
+
+        // truncated payload
+        std::vector<char> truncated = encode(in, encoding::raw, 1.0, 1 << 20);
+        truncated.resize(truncated.size() - 1);
+        file.write(truncated);
+        LENGTH_CHECK(mapped.map(file.path) == std::errc::invalid_argument && !mapped.is_mapped());
+
+        bool thrown = false;
+        try
+        {
+            const MappedLengthFile<millimetre> throwing{file.path};
+        }
+        catch (const std::system_error& e)
+        {
+            thrown = e.code() == std::errc::invalid_argument;
+        }
+        LENGTH_CHECK(thrown);
+    }
+}
@@ -0,0 +1,426 @@
+/*********************************************************************************
+ *
+ *  MIT License
+ *
+ *  Copyright (c) 2017 Nenad Zikic
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ *********************************************************************************/
+
+
+// Bulk kernels of every instruction set the CPU supports against scalar
+// references, runtime dispatch and the bulk, SIMD and parallel APIs built on them.
+
+#include "test_common.hpp"
+
+#include <length/bulk.hpp>
+#include <length/parallel.hpp>
+#include <length/simd.hpp>
+
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <utility>
+
+// scalar references are compared exactly with kernels, which never fuse multiply-add
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC optimize("fp-contract=off")
+#endif
+
+
+namespace
+{
+    using namespace length;
+    using length::test::close;
+    using length::test::random_values;
+
+    /** Sizes around every vector width and unroll factor, plus a long tail **/
+    constexpr std::size_t sizes[] = {0, 1, 2, 3, 4, 5, 7, 8, 9, 15, 16, 17, 31, 32, 33, 63, 64, 65, 100, 1000, 1001};
+
+    template <typename T>
+    struct kernel_table
+    {
+            const char* name;
+            void        (*multiply)(const T*, T*, std::size_t, T);
+            void        (*add_scaled)(const T*, const T*, T, T*, std::size_t);
+            void        (*divide)(const T*, T*, std::size_t, T);
+            T           (*sum)(const T*, std::size_t);
+            void        (*compensated_sum)(const T*, std::size_t, T, T&, T&);
+            void        (*minmax)(const T*, std::size_t, T&, T&);
+            std::size_t (*count_greater)(const T*, std::size_t, T);
+            void        (*distance)(const T*, const T*, const T*, const T*, const T*, const T*, T, T*, std::size_t);
+    };
+
+#define LENGTH_TEST_KERNELS(ns, T)                                                                      \
+    kernel_table<T>{#ns, simd::detail::ns::multiply<T>, simd::detail::ns::add_scaled<T>,               \
+                    simd::detail::ns::divide<T>, simd::detail::ns::sum<T>,                              \
+                    simd::detail::ns::compensated_sum<T>, simd::detail::ns::minmax<T>,                  \
+                    simd::detail::ns::count_greater<T>, simd::detail::ns::distance<T>}
+
+    /** Kernels of the scalar fallback and of every instruction set supported by this CPU **/
+    template <typename T>
+    std::vector<kernel_table<T>> supported_kernels()
+    {
+        std::vector<kernel_table<T>> tables{LENGTH_TEST_KERNELS(scalar, T)};
+        [[maybe_unused]] const simd::isa cpu = simd::detect_isa();
+#if defined(LENGTH_SIMD_X86)
+        if (cpu >= simd::isa::sse2)   tables.push_back(LENGTH_TEST_KERNELS(sse2, T));
+        if (cpu >= simd::isa::avx2)   tables.push_back(LENGTH_TEST_KERNELS(avx2, T));
+        if (cpu == simd::isa::avx512) tables.push_back(LENGTH_TEST_KERNELS(avx512, T));
+#elif defined(LENGTH_SIMD_NEON)
+        tables.push_back(LENGTH_TEST_KERNELS(neon, T));
+#endif
+        return tables;
+    }
+
+#undef LENGTH_TEST_KERNELS
+
+    template <typename T>
+    void check_kernels()
+    {
+        const auto a  = random_values<T>(1002, -1000, 1000, 1);
+        const auto b  = random_values<T>(1002, -1000, 1000, 2);
+        const auto c  = random_values<T>(1002, -1000, 1000, 3);
+        const T k = static_cast<T>(0.0254);
+        const T tolerance = 4 * std::numeric_limits<T>::epsilon();
+
+        for (const kernel_table<T>& kernels : supported_kernels<T>())
+        {
+            std::printf("  %s %s\n", kernels.name, sizeof(T) == 8 ? "double" : "float");
+            for (const std::size_t n : sizes)
+            {
+                // offset by one value, so vector loads are unaligned
+                const T* x = a.data() + 1;
+                const T* y = b.data() + 1;
+                const T* z = c.data() + 1;
+                std::vector<T> out(n + 1, T{-1});
+
+                kernels.multiply(x, out.data(), n, k);
+                for (std::size_t i = 0; i < n; ++i) LENGTH_CHECK(out[i] == x[i] * k);
+                LENGTH_CHECK(out[n] == T{-1});
+
+                kernels.divide(x, out.data(), n, k);
+                for (std::size_t i = 0; i < n; ++i) LENGTH_CHECK(out[i] == x[i] / k);
+
+                kernels.add_scaled(x, y, k, out.data(), n);
+                for (std::size_t i = 0; i < n; ++i) LENGTH_CHECK(close(out[i], x[i] + y[i] * k, T{2}));
+
+                // in place
+                std::vector<T> inplace(x, x + n);
+                kernels.multiply(inplace.data(), inplace.data(), n, k);
+                for (std::size_t i = 0; i < n; ++i) LENGTH_CHECK(inplace[i] == x[i] * k);
+
+                long double exact = 0;
+                long double magnitude = 0;
+                T lo = simd::detail::highest<T>();
+                T hi = simd::detail::lowest<T>();
+                std::size_t greater = 0;
+                for (std::size_t i = 0; i < n; ++i)
+                {
+                    exact += x[i];
+                    magnitude += std::abs(x[i]);
+                    lo = std::min(lo, x[i]);
+                    hi = std::max(hi, x[i]);
+                    greater += x[i] > y[0] ? 1 : 0;
+                }
+                LENGTH_CHECK(std::abs(kernels.sum(x, n) - exact) <= static_cast<long double>(n) * tolerance * magnitude + 1e-30L);
+
+                T total = 0;
+                T error = 0;
+                kernels.compensated_sum(x, n, T{1}, total, error);
+                LENGTH_CHECK(std::abs(static_cast<long double>(total) + error - exact) <= tolerance * (std::abs(exact) + 1e-3L * magnitude / (n + 1)));
+
+                T klo = 0;
+                T khi = 0;
+                kernels.minmax(x, n, klo, khi);
+                LENGTH_CHECK(klo == lo);
+                LENGTH_CHECK(khi == hi);
+
+                LENGTH_CHECK(kernels.count_greater(x, n, y[0]) == greater);
+                if (n > 0)
+                {
+                    // values equal to threshold are not counted
+                    LENGTH_CHECK(kernels.count_greater(x, n, x[n - 1]) + 1 == static_cast<std::size_t>(std::count_if(x, x + n, [&](T v) { return v >= x[n - 1]; })));
+                }
+
+                kernels.distance(x, y, z, z, x, y, k, out.data(), n);
+                for (std::size_t i = 0; i < n; ++i)
+                {
+                    const long double dx = x[i] - static_cast<long double>(z[i]) * k;
+                    const long double dy = y[i] - static_cast<long double>(x[i]) * k;
+                    const long double dz = z[i] - static_cast<long double>(y[i]) * k;
+                    const long double want = std::sqrt(dx * dx + dy * dy + dz * dz);
+                    LENGTH_CHECK(std::abs(out[i] - want) <= 8 * tolerance * (want + std::abs(x[i]) + std::abs(y[i]) + std::abs(z[i])));
+                }
+            }
+        }
+    }
+
+    LENGTH_TEST(kernels_match_scalar_reference)
+    {
+        check_kernels<double>();
+        check_kernels<float>();
+    }
+
+    /** `add_scaled` of every ISA rounds exactly like mixed unit `Length` `+` and `-`, which `LengthArray` relies on **/
+    template <typename T>
+    void check_add_scaled_operators()
+    {
+        const auto a = random_values<T>(1001, -1000, 1000, 4);
+        const auto b = random_values<T>(1001, -1000, 1000, 5);
+        const Length<millimetre, T>* mm = as_lengths<millimetre>(a.data());
+        const Length<inch, T>*       in = as_lengths<inch>(b.data());
+        const T k = convert<inch, millimetre>(Length<inch, T>{1}).value();
+
+        for (const kernel_table<T>& kernels : supported_kernels<T>())
+        {
+            std::vector<T> out(a.size());
+            kernels.add_scaled(a.data(), b.data(), k, out.data(), a.size());
+            for (std::size_t i = 0; i < a.size(); ++i) LENGTH_CHECK(out[i] == (mm[i] + convert<inch, millimetre>(in[i])).value());
+
+            kernels.add_scaled(a.data(), b.data(), -k, out.data(), a.size());
+            for (std::size_t i = 0; i < a.size(); ++i) LENGTH_CHECK(out[i] == (mm[i] - convert<inch, millimetre>(in[i])).value());
+        }
+    }
+
+    LENGTH_TEST(add_scaled_matches_length_operators)
+    {
+        check_add_scaled_operators<double>();
+        check_add_scaled_operators<float>();
+    }
+
+    LENGTH_TEST(dispatch_selects_supported_isa)
+    {
+        LENGTH_CHECK(simd::active_isa() == simd::detect_isa());
+        LENGTH_CHECK(std::strlen(simd::to_string(simd::active_isa())) > 0);
+        LENGTH_CHECK(std::strcmp(simd::to_string(simd::isa::avx2), "avx2") == 0);
+    }
+
+    template <typename Rep>
+    void check_lengths_api()
+    {
+        for (const std::size_t n : sizes)
+        {
+            const auto values = random_values<Rep>(n, -1000, 1000, static_cast<unsigned>(n));
+            const Length<millimetre, Rep>* data = as_lengths<millimetre>(values.data());
+
+            Rep sum = 0;
+            Rep lo = simd::detail::highest<Rep>();
+            Rep hi = simd::detail::lowest<Rep>();
+            std::size_t greater = 0;
+            for (const Rep v : values)
+            {
+                sum += v;
+                lo = std::min(lo, v);
+                hi = std::max(hi, v);
+                greater += Length<millimetre, Rep>{v} > 1_cm ? 1 : 0;
+            }
+            if constexpr (std::is_integral_v<Rep>)
+            {
+                LENGTH_CHECK(simd::sum(data, n).value() == sum);
+            }
+            else
+            {
+                LENGTH_CHECK(std::abs(simd::sum(data, n).value() - sum) <= 1e-3 * (1 + std::abs(sum)));
+            }
+            const auto [min, max] = simd::minmax(data, n);
+            LENGTH_CHECK(min.value() == lo);
+            LENGTH_CHECK(max.value() == hi);
+            LENGTH_CHECK(simd::count_greater(data, n, 1_cm) == greater);
+
+            std::vector<Length<millimetre, Rep>> scaled(n);
+            simd::scale(data, n, Rep{3}, scaled.data());
+            for (std::size_t i = 0; i < n; ++i) LENGTH_CHECK(scaled[i] == data[i] * Rep{3});
+        }
+    }
+
+    LENGTH_TEST(simd_api_matches_operators)
+    {
+        check_lengths_api<double>();
+        check_lengths_api<float>();
+        check_lengths_api<std::int32_t>();
+        check_lengths_api<std::int64_t>();
+    }
+
+    /** `count_greater` of `Unit` data against thresholds in `ThresholdUnit`, both signs, matches `operator>` **/
+    template <typename Unit, typename ThresholdUnit, typename Rep, typename Count>
+    void check_integral_thresholds(Count&& count_greater, std::size_t n = 1000)
+    {
+        const auto values = random_values<Rep>(n, -300, 300);
+        const Length<Unit, Rep>* data = as_lengths<Unit>(values.data());
+        for (Rep t = -12; t <= 12; ++t)
+        {
+            const Length<ThresholdUnit, Rep> threshold{t};
+            const auto greater = static_cast<std::size_t>(std::count_if(data, data + values.size(), [&](auto e) { return e > threshold; }));
+            LENGTH_CHECK(count_greater(data, values.size(), threshold) == greater);
+        }
+    }
+
+    LENGTH_TEST(count_greater_floors_integral_thresholds)
+    {
+        // e.g. -1 in is -25.4 mm, so -25 mm is greater and -26 mm is not
+        const Length<millimetre, int> mm[] = {Length<millimetre, int>{-26}, Length<millimetre, int>{-25}};
+        LENGTH_CHECK(simd::count_greater(mm, 2, Length<inch, int>{-1}) == 1);
+
+        const auto serial = [](const auto* data, std::size_t n, const auto& threshold) { return simd::count_greater(data, n, threshold); };
+        check_integral_thresholds<millimetre, inch, std::int32_t>(serial);
+        check_integral_thresholds<millimetre, inch, std::int64_t>(serial);
+        check_integral_thresholds<inch, foot, std::int64_t>(serial);
+        check_integral_thresholds<foot, inch, std::int32_t>(serial);
+        check_integral_thresholds<inch, millimetre, std::int64_t>(serial);
+    }
+
+    LENGTH_TEST(count_greater_rounds_narrowed_float_thresholds)
+    {
+        // float 0.1 is above double 0.1, so it is greater than 0.1 m and 100 mm
+        std::vector<float> values;
+        for (float v = 0.1f, below = v; values.size() < 64; v = std::nextafter(v, 1.0f), below = std::nextafter(below, 0.0f))
+        {
+            values.insert(values.end(), {v, below, v * 1000, below * 1000});
+        }
+        values.insert(values.end(), {std::numeric_limits<float>::max(), std::numeric_limits<float>::infinity(), -std::numeric_limits<float>::infinity()});
+
+        const auto check = [&](const auto* data, const auto& threshold) {
+            const auto greater = static_cast<std::size_t>(std::count_if(data, data + values.size(), [&](auto e) { return e > threshold; }));
+            LENGTH_CHECK(simd::count_greater(data, values.size(), threshold) == greater);
+        };
+        for (const double t : {0.1, 100.0, 1e39, -1e39, std::numeric_limits<double>::infinity(), -std::numeric_limits<double>::infinity()})
+        {
+            check(as_lengths<metre>(values.data()), Length<metre>{t});
+            check(as_lengths<millimetre>(values.data()), Length<metre>{t / 1000});
+            check(as_lengths<millimetre>(values.data()), Length<millimetre>{t});
+        }
+        LENGTH_CHECK(simd::count_greater(as_lengths<metre>(values.data()), 1, 0.1_m) == 1);
+    }
+
+    template <typename FromUnit, typename ToUnit, typename Rep>
+    void check_bulk_convert()
+    {
+        for (const std::size_t n : sizes)
+        {
+            const auto values = random_values<Rep>(n, -1000, 1000, static_cast<unsigned>(n));
+            const Length<FromUnit, Rep>* in = as_lengths<FromUnit>(values.data());
+            std::vector<Length<ToUnit, Rep>> out(n);
+            LENGTH_CHECK(convert_n<FromUnit, ToUnit>(in, n, out.data()) == out.data() + n);
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                LENGTH_CHECK(out[i].value() == convert<FromUnit, ToUnit>(in[i]).value());
+            }
+
+            std::vector<Length<FromUnit, Rep>> buffer(in, in + n);
+            const Length<ToUnit, Rep>* converted = convert_in_place<FromUnit, ToUnit>(buffer.data(), n);
+            LENGTH_CHECK(static_cast<const void*>(converted) == static_cast<const void*>(buffer.data()));
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                LENGTH_CHECK(converted[i].value() == out[i].value());
+            }
+        }
+    }
+
+    LENGTH_TEST(bulk_convert_matches_convert)
+    {
+        check_bulk_convert<inch, metre, double>();
+        check_bulk_convert<foot, millimetre, float>();
+        check_bulk_convert<metre, metre, double>();
+        check_bulk_convert<foot, inch, std::int32_t>();
+        check_bulk_convert<millimetre, inch, std::int64_t>();
+        check_bulk_convert<nautical_mile, nanometre, double>();
+    }
+
+#if defined(__cpp_lib_span)
+    LENGTH_TEST(span_convert_truncates_to_shorter_output)
+    {
+        const auto values = random_values(100);
+        const std::vector<Length<inch>> in(as_lengths<inch>(values.data()), as_lengths<inch>(values.data()) + values.size());
+        std::vector<Length<metre>> out(60, Length<metre>{-1});
+        const auto converted = convert<inch, metre>(std::span{in}, std::span{out}.first(50));
+        LENGTH_CHECK(converted.data() == out.data() && converted.size() == 50);
+        LENGTH_CHECK(out[49] == convert<inch, metre>(in[49]) && out[50].value() == -1);
+        LENGTH_CHECK(convert<inch, metre>(std::span{in}.first(10), std::span{out}).size() == 10);
+    }
+#endif
+
+    /** Executor running chunks on a few threads, like an application thread pool **/
+    struct thread_pool
+    {
+            template <typename Task>
+            void parallel_for(std::size_t count, Task task)
+            {
+                std::vector<std::thread> threads;
+                for (std::size_t w = 0; w < 4; ++w)
+                {
+                    threads.emplace_back([=] {
+                        for (std::size_t i = w; i < count; i += 4)
+                        {
+                            task(i);
+                        }
+                    });
+                }
+                for (std::thread& t : threads)
+                {
+                    t.join();
+                }
+            }
+    };
+
+    template <typename Executor>
+    void check_parallel(Executor&& executor)
+    {
+        // several chunks and a partial one
+        const std::size_t n = 3 * length::detail::parallel_chunk_size<double> + 123;
+        const auto values = random_values(n);
+        const Length<inch>* in = as_lengths<inch>(values.data());
+
+        std::vector<Length<metre>> sequential(n);
+        std::vector<Length<metre>> parallel(n);
+        convert_n<inch, metre>(in, n, sequential.data());
+        convert_n<inch, metre>(executor, in, n, parallel.data());
+        LENGTH_CHECK(std::memcmp(sequential.data(), parallel.data(), n * sizeof(double)) == 0);
+
+        const Length<inch> sum = simd::sum(executor, in, n);
+        LENGTH_CHECK(sum == simd::sum(executor, in, n));
+        LENGTH_CHECK(std::abs(sum.value() - simd::sum(in, n).value()) <= 1e-9 * n);
+        LENGTH_CHECK(simd::minmax(executor, in, n) == simd::minmax(in, n));
+        LENGTH_CHECK(simd::count_greater(executor, in, n, 1_cm) == simd::count_greater(in, n, 1_cm));
+
+        std::vector<Length<inch>> scaled(n);
+        simd::scale(executor, in, n, 2.0, scaled.data());
+        for (std::size_t i = 0; i < n; ++i) LENGTH_CHECK(scaled[i] == in[i] * 2.0);
+
+        // integral thresholds of both signs across chunks
+        const auto parallel_count = [&](const auto* data, std::size_t size, const auto& threshold) { return simd::count_greater(executor, data, size, threshold); };
+        check_integral_thresholds<millimetre, inch, std::int32_t>(parallel_count, n);
+        check_integral_thresholds<inch, millimetre, std::int64_t>(parallel_count, n);
+        check_integral_thresholds<foot, inch, std::int64_t>(parallel_count, n);
+
+        const auto total = accumulate(executor, in, n);
+        LENGTH_CHECK(total.total() == accumulate(executor, in, n).total());
+        LENGTH_CHECK(std::abs(total.total().value() - accumulate(in, n).total().value()) <= 1e-12 * n);
+    }
+
+    LENGTH_TEST(parallel_overloads_match_sequential)
+    {
+        check_parallel(thread_pool{});
+#if defined(LENGTH_TEST_EXECUTION_POLICIES)
+        check_parallel(std::execution::par);
+        check_parallel(std::execution::par_unseq);
+#endif
+    }
+}
@@ -0,0 +1,299 @@
+/*********************************************************************************
+ *
+ *  MIT License
+ *
+ *  Copyright (c) 2017 Nenad Zikic
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ *********************************************************************************/
+
+
+// Text round-trips: `to_chars` output parses back to the same value for every
+// unit and rep, bulk delimited parsing, error reporting and formatters.
+
+#include "test_common.hpp"
+
+#include <length/format.hpp>
+#include <length/parse.hpp>
+
+#include <cstdint>
+#include <locale>
+#include <string>
+#include <string_view>
+#include <tuple>
+
+
+namespace
+{
+    using namespace length;
+    using length::test::random_values;
+
+    using units = std::tuple<metre, centimetre, millimetre, micrometre, nanometre, inch, foot, yard, mile, nautical_mile>;
+
+    /** Doubles of every magnitude and sign, including values with long shortest representation **/
+    std::vector<double> interesting_values()
+    {
+        std::vector<double> values = random_values(1000);
+        for (double e = -300; e <= 300; e += 7)
+        {
+            values.push_back(std::pow(10.0, e) * 1.2345678901234567);
+            values.push_back(-std::pow(2.0, e / 3));
+        }
+        // subnormals are left out, some `std::from_chars` implementations report them as out of range
+        values.insert(values.end(), {0.0, -0.0, 0.1, 0.1 + 0.2, 1.0 / 3, std::numeric_limits<double>::max(),
+                                     std::numeric_limits<double>::min()});
+        return values;
+    }
+
+    template <typename Unit, typename Rep>
+    std::string formatted(const Length<Unit, Rep>& length)
+    {
+        char buffer[64];
+        const auto [end, ec] = to_chars(buffer, buffer + sizeof buffer, length);
+        LENGTH_CHECK(ec == std::errc{});
+        return std::string(buffer, end);
+    }
+
+    LENGTH_TEST(format_parse_round_trip)
+    {
+        const std::vector<double> values = interesting_values();
+        std::apply([&](auto... unit) {
+            auto check = [&](auto u) {
+                using Unit = decltype(u);
+                for (const double v : values)
+                {
+                    const std::string text = formatted(Length<Unit>{v});
+                    LENGTH_CHECK(text.substr(text.size() - Unit::symbol.size()) == Unit::symbol);
+
+                    Length<Unit> parsed{-1};
+                    const parse_result r = parse(text, parsed);
+                    LENGTH_CHECK(r.ec == std::errc{});
+                    LENGTH_CHECK(r.ptr == text.data() + text.size());
+                    LENGTH_CHECK(parsed.value() == v);
+
+                    // the same text keeps its unit when parsed with unit known at run time only
+                    any_length any;
+                    LENGTH_CHECK(parse(text, any).ec == std::errc{});
+                    LENGTH_CHECK(std::holds_alternative<Length<Unit>>(any) && std::get<Length<Unit>>(any).value() == v);
+                    DynamicLength dynamic;
+                    LENGTH_CHECK(parse(text, dynamic).ec == std::errc{});
+                    LENGTH_CHECK(dynamic.unit() == unit_id_of<Unit> && dynamic.value() == v);
+
+                    const float f = static_cast<float>(v);
+                    if (std::isfinite(f))
+                    {
+                        Length<Unit, float> parsed_float;
+                        LENGTH_CHECK(parse(formatted(Length<Unit, float>{f}), parsed_float).ec == std::errc{});
+                        LENGTH_CHECK(parsed_float.value() == f);
+                    }
+                }
+                for (const std::int64_t v : random_values<std::int64_t>(1000, -1e15, 1e15))
+                {
+                    Length<Unit, std::int64_t> parsed;
+                    LENGTH_CHECK(parse(formatted(Length<Unit, std::int64_t>{v}), parsed).ec == std::errc{});
+                    LENGTH_CHECK(parsed.value() == v);
+                }
+            };
+            (check(unit), ...);
+        }, units{});
+    }
+
+    LENGTH_TEST(parse_converts_units)
+    {
+        for (const double v : random_values(1000))
+        {
+            Length<metre> m;
+            LENGTH_CHECK(parse(formatted(Length<inch>{v}), m).ec == std::errc{});
+            LENGTH_CHECK(m.value() == convert<inch, metre>(Length<inch>{v}).value());
+        }
+
+        // integral reps round to nearest
+        Length<millimetre, std::int32_t> mm;
+        LENGTH_CHECK(parse("2.54 cm", mm).ec == std::errc{} && mm.value() == 25);
+        LENGTH_CHECK(parse("2.56 cm", mm).ec == std::errc{} && mm.value() == 26);
+        LENGTH_CHECK(parse("-1 in", mm).ec == std::errc{} && mm.value() == -25);
+        LENGTH_CHECK(parse("3ft", mm).ec == std::errc{} && mm.value() == 914);
+        LENGTH_CHECK(parse("  7   nmi", mm).ec == std::errc{} && mm.value() == 12964000);
+    }
+
+    LENGTH_TEST(parse_reports_errors)
+    {
+        Length<metre> m{5};
+        for (const std::string_view bad : {"", "m", "abc", "5", "5 ", "5 mx", "5 meter", "- 5 m", "5 M", "+-5 m", "++5 m", "+ 5 m"})
+        {
+            const parse_result r = parse(bad, m);
+            LENGTH_CHECK(r.ec == std::errc::invalid_argument);
+            LENGTH_CHECK(r.ptr == bad.data());
+            LENGTH_CHECK(m.value() == 5);
+        }
+        LENGTH_CHECK(parse("1e999 m", m).ec == std::errc::result_out_of_range);
+        LENGTH_CHECK(parse("+7 m", m).ec == std::errc{} && m.value() == 7);
+
+        // symbol prefix of a longer one must not match, "5 m," stops after "m"
+        const std::string_view text = "5 m,";
+        const parse_result r = parse(text, m);
+        LENGTH_CHECK(r.ec == std::errc{} && r.ptr == text.data() + 3 && m.value() == 5);
+        LENGTH_CHECK(parse("5 nm", m).ec == std::errc{} && m.value() == 5e-9);
+        LENGTH_CHECK(parse("5 nmi", m).ec == std::errc{} && m.value() == 9260);
+    }
+
+    LENGTH_TEST(parse_n_round_trip)
+    {
+        const auto values = random_values(5000);
+        std::string csv;
+        for (std::size_t i = 0; i < values.size(); ++i)
+        {
+            csv += (i % 3 == 0) ? formatted(Length<foot>{values[i]}) : formatted(convert<foot, millimetre>(Length<foot>{values[i]}));
+            csv += (i % 7 == 6) ? "\n" : (i % 2 ? " , " : ",");
+        }
+        csv += ",,\n";
+
+        std::vector<Length<foot>> parsed(values.size() + 10);
+        const parse_n_result r = parse_n(csv.data(), csv.data() + csv.size(), ',', parsed.data(), parsed.size());
+        LENGTH_CHECK(r.ec == std::errc{});
+        LENGTH_CHECK(r.count == values.size());
+        LENGTH_CHECK(r.ptr == csv.data() + csv.size());
+        for (std::size_t i = 0; i < values.size(); ++i)
+        {
+            LENGTH_CHECK(test::close(parsed[i].value(), values[i], 4.0));
+        }
+
+        // capacity limits number of parsed fields
+        const parse_n_result limited = parse_n(csv.data(), csv.data() + csv.size(), ',', parsed.data(), 10);
+        LENGTH_CHECK(limited.count == 10 && limited.ec == std::errc{});
+
+        const std::string bad = "1 m,2 m, 3 x ,4 m";
+        const parse_n_result failed = parse_n(bad.data(), bad.data() + bad.size(), ',', parsed.data(), parsed.size());
+        LENGTH_CHECK(failed.count == 2 && failed.ec == std::errc::invalid_argument && failed.ptr == bad.data() + 9);
+    }
+
+    LENGTH_TEST(to_chars_reports_small_buffer)
+    {
+        for (const double v : {0.0, 12.5, -1.0 / 3, 1e300})
+        {
+            const std::string text = formatted(Length<nautical_mile>{v});
+            std::vector<char> buffer(text.size());
+            for (std::size_t size = 0; size < text.size(); ++size)
+            {
+                const auto r = to_chars(buffer.data(), buffer.data() + size, Length<nautical_mile>{v});
+                LENGTH_CHECK(r.ec == std::errc::value_too_large);
+                LENGTH_CHECK(r.ptr == buffer.data() + size);
+            }
+            const auto r = to_chars(buffer.data(), buffer.data() + buffer.size(), Length<nautical_mile>{v});
+            LENGTH_CHECK(r.ec == std::errc{} && std::string(buffer.data(), r.ptr) == text);
+        }
+
+        char buffer[32];
+        const auto fixed = to_chars(buffer, buffer + sizeof buffer, 12.34567_mm, std::chars_format::fixed, 3);
+        LENGTH_CHECK(std::string(buffer, fixed.ptr) == "12.346 mm");
+        const auto sci = to_chars(buffer, buffer + sizeof buffer, 1500_m, std::chars_format::scientific);
+        LENGTH_CHECK(std::string(buffer, sci.ptr) == "1.5e+03 m");
+    }
+
+#if defined(LENGTH_WITH_FMT) || defined(__cpp_lib_format)
+    /** Groups of three separated by `'` and decimal comma **/
+    struct test_punct : std::numpunct<char>
+    {
+            char        do_thousands_sep() const override { return '\''; }
+            char        do_decimal_point() const override { return ','; }
+            std::string do_grouping() const override      { return "\3"; }
+    };
+#endif
+
+#if defined(LENGTH_WITH_FMT)
+    LENGTH_TEST(fmt_formatter)
+    {
+        LENGTH_CHECK(fmt::format("{}", 12.5_mm) == "12.5 mm");
+        LENGTH_CHECK(fmt::format("{:.3f}", 12.34567_mm) == "12.346 mm");
+        LENGTH_CHECK(fmt::format("{:.{}f}", 1_ft, 2) == "1.00 ft");
+        LENGTH_CHECK(fmt::format("{}", Length<inch, int>{3}) == "3 in");
+        LENGTH_CHECK(fmt::format("{:+}", Length<inch, int>{3}) == "+3 in");
+        LENGTH_CHECK(fmt::format(L"{:>6}", Length<inch, int>{3}) == L"  3 in");
+    }
+
+    LENGTH_TEST(fmt_formatter_pads_whole_text)
+    {
+        LENGTH_CHECK(fmt::format("{:10}|", 12.5_mm) == "12.5 mm   |");
+        LENGTH_CHECK(fmt::format("{:>10}", 12.5_mm) == "   12.5 mm");
+        LENGTH_CHECK(fmt::format("{:*^11}", 12.5_mm) == "**12.5 mm**");
+        LENGTH_CHECK(fmt::format("{:\u00b7<9}", 1_m) == "1 m\u00b7\u00b7\u00b7\u00b7\u00b7\u00b7");
+        LENGTH_CHECK(fmt::format("{:>{}}", 12.5_mm, 9) == "  12.5 mm");
+        LENGTH_CHECK(fmt::format("{:>{}.{}f}", 12.5_mm, 10, 2) == "  12.50 mm");
+        LENGTH_CHECK(fmt::format("{:010.2f}", 12.5_mm) == "0012.50 mm");
+        LENGTH_CHECK(fmt::format("{:>+8}", Length<inch, int>{3}) == "   +3 in");
+        LENGTH_CHECK(fmt::format("{:#x}", Length<inch, int>{255}) == "0xff in");
+        LENGTH_CHECK(fmt::format("{:4}", 12.5_mm) == "12.5 mm");
+
+        bool rejected = false;
+        try
+        {
+            (void)fmt::format(fmt::runtime("{:.2}"), Length<inch, int>{3});
+        }
+        catch (const fmt::format_error&)
+        {
+            rejected = true;
+        }
+        LENGTH_CHECK(rejected);
+        for (const double v : interesting_values())
+        {
+            Length<yard> parsed;
+            LENGTH_CHECK(parse(fmt::format("{}", Length<yard>{v}), parsed).ec == std::errc{} && parsed.value() == v);
+        }
+    }
+
+    LENGTH_TEST(fmt_formatter_value_spec)
+    {
+        LENGTH_CHECK(fmt::format("{:#.4g}", 1_m) == "1.000 m");
+        LENGTH_CHECK(fmt::format("{:E}", 1500_m) == "1.500000E+03 m");
+        LENGTH_CHECK(fmt::format("{:#o}", Length<inch, int>{8}) == "010 in");
+        LENGTH_CHECK(fmt::format("{:#X}", Length<inch, int>{-255}) == "-0XFF in");
+        LENGTH_CHECK(fmt::format("{:010}", Length<millimetre>{-std::numeric_limits<double>::infinity()}) == "   -inf mm");
+        LENGTH_CHECK(fmt::format("{:.600f}", 1_mm).size() == 605);
+
+        const std::locale locale{std::locale::classic(), new test_punct};
+        LENGTH_CHECK(fmt::format(locale, "{:L}", Length<inch, int>{-1234567}) == "-1'234'567 in");
+        LENGTH_CHECK(fmt::format(locale, "{:>14.2Lf}", 1234.5_mm) == "   1'234,50 mm");
+        LENGTH_CHECK(fmt::format(locale, "{:.2f}", 1234.5_mm) == "1234.50 mm");
+    }
+#endif
+
+#if defined(__cpp_lib_format)
+    LENGTH_TEST(std_formatter)
+    {
+        LENGTH_CHECK(std::format("{}", 12.5_mm) == "12.5 mm");
+        LENGTH_CHECK(std::format("{:.3f}", 12.34567_mm) == "12.346 mm");
+        LENGTH_CHECK(std::format("{:.{}f}", 1_ft, 2) == "1.00 ft");
+        LENGTH_CHECK(std::format("{}", Length<inch, int>{3}) == "3 in");
+        LENGTH_CHECK(std::format("{:>10}", 12.5_mm) == "   12.5 mm");
+        LENGTH_CHECK(std::format("{:*^11}", 12.5_mm) == "**12.5 mm**");
+        LENGTH_CHECK(std::format("{:>{}}", 12.5_mm, 9) == "  12.5 mm");
+        LENGTH_CHECK(std::format("{:010.2f}", 12.5_mm) == "0012.50 mm");
+        LENGTH_CHECK(std::format("{:#.4g}", 1_m) == "1.000 m");
+        LENGTH_CHECK(std::format("{:#X}", Length<inch, int>{-255}) == "-0XFF in");
+        LENGTH_CHECK(std::format("{:.600f}", 1_mm).size() == 605);
+        LENGTH_CHECK(std::format(std::locale{std::locale::classic(), new test_punct}, "{:L}", Length<inch, int>{-1234567}) == "-1'234'567 in");
+        for (const double v : interesting_values())
+        {
+            Length<yard> parsed;
+            LENGTH_CHECK(parse(std::format("{}", Length<yard>{v}), parsed).ec == std::errc{} && parsed.value() == v);
+        }
+    }
+#endif
+}